@@ -60,6 +60,8 @@
 #include "gstomx_filereadersrc.h"
 #endif /* EXPERIMENTAL */
 #include "gstomx_volume.h"
+#include "gstomx_mmapsrc.h"
+#include "gstomx_transcode.h"
 
 GST_DEBUG_CATEGORY (gstomx_debug);
 
@@ -106,6 +108,10 @@ get_config_path (void)
 {
 /* MODIFICATION */
 #if 1     /* Fix_config_path */
+  /* modification: the check tests point OMX_CONFIG at their own file */
+  if (g_getenv ("OMX_CONFIG"))
+    return g_strdup (g_getenv ("OMX_CONFIG"));
+
   return g_build_filename (OMX_CONFIG_DIRPATH, OMX_CONFIG_FILENAME, NULL);
 #else
   gchar *path;
@@ -246,6 +252,7 @@ plugin_init (GstPlugin * plugin)
     const gchar *component_name, *component_role, *library_name;
     GType type;
     gint rank;
+    gint max_instances;
 
     GST_DEBUG ("element_name=%s, element=%" GST_PTR_FORMAT, element_name,
         element);
@@ -262,6 +269,10 @@ plugin_init (GstPlugin * plugin)
       return FALSE;
     }
 
+    /* modification: instances of the component the platform runs at once */
+    if (gst_structure_get_int (element, "max-instances", &max_instances))
+      g_omx_resource_set_capacity (component_name, MAX (max_instances, 0));
+
     if (parent_type_name) {
       type = g_type_from_name (parent_type_name);
       if (type) {
@@ -294,6 +305,19 @@ plugin_init (GstPlugin * plugin)
     }
   }
 
+  /* modification: no component behind it, so it is not in the config */
+  if (!gst_element_register (plugin, "omx_mmapsrc", GST_RANK_NONE,
+          GST_OMX_MMAPSRC_TYPE)) {
+    g_warning ("failed registering 'omx_mmapsrc'");
+    return FALSE;
+  }
+
+  if (!gst_element_register (plugin, "omx_transcode", GST_RANK_NONE,
+          GST_OMX_TRANSCODE_TYPE)) {
+    g_warning ("failed registering 'omx_transcode'");
+    return FALSE;
+  }
+
   return TRUE;
 }
 
@@ -35,6 +35,11 @@ enum
 #define DEFAULT_PROFILE OMX_AUDIO_AACObjectLC
 #define DEFAULT_OUTPUT_FORMAT OMX_AUDIO_AACStreamFormatRAW
 
+/* modification: output buffer sizing, a raw data block carries at most
+ * 6144 bits per channel (ISO/IEC 14496-3 4.5.3) */
+#define OUTPUT_BUFFER_FACTOR 2
+#define MAX_FRAME_SIZE_PER_CHANNEL 768
+
 GSTOMX_BOILERPLATE (GstOmxAacEnc, gst_omx_aacenc, GstOmxBaseFilter,
     GST_OMX_BASE_FILTER_TYPE);
 
@@ -204,11 +209,13 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
 {
   GstStructure *structure;
   GstOmxBaseFilter *omx_base;
+  GstOmxAacEnc *self;
   GOmxCore *gomx;
   gint rate = 0;
   gint channels = 0;
 
   omx_base = GST_OMX_BASE_FILTER (GST_PAD_PARENT (pad));
+  self = GST_OMX_AACENC (omx_base);
   gomx = (GOmxCore *) omx_base->gomx;
 
   GST_INFO_OBJECT (omx_base, "setcaps (sink): %" GST_PTR_FORMAT, caps);
@@ -235,6 +242,22 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     OMX_SetParameter (gomx->omx_handle, OMX_IndexParamAudioPcm, &param);
   }
 
+  /* modification: size output buffers for the 1024 sample frames of a batch */
+  if (rate > 0 && channels > 0) {
+    GstClockTime frame_duration;
+    guint frames;
+    guint size;
+
+    frame_duration = gst_util_uint64_scale_int (GST_SECOND, 1024, rate);
+    frames = gst_omx_base_filter_frames_per_output (omx_base, frame_duration,
+        rate * channels * 2);
+    size = gstomx_encoded_buffer_size (self->bitrate, frames * frame_duration,
+        OUTPUT_BUFFER_FACTOR);
+    size = MAX (size, MAX_FRAME_SIZE_PER_CHANNEL * channels * frames);
+
+    gst_omx_base_filter_set_out_buffer_size (omx_base, size, 0);
+  }
+
   {
     GstCaps *src_caps;
 
@@ -50,6 +50,8 @@ type_base_init (gpointer g_class)
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
+  /* modification: handled by the inherited set_property and get_property */
+  gst_omx_base_filter_install_voice_properties (G_OBJECT_CLASS (g_class));
 }
 
 static void
@@ -57,6 +59,7 @@ settings_changed_cb (GOmxCore * core)
 {
   GstOmxBaseFilter *omx_base;
   guint rate;
+  guint channels;
 
   omx_base = core->object;
 
@@ -72,14 +75,18 @@ settings_changed_cb (GOmxCore * core)
         &param);
 
     rate = param.nSampleRate;
+    channels = MAX (param.nChannels, 1);
   }
 
+  /* modification: the component may settle on another rate */
+  omx_base->codec_frame_bytes = rate * channels / 200;
+
   {
     GstCaps *new_caps;
 
     new_caps = gst_caps_new_simple ("audio/x-adpcm",
         "layout", G_TYPE_STRING, "dvi",
-        "rate", G_TYPE_INT, rate, "channels", G_TYPE_INT, 1, NULL);
+        "rate", G_TYPE_INT, rate, "channels", G_TYPE_INT, channels, NULL);
 
     GST_INFO_OBJECT (omx_base, "caps are: %" GST_PTR_FORMAT, new_caps);
     gst_pad_set_caps (omx_base->srcpad, new_caps);
@@ -94,6 +101,7 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
   GstOmxBaseFilter *omx_base;
   GOmxCore *gomx;
   gint rate = 0;
+  gint channels = 1;
   gboolean ret = TRUE;
 
   omx_base = GST_OMX_BASE_FILTER (GST_PAD_PARENT (pad));
@@ -118,6 +126,14 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     gst_structure_get_int (structure, "rate", &rate);
   }
 
+  gst_structure_get_int (gst_caps_get_structure (caps, 0), "channels",
+      &channels);
+
+  /* modification: DVI output takes 4 bits per sample and channel, split it
+   * into 10 ms frames */
+  omx_base->codec_frame_bytes = rate * channels / 200;
+  omx_base->codec_frame_duration = 10 * GST_MSECOND;
+
   /* Input port configuration. */
   {
     OMX_AUDIO_PARAM_PCMMODETYPE param;
@@ -128,6 +144,7 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     OMX_GetParameter (gomx->omx_handle, OMX_IndexParamAudioPcm, &param);
 
     param.nSamplingRate = rate;
+    param.nChannels = channels;
 
     OMX_SetParameter (gomx->omx_handle, OMX_IndexParamAudioPcm, &param);
   }
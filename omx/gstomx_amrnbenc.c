@@ -27,9 +27,22 @@ enum
 {
   ARG_0,
   ARG_BITRATE,
+  ARG_DTX,
 };
 
 #define DEFAULT_BITRATE 64000
+#define DEFAULT_DTX FALSE
+
+/* modification: output buffer sizing, 20 ms frames of at most 32 bytes
+ * including the header at 12.2 kbit/s */
+#define OUTPUT_BUFFER_FACTOR 2
+#define MAX_FRAME_SIZE 32
+
+/* modification: speech bytes behind the one byte header of each storage
+ * format frame, by frame type (4.75 to 12.2 kbit/s, SID, no data) */
+static const guint8 frame_sizes[16] = {
+  12, 13, 15, 17, 19, 20, 26, 31, 5, 6, 5, 5, 0, 0, 0, 0
+};
 
 GSTOMX_BOILERPLATE (GstOmxAmrNbEnc, gst_omx_amrnbenc, GstOmxBaseFilter,
     GST_OMX_BASE_FILTER_TYPE);
@@ -67,8 +80,12 @@ set_property (GObject * obj,
     case ARG_BITRATE:
       self->bitrate = g_value_get_uint (value);
       break;
+    case ARG_DTX:
+      self->dtx = g_value_get_boolean (value);
+      break;
     default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      /* modification: the voice properties of the base filter */
+      G_OBJECT_CLASS (parent_class)->set_property (obj, prop_id, value, pspec);
       break;
   }
 }
@@ -85,29 +102,58 @@ get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
             /** @todo propagate this to OpenMAX when processing. */
       g_value_set_uint (value, self->bitrate);
       break;
+    case ARG_DTX:
+      g_value_set_boolean (value, self->dtx);
+      break;
     default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      /* modification: the voice properties of the base filter */
+      G_OBJECT_CLASS (parent_class)->get_property (obj, prop_id, value, pspec);
       break;
   }
 }
 
+/* modification: frames are told apart by the frame type in their header */
+static guint
+output_frame_size (GstOmxBaseFilter * omx_base, const guint8 * data,
+    guint size, GstClockTime * duration)
+{
+  guint ft = (data[0] >> 3) & 0xf;
+
+  if (ft > 11 && ft < 15)
+    return 0;
+
+  *duration = 20 * GST_MSECOND;
+  return 1 + frame_sizes[ft];
+}
+
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
   GObjectClass *gobject_class;
+  GstOmxBaseFilterClass *basefilter_class;
 
   gobject_class = G_OBJECT_CLASS (g_class);
+  basefilter_class = GST_OMX_BASE_FILTER_CLASS (g_class);
+
+  basefilter_class->output_frame_size = output_frame_size;
 
   /* Properties stuff */
   {
     gobject_class->set_property = set_property;
     gobject_class->get_property = get_property;
 
+    gst_omx_base_filter_install_voice_properties (gobject_class);
+
     g_object_class_install_property (gobject_class, ARG_BITRATE,
         g_param_spec_uint ("bitrate", "Bit-rate",
             "Encoding bit-rate",
             0, G_MAXUINT, DEFAULT_BITRATE,
             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, ARG_DTX,
+        g_param_spec_boolean ("dtx", "DTX",
+            "Enable DTX, silence is sent as SID frames",
+            DEFAULT_DTX, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   }
 }
 
@@ -149,11 +195,13 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
 {
   GstStructure *structure;
   GstOmxBaseFilter *omx_base;
+  GstOmxAmrNbEnc *self;
   GOmxCore *gomx;
   gint rate = 0;
   gint channels = 0;
 
   omx_base = GST_OMX_BASE_FILTER (GST_PAD_PARENT (pad));
+  self = GST_OMX_AMRNBENC (omx_base);
   gomx = (GOmxCore *) omx_base->gomx;
 
   GST_INFO_OBJECT (omx_base, "setcaps (sink): %" GST_PTR_FORMAT, caps);
@@ -180,6 +228,35 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     OMX_SetParameter (gomx->omx_handle, OMX_IndexParamAudioPcm, &param);
   }
 
+  /* modification: Output port configuration, DTX on the component's VAD */
+  {
+    OMX_AUDIO_PARAM_AMRTYPE param;
+
+    G_OMX_INIT_PARAM (param);
+
+    param.nPortIndex = omx_base->out_port->port_index;
+    OMX_GetParameter (gomx->omx_handle, OMX_IndexParamAudioAmr, &param);
+
+    param.eAMRDTXMode = self->dtx ?
+        OMX_AUDIO_AMRDTXModeOnAuto : OMX_AUDIO_AMRDTXModeOff;
+
+    OMX_SetParameter (gomx->omx_handle, OMX_IndexParamAudioAmr, &param);
+  }
+
+  /* modification: size output buffers for the frames of a batch */
+  {
+    guint frames;
+    guint size;
+
+    frames = gst_omx_base_filter_frames_per_output (omx_base, 20 * GST_MSECOND,
+        rate * channels * 2);
+    size = gstomx_encoded_buffer_size (self->bitrate, frames * 20 * GST_MSECOND,
+        OUTPUT_BUFFER_FACTOR);
+    size = MAX (size, MAX_FRAME_SIZE * frames);
+
+    gst_omx_base_filter_set_out_buffer_size (omx_base, size, 0);
+  }
+
   return gst_pad_set_caps (pad, caps);
 }
 
@@ -197,4 +274,5 @@ type_instance_init (GTypeInstance * instance, gpointer g_class)
   gst_pad_set_setcaps_function (omx_base->sinkpad, sink_setcaps);
 
   self->bitrate = DEFAULT_BITRATE;
+  self->dtx = DEFAULT_DTX;
 }
@@ -36,6 +36,7 @@ struct GstOmxAmrNbEnc
 {
   GstOmxBaseFilter omx_base;
   guint bitrate;
+  gboolean dtx;
 };
 
 struct GstOmxAmrNbEncClass
@@ -36,6 +36,7 @@ struct GstOmxAmrWbEnc
 {
   GstOmxBaseFilter omx_base;
   guint bitrate;
+  gboolean dtx;
 };
 
 struct GstOmxAmrWbEncClass
@@ -74,6 +74,68 @@ get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
   }
 }
 
+/* Sample-accurate clipping of the raw output against the segment. */
+static gboolean
+clip_output_buf (GstOmxBaseFilter * omx_base, OMX_BUFFERHEADERTYPE * omx_buffer,
+    GstSegment * segment)
+{
+  GstCaps *caps;
+  GstStructure *structure;
+  gint rate = 0, channels = 0, width = 16;
+  guint frame_size, samples;
+  gint64 start, stop, clip_start, clip_stop;
+
+  caps = GST_PAD_CAPS (omx_base->srcpad);
+  if (!caps)
+    return TRUE;
+
+  structure = gst_caps_get_structure (caps, 0);
+  gst_structure_get_int (structure, "rate", &rate);
+  gst_structure_get_int (structure, "channels", &channels);
+  gst_structure_get_int (structure, "width", &width);
+
+  if (rate <= 0 || channels <= 0 || width <= 0)
+    return TRUE;
+
+  frame_size = channels * (width / 8);
+  samples = omx_buffer->nFilledLen / frame_size;
+
+  start = gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
+      OMX_TICKS_PER_SECOND);
+  stop = start + gst_util_uint64_scale_int (samples, GST_SECOND, rate);
+
+  if (!gst_segment_clip (segment, GST_FORMAT_TIME, start, stop,
+          &clip_start, &clip_stop))
+    return FALSE;
+
+  if (clip_start != start) {
+    guint skip;
+
+    skip = gst_util_uint64_scale_int (clip_start - start, rate, GST_SECOND);
+    skip = MIN (skip, samples);
+
+    omx_buffer->nOffset += skip * frame_size;
+    omx_buffer->nFilledLen -= skip * frame_size;
+    omx_buffer->nTimeStamp += gst_util_uint64_scale_int (skip,
+        OMX_TICKS_PER_SECOND, rate);
+    samples -= skip;
+  }
+
+  if (clip_stop != stop) {
+    guint drop;
+
+    drop = gst_util_uint64_scale_int (stop - clip_stop, rate, GST_SECOND);
+    drop = MIN (drop, samples);
+
+    omx_buffer->nFilledLen -= drop * frame_size;
+    samples -= drop;
+  }
+
+  GST_LOG_OBJECT (omx_base, "clipped to %u samples", samples);
+
+  return samples > 0;
+}
+
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
@@ -94,6 +156,7 @@ type_class_init (gpointer g_class, gpointer class_data)
         "Whether or not to use state-tuning feature",
         FALSE, G_PARAM_READWRITE));
   }
+  basefilter_class->clip_output_buf = clip_output_buf;
 }
 
 static void
@@ -22,19 +22,69 @@
 #include "gstomx_base_filter.h"
 #include "gstomx.h"
 #include "gstomx_interface.h"
+#include "gstomx_tiled.h"
 
 #include <string.h>             /* for memcpy */
+#include <math.h>               /* for pow */
 
 /* MODIFICATION: for state-tuning */
 static void output_loop (gpointer data);
+static void frame_reset (GstOmxBaseFilter * self);
 
 enum
 {
   ARG_USE_TIMESTAMPS = GSTOMX_NUM_COMMON_PROP,
   ARG_NUM_INPUT_BUFFERS,
   ARG_NUM_OUTPUT_BUFFERS,
+  ARG_MAX_INPUT_FRAME_SIZE,
+  ARG_BUFFER_MEMORY,
+  ARG_POOL_ALLOCATIONS,
+  ARG_POOL_PEAK,
+  ARG_BATCH_DURATION,
+  ARG_FRAMES_PER_PACKET,
+  ARG_VAD,
+  ARG_VAD_THRESHOLD,
+  ARG_VAD_HANGOVER,
+  ARG_MEMFD,
+  ARG_INSTANCES,
+  ARG_UNIT_FRAMES,
+  ARG_PRIORITY,
+  ARG_PREEMPTIBLE,
+  ARG_ADMISSION_TIMEOUT,
+  ARG_IDLE_TIMEOUT,
+  ARG_RESUME_LATENCY,
+  ARG_HUGE_PAGES,
+  ARG_LOCK_BUFFERS,
+  ARG_HUGE_PAGE_MEMORY,
+  ARG_ARENA_REUSES,
 };
 
+/* MODIFICATION: upper bound for input buffers grown by resize_input_port */
+#define GSTOMX_MAX_INPUT_BUFFER_SIZE (8 * 1024 * 1024)
+
+/* MODIFICATION: output buffers downstream may hold besides the port's own */
+#define GSTOMX_POOL_DOWNSTREAM_BUFFERS 4
+
+/* MODIFICATION: regions of adapter_size bytes held by one ring block */
+#define GSTOMX_RING_REGIONS 8
+
+/* MODIFICATION: timestamp jitter still counted as contiguous in a batch */
+#define GSTOMX_BATCH_TOLERANCE GST_MSECOND
+
+/* MODIFICATION: voice activity gating defaults */
+#define DEFAULT_VAD_THRESHOLD -50
+#define DEFAULT_VAD_HANGOVER 200
+
+/* MODIFICATION: most component instances behind one element */
+#define GSTOMX_MAX_INSTANCES 8
+
+/* MODIFICATION: how often idleness is checked, and how long a suspension
+ * waits for the output loop to leave the component */
+#define GSTOMX_IDLE_CHECK_INTERVAL G_USEC_PER_SEC
+#define GSTOMX_IDLE_OUTPUT_WAIT (100 * 1000)
+
+#define uses_ring(self) ((self)->adapter_size > 0 || (self)->batch_duration > 0)
+
 static void init_interfaces (GType type);
 GSTOMX_BOILERPLATE_FULL (GstOmxBaseFilter, gst_omx_base_filter, GstElement,
     GST_TYPE_ELEMENT, init_interfaces);
@@ -52,16 +102,15 @@ log_buffer (GstOmxBaseFilter * self, OMX_BUFFERHEADERTYPE * omx_buffer, const gc
       omx_buffer->nOffset, omx_buffer->nTimeStamp);
 }
 
-/* Add_code_for_extended_color_format */
-static gboolean
-is_extended_color_format(GstOmxBaseFilter * self, GOmxPort * port)
+static guint
+port_color_format (GstOmxBaseFilter * self, GOmxPort * port)
 {
   OMX_PARAM_PORTDEFINITIONTYPE param;
   OMX_HANDLETYPE omx_handle = self->gomx->omx_handle;
 
   if (G_UNLIKELY (!omx_handle)) {
     GST_WARNING_OBJECT (self, "no component");
-    return FALSE;
+    return OMX_COLOR_FormatUnused;
   }
 
   G_OMX_INIT_PARAM (param);
@@ -69,7 +118,27 @@ is_extended_color_format(GstOmxBaseFilter * self, GOmxPort * port)
   param.nPortIndex = port->port_index;
   OMX_GetParameter (omx_handle, OMX_IndexParamPortDefinition, &param);
 
-  switch ((guint)param.format.video.eColorFormat) {
+  return param.format.video.eColorFormat;
+}
+
+/* drop whatever a shared input buffer still points to */
+static inline void
+reclaim_shared_buffer (OMX_BUFFERHEADERTYPE * omx_buffer)
+{
+  if (omx_buffer->pAppPrivate) {
+    gst_buffer_unref ((GstBuffer *) omx_buffer->pAppPrivate);
+    omx_buffer->pAppPrivate = NULL;
+  } else if (omx_buffer->pBuffer) {
+    g_free (omx_buffer->pBuffer);
+  }
+  omx_buffer->pBuffer = NULL;
+}
+
+/* Add_code_for_extended_color_format */
+static gboolean
+is_extended_color_format(GstOmxBaseFilter * self, GOmxPort * port)
+{
+  switch (port_color_format (self, port)) {
     case OMX_EXT_COLOR_FormatNV12TPhysicalAddress:
     case OMX_EXT_COLOR_FormatNV12LPhysicalAddress:
     case OMX_EXT_COLOR_FormatNV12Tiled:
@@ -89,6 +158,8 @@ setup_ports (GstOmxBaseFilter * self)
   /* Output port configuration. */
   g_omx_port_setup (self->out_port);
   gst_pad_set_element_private (self->srcpad, self->out_port);
+  gstomx_buffer_pool_set_limit (self->out_pool,
+      self->out_port->num_buffers + GSTOMX_POOL_DOWNSTREAM_BUFFERS);
 
   /* @todo: read from config file: */
   if (g_getenv ("OMX_ALLOCATE_ON")) {
@@ -121,12 +192,347 @@ setup_ports (GstOmxBaseFilter * self)
     GST_DEBUG_OBJECT (self, "default sharing and allocation");
   }
 
+  /* MODIFICATION: a transcoder links two elements sharing their buffers */
+  if (self->share_input && !self->in_port->omx_allocate &&
+      !is_extended_color_format (self, self->in_port))
+    self->in_port->shared_buffer = TRUE;
+  if (self->share_output && !self->out_port->omx_allocate &&
+      !is_extended_color_format (self, self->out_port))
+    self->out_port->shared_buffer = TRUE;
+
+  /* MODIFICATION: converted input is written into buffers owned by the port */
+  if (self->convert_input)
+    self->in_port->shared_buffer = FALSE;
+
   GST_DEBUG_OBJECT (self, "omx_allocate: in: %d, out: %d",
       self->in_port->omx_allocate, self->out_port->omx_allocate);
   GST_DEBUG_OBJECT (self, "share_buffer: in: %d, out: %d",
       self->in_port->shared_buffer, self->out_port->shared_buffer);
 }
 
+/* MODIFICATION: raise nBufferSize of the input port to the largest expected
+ * frame, taken from the property or the "max-input-frame-size" caps field */
+static void
+configure_input_buffer_size (GstOmxBaseFilter * self)
+{
+  OMX_PARAM_PORTDEFINITIONTYPE param;
+  OMX_HANDLETYPE omx_handle = self->gomx->omx_handle;
+  gint size = self->max_input_frame_size;
+
+  if (size == 0 && GST_PAD_CAPS (self->sinkpad)) {
+    GstStructure *structure;
+
+    structure = gst_caps_get_structure (GST_PAD_CAPS (self->sinkpad), 0);
+    gst_structure_get_int (structure, "max-input-frame-size", &size);
+  }
+
+  if (size <= 0 || G_UNLIKELY (!omx_handle))
+    return;
+
+  G_OMX_INIT_PARAM (param);
+
+  param.nPortIndex = self->in_port->port_index;
+  OMX_GetParameter (omx_handle, OMX_IndexParamPortDefinition, &param);
+
+  if (param.nBufferSize < (OMX_U32) size) {
+    GST_INFO_OBJECT (self, "input buffer size %lu -> %d", param.nBufferSize,
+        size);
+    param.nBufferSize = size;
+    OMX_SetParameter (omx_handle, OMX_IndexParamPortDefinition, &param);
+  }
+}
+
+/* MODIFICATION: let an encoder shrink its output buffers to size before the
+ * port is enabled; on overflow they grow again up to max, or up to the
+ * component default when max is 0 */
+void
+gst_omx_base_filter_set_out_buffer_size (GstOmxBaseFilter * self, guint size,
+    guint max)
+{
+  OMX_PARAM_PORTDEFINITIONTYPE param;
+  OMX_HANDLETYPE omx_handle = self->gomx->omx_handle;
+
+  if (G_UNLIKELY (!omx_handle)) {
+    GST_WARNING_OBJECT (self, "no component");
+    return;
+  }
+
+  G_OMX_INIT_PARAM (param);
+
+  param.nPortIndex = self->out_port->port_index;
+  OMX_GetParameter (omx_handle, OMX_IndexParamPortDefinition, &param);
+
+  if (max == 0)
+    max = MAX (param.nBufferSize, self->out_buffer_size_max);
+  if (size == 0 || size > max)
+    size = max;
+
+  GST_INFO_OBJECT (self, "output buffer size %lu -> %u (max %u)",
+      param.nBufferSize, size, max);
+
+  self->out_buffer_size_max = max;
+  self->out_resized = FALSE;
+  param.nBufferSize = size;
+
+  OMX_SetParameter (omx_handle, OMX_IndexParamPortDefinition, &param);
+}
+
+/* MODIFICATION: codec frames of frame_duration the component may code into
+ * one output buffer, with the input batched by batch_duration or adapter_size
+ * and the output pushed in frames_per_packet; bytes_per_second is of the raw
+ * input, 0 if unknown */
+guint
+gst_omx_base_filter_frames_per_output (GstOmxBaseFilter * self,
+    GstClockTime frame_duration, guint bytes_per_second)
+{
+  GstClockTime duration = frame_duration;
+
+  if (frame_duration == 0)
+    return 1;
+
+  duration = MAX (duration, self->batch_duration);
+  if (self->adapter_size > 0 && bytes_per_second > 0)
+    duration = MAX (duration, gst_util_uint64_scale_int (self->adapter_size,
+            GST_SECOND, bytes_per_second));
+  if (self->frames_per_packet > 0)
+    duration = MAX (duration, self->frames_per_packet * frame_duration);
+
+  return (duration + frame_duration - 1) / frame_duration;
+}
+
+/* MODIFICATION: record the size of an input frame sent in copy mode and ask
+ * for bigger buffers once a frame has to be split */
+static void
+note_input_frame (GstOmxBaseFilter * self, guint size)
+{
+  GOmxPort *port = self->in_port;
+  guint new_size;
+
+  if (size > self->input_frame_peak)
+    self->input_frame_peak = size;
+
+  if (size <= port->buffer_size)
+    return;
+
+  self->input_split_frames++;
+
+  /* leave headroom for the next big frame, in whole pages */
+  new_size = MIN (self->input_frame_peak + self->input_frame_peak / 4,
+      GSTOMX_MAX_INPUT_BUFFER_SIZE);
+  new_size = (new_size + 4095) & ~4095;
+
+  if (new_size > port->buffer_size && new_size > self->input_resize) {
+    GST_DEBUG_OBJECT (self, "%u byte frame split (%u so far), want %u byte "
+        "input buffers", size, self->input_split_frames, new_size);
+    self->input_resize = new_size;
+  }
+}
+
+/* MODIFICATION: reallocate the input buffers with the size asked for by
+ * note_input_frame; must be called while the element holds no input buffer */
+static void
+resize_input_port (GstOmxBaseFilter * self)
+{
+  GOmxPort *port = self->in_port;
+  OMX_BUFFERHEADERTYPE **held;
+  guint i;
+
+  if (port->shared_buffer || self->input_resize <= port->buffer_size) {
+    self->input_resize = 0;
+    return;
+  }
+
+  /* every buffer has to be back from the component before it is freed */
+  held = g_new0 (OMX_BUFFERHEADERTYPE *, port->num_buffers);
+  for (i = 0; i < port->num_buffers; i++) {
+    held[i] = g_omx_port_request_buffer (port);
+    if (!held[i])
+      break;
+  }
+
+  if (i < port->num_buffers) {
+    GST_DEBUG_OBJECT (self, "flushing, input buffers not resized");
+    while (i > 0)
+      g_omx_port_push_buffer (port, held[--i]);
+    g_free (held);
+    return;
+  }
+  g_free (held);
+
+  GST_INFO_OBJECT (self, "input buffer size %lu -> %u", port->buffer_size,
+      self->input_resize);
+  if (!g_omx_port_set_buffer_size (port, self->input_resize, port->num_buffers,
+          NULL, NULL))
+    GST_ELEMENT_ERROR (self, STREAM, FAILED, (NULL),
+        ("input buffers not resized"));
+  self->input_resize = 0;
+}
+
+static GstFlowReturn push_lane_buffer (GstOmxBaseFilter * self,
+    GstBuffer * buf, OMX_BUFFERHEADERTYPE * omx_buffer, guint index);
+static GstFlowReturn push_out (GstOmxBaseFilter * self, GstBuffer * buf);
+
+/*
+ *  description : fill an own input buffer of port from buf
+ *  params      : @self: base filter, @port: input port of any instance,
+ *                @omx_buffer: buffer of port, @buf: input buffer,
+ *                @data, @size: input to send, inside buf or the ring,
+ *                @offset: bytes of data already sent, advanced
+ *  return      : FALSE when buf can not be sent
+ *  comments    : physical address formats take the addresses of the frame,
+ *                converted input is written whole, the rest is copied as
+ *                far as it fits
+ */
+static gboolean
+fill_input_buffer (GstOmxBaseFilter * self, GOmxPort * port,
+    OMX_BUFFERHEADERTYPE * omx_buffer, GstBuffer * buf, const guint8 * data,
+    guint size, guint * offset)
+{
+  GstOmxBaseFilterClass *basefilter_class;
+
+  basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+
+  /* MODIFICATION: to handle input SN12 HW addr. (enc) */
+  if (is_extended_color_format (self, port)) {
+    if (!GST_BUFFER_MALLOCDATA (buf)) {
+      GST_WARNING_OBJECT (self, "null MALLOCDATA in hw color format. skip this.");
+      return FALSE;
+    }
+    /* Copy p[0], p[1] of SCMN_IMGB to pAddrY, pAddrC of MFC_ENC_ADDR_INFO */
+    memcpy (omx_buffer->pBuffer,
+        GST_BUFFER_MALLOCDATA (buf)
+        + (sizeof (int) * 4 + sizeof (void *)) * 4, sizeof (void *));
+    memcpy (omx_buffer->pBuffer + sizeof (void *),
+        GST_BUFFER_MALLOCDATA (buf)
+        + (sizeof (int) * 4 + sizeof (void *)) * 4 + sizeof (void *),
+        sizeof (void *));
+    omx_buffer->nAllocLen = sizeof (void *) * 2;
+    omx_buffer->nFilledLen = sizeof (void *) * 2;
+    *offset = size;
+  } else if (self->convert_input && basefilter_class->convert_input_buf) {
+    basefilter_class->convert_input_buf (self, omx_buffer, data, size);
+    *offset = size;
+  } else {
+    omx_buffer->nFilledLen = MIN (size - *offset,
+        omx_buffer->nAllocLen - omx_buffer->nOffset);
+    memcpy (omx_buffer->pBuffer + omx_buffer->nOffset, data + *offset,
+        omx_buffer->nFilledLen);
+    *offset += omx_buffer->nFilledLen;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+instance_fill (gpointer element, GOmxPort * port,
+    OMX_BUFFERHEADERTYPE * omx_buffer, GstBuffer * buf, guint * offset)
+{
+  return fill_input_buffer (GST_OMX_BASE_FILTER (element), port, omx_buffer,
+      buf, GST_BUFFER_DATA (buf), GST_BUFFER_SIZE (buf), offset);
+}
+
+static GstFlowReturn
+instance_output (gpointer element, GstBuffer * buf,
+    OMX_BUFFERHEADERTYPE * omx_buffer, guint index)
+{
+  GstOmxBaseFilter *self = element;
+
+  gst_buffer_set_caps (buf, GST_PAD_CAPS (self->srcpad));
+
+  return push_lane_buffer (self, buf, omx_buffer, index);
+}
+
+static GstFlowReturn
+instance_push (gpointer element, GstBuffer * buf)
+{
+  return push_out (GST_OMX_BASE_FILTER (element), buf);
+}
+
+static void
+instance_unit_start (gpointer element, GOmxCore * gomx, guint port_index)
+{
+  GstOmxBaseFilter *self = element;
+
+  GST_OMX_BASE_FILTER_GET_CLASS (self)->unit_start (self, gomx, port_index);
+}
+
+/* the subclass setup writes to the component of the element, so it is
+ * pointed at the other instance meanwhile; the object lock keeps the
+ * property handlers and unload_renew_ports off the borrowed ports */
+static void
+instance_setup (gpointer element, GOmxCore * gomx, GOmxPort * in_port,
+    GOmxPort * out_port)
+{
+  GstOmxBaseFilter *self = element;
+  GOmxCore *own_gomx;
+  GOmxPort *own_in_port;
+  GOmxPort *own_out_port;
+
+  if (!self->omx_setup)
+    return;
+
+  GST_OBJECT_LOCK (self);
+  own_gomx = self->gomx;
+  own_in_port = self->in_port;
+  own_out_port = self->out_port;
+
+  self->gomx = gomx;
+  self->in_port = in_port;
+  self->out_port = out_port;
+
+  self->omx_setup (self);
+
+  self->gomx = own_gomx;
+  self->in_port = own_in_port;
+  self->out_port = own_out_port;
+  GST_OBJECT_UNLOCK (self);
+}
+
+/* MODIFICATION: open the other instances, none when the platform has none */
+static void
+instances_open (GstOmxBaseFilter * self)
+{
+  GstOmxInstances *instances;
+
+  /* units go to the other instances whole, as they arrive */
+  if (self->use_framing || uses_ring (self) || self->in_port->shared_buffer ||
+      (self->convert_input &&
+          !GST_OMX_BASE_FILTER_GET_CLASS (self)->convert_input_buf)) {
+    GST_WARNING_OBJECT (self, "input can not be split into units, "
+        "coding with one instance");
+    return;
+  }
+
+  instances = gstomx_instances_new (self, self->gomx, self->in_port,
+      self->out_port, self->n_instances,
+      self->unit_frames ? self->unit_frames : self->default_unit_frames);
+  instances->process = instance_output;
+  instances->fill = instance_fill;
+  instances->push = instance_push;
+  instances->unit_start = instance_unit_start;
+  instances->use_timestamps = self->use_timestamps;
+
+  if (gstomx_instances_prepare (instances, G_OBJECT_TYPE (self),
+          instance_setup) < 2) {
+    gstomx_instances_free (instances);
+    return;
+  }
+
+  self->instances = instances;
+}
+
+/* MODIFICATION: a session of higher priority waits for the instance; the
+ * application stops this one, which releases it */
+static void
+preempt_cb (GOmxCore * core)
+{
+  GstOmxBaseFilter *self = core->object;
+
+  GST_ELEMENT_ERROR (self, RESOURCE, BUSY,
+      ("Preempted by a session of higher priority"),
+      ("%s wanted above priority %d", core->component_name, core->priority));
+}
+
 static GstFlowReturn
 omx_change_state(GstOmxBaseFilter * self,GstOmxChangeState transition, GOmxPort *in_port, GstBuffer * buf)
 {
@@ -147,11 +553,18 @@ omx_change_state(GstOmxBaseFilter * self,GstOmxChangeState transition, GOmxPort
         self->omx_setup (self);
       }
 
+      configure_input_buffer_size (self);
       setup_ports (self);
 
       g_omx_core_prepare (self->gomx);
 
       if (gomx->omx_state == OMX_StateIdle) {
+        /* MODIFICATION: the other instances are set up like this one, with
+         * what is left once this one is admitted */
+        if (self->n_instances > 1 &&
+            GST_OMX_BASE_FILTER_GET_CLASS (self)->unit_start)
+          instances_open (self);
+
         self->ready = TRUE;
         gst_pad_start_task (self->srcpad, output_loop, self->srcpad);
       }
@@ -183,8 +596,17 @@ omx_change_state(GstOmxBaseFilter * self,GstOmxChangeState transition, GOmxPort
           omx_buffer->nFlags |= OMX_BUFFERFLAG_CODECCONFIG;
 
           omx_buffer->nFilledLen = GST_BUFFER_SIZE (self->codec_data);
-          memcpy (omx_buffer->pBuffer + omx_buffer->nOffset,
-          GST_BUFFER_DATA (self->codec_data), omx_buffer->nFilledLen);
+          if (in_port->shared_buffer && !is_extended_color_format (self, in_port)) {
+            /* MODIFICATION: a shared header may have nothing behind pBuffer */
+            reclaim_shared_buffer (omx_buffer);
+            omx_buffer->pBuffer = GST_BUFFER_DATA (self->codec_data);
+            omx_buffer->nOffset = 0;
+            omx_buffer->nAllocLen = omx_buffer->nFilledLen;
+            omx_buffer->pAppPrivate = gst_buffer_ref (self->codec_data);
+          } else {
+            memcpy (omx_buffer->pBuffer + omx_buffer->nOffset,
+            GST_BUFFER_DATA (self->codec_data), omx_buffer->nFilledLen);
+          }
 
           GST_LOG_OBJECT (self, "release_buffer");
           g_omx_port_release_buffer (in_port, omx_buffer);
@@ -207,7 +629,15 @@ out_flushing:
   {
     const gchar *error_msg = NULL;
 
-    if (gomx->omx_error) {
+    /* MODIFICATION: every instance of the component is taken, or its
+     * buffers do not fit the memory budget */
+    if (gomx->omx_error == OMX_ErrorInsufficientResources) {
+      if (!self->inline_fallback ||
+          !GST_OMX_BASE_FILTER_GET_CLASS (self)->inline_chain)
+        GST_ELEMENT_ERROR (self, RESOURCE, BUSY, (NULL),
+            ("no free %s instance or buffer memory", gomx->component_name));
+      ret = GST_FLOW_ERROR;
+    } else if (gomx->omx_error) {
       error_msg = "Error from OpenMAX component";
     } else if (gomx->omx_state != OMX_StateExecuting &&
         gomx->omx_state != OMX_StatePause) {
@@ -225,6 +655,212 @@ out_flushing:
   }
 }
 
+/*
+ * Idle suspension.
+ *
+ * A component left in Idle or Executing keeps its buffers and its instance.
+ * After idle_timeout seconds without input the component is stopped and
+ * unloaded like on PAUSED to READY, keeping its parameters, and pad_chain
+ * loads it again on the next buffer. Only a quiet element is suspended: no
+ * buffer on its way in, no picture assembled in a port buffer and an output
+ * loop waiting on the component rather than pushing downstream.
+ */
+
+static void
+port_definition_get (GOmxCore * gomx, guint index,
+    OMX_PARAM_PORTDEFINITIONTYPE * param)
+{
+  G_OMX_INIT_PARAM (*param);
+  param->nPortIndex = index;
+  OMX_GetParameter (gomx->omx_handle, OMX_IndexParamPortDefinition, param);
+}
+
+/*
+ *  description : unload the core and give the element new, empty ports
+ *  params      : @self: base filter, stream thread or idle thread
+ *  return      : none
+ *  comments    : the ports go away with their buffers; readers outside the
+ *                stream threads take the object lock and find NULL ports
+ *                while the core is being unloaded
+ */
+static void
+unload_renew_ports (GstOmxBaseFilter * self)
+{
+  guint in_index = self->in_port->port_index;
+  guint out_index = self->out_port->port_index;
+  GOmxPort *in_port, *out_port;
+
+  GST_OBJECT_LOCK (self);
+  self->in_port = NULL;
+  self->out_port = NULL;
+  GST_OBJECT_UNLOCK (self);
+
+  g_omx_core_unload (self->gomx);
+
+  in_port = g_omx_core_new_port (self->gomx, in_index);
+  out_port = g_omx_core_new_port (self->gomx, out_index);
+
+  GST_OBJECT_LOCK (self);
+  in_port->huge_pages = out_port->huge_pages = self->huge_pages;
+  in_port->lock_memory = out_port->lock_memory = self->lock_buffers;
+  self->in_port = in_port;
+  self->out_port = out_port;
+  GST_OBJECT_UNLOCK (self);
+}
+
+/* called with both stream locks and ready_lock held */
+static void
+idle_unload (GstOmxBaseFilter * self)
+{
+  OMX_PARAM_PORTDEFINITIONTYPE in_def, out_def;
+  guint in_index = self->in_port->port_index;
+  guint out_index = self->out_port->port_index;
+
+  port_definition_get (self->gomx, in_index, &in_def);
+  port_definition_get (self->gomx, out_index, &out_def);
+
+  g_omx_port_finish (self->in_port);
+  g_omx_port_finish (self->out_port);
+
+  g_omx_core_stop (self->gomx);
+  self->ready = FALSE;
+
+  unload_renew_ports (self);
+
+  /* Loaded keeps the parameters, but not every component does */
+  OMX_SetParameter (self->gomx->omx_handle, OMX_IndexParamPortDefinition,
+      &in_def);
+  OMX_SetParameter (self->gomx->omx_handle, OMX_IndexParamPortDefinition,
+      &out_def);
+}
+
+static void
+idle_suspend (GstOmxBaseFilter * self)
+{
+  GstClockTime start;
+  gulong waited;
+
+  /* a buffer is on its way in */
+  if (!GST_PAD_STREAM_TRYLOCK (self->sinkpad))
+    return;
+
+  start = gst_util_get_timestamp ();
+
+  g_mutex_lock (self->ready_lock);
+
+  if (!self->ready || self->instances || self->frame_buffer ||
+      self->gomx->omx_state != OMX_StateExecuting)
+    goto leave;
+
+  /* get the output loop out of the component */
+  if (!g_atomic_int_compare_and_exchange (&self->last_pad_push_return,
+          GST_FLOW_OK, GST_FLOW_WRONG_STATE))
+    goto leave;
+  g_omx_port_pause (self->out_port);
+
+  for (waited = 0; !GST_PAD_STREAM_TRYLOCK (self->srcpad); waited += 10000) {
+    if (waited >= GSTOMX_IDLE_OUTPUT_WAIT) {
+      GST_DEBUG_OBJECT (self, "output blocked downstream, not suspending");
+      g_omx_port_resume (self->out_port);
+      g_atomic_int_set (&self->last_pad_push_return, GST_FLOW_OK);
+      gst_pad_start_task (self->srcpad, output_loop, self->srcpad);
+      goto leave;
+    }
+    g_usleep (10000);
+  }
+  gst_pad_pause_task (self->srcpad);
+  GST_PAD_STREAM_UNLOCK (self->srcpad);
+
+  idle_unload (self);
+
+  g_atomic_int_set (&self->last_pad_push_return, GST_FLOW_OK);
+  self->suspended = TRUE;
+
+  GST_INFO_OBJECT (self, "suspended after %u s idle, in %" GST_TIME_FORMAT,
+      self->idle_timeout, GST_TIME_ARGS (gst_util_get_timestamp () - start));
+
+leave:
+  g_mutex_unlock (self->ready_lock);
+  GST_PAD_STREAM_UNLOCK (self->sinkpad);
+}
+
+/* the component is back in Executing, report how long that took */
+static void
+idle_resumed (GstOmxBaseFilter * self)
+{
+  GstClockTime latency;
+
+  latency = gst_util_get_timestamp () - self->resume_start;
+  self->suspended = FALSE;
+  self->resume_latency = latency;
+  /* the reference pictures went away with the component */
+  self->need_keyframe = TRUE;
+
+  GST_INFO_OBJECT (self, "resumed in %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (latency));
+
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_element (GST_OBJECT (self),
+          gst_structure_new ("omx-resume",
+              "latency", G_TYPE_UINT64, latency, NULL)));
+}
+
+static gpointer
+idle_thread (gpointer data)
+{
+  GstOmxBaseFilter *self = data;
+  GTimeVal deadline;
+  gint now;
+
+  g_mutex_lock (self->idle_lock);
+  while (!self->idle_stop) {
+    g_get_current_time (&deadline);
+    g_time_val_add (&deadline, GSTOMX_IDLE_CHECK_INTERVAL);
+    g_cond_timed_wait (self->idle_cond, self->idle_lock, &deadline);
+
+    if (self->idle_stop || self->suspended)
+      continue;
+
+    now = gst_util_get_timestamp () / GST_SECOND;
+    if (now - g_atomic_int_get (&self->idle_since) < (gint) self->idle_timeout)
+      continue;
+
+    g_mutex_unlock (self->idle_lock);
+    idle_suspend (self);
+    g_mutex_lock (self->idle_lock);
+  }
+  g_mutex_unlock (self->idle_lock);
+
+  return NULL;
+}
+
+static void
+idle_start (GstOmxBaseFilter * self)
+{
+  if (self->idle_timeout == 0 || self->use_state_tuning || self->use_inline)
+    return;
+
+  g_atomic_int_set (&self->idle_since, gst_util_get_timestamp () / GST_SECOND);
+  self->idle_stop = FALSE;
+  self->idle_thread = g_thread_create (idle_thread, self, TRUE, NULL);
+}
+
+static void
+idle_stop (GstOmxBaseFilter * self)
+{
+  if (!self->idle_thread)
+    return;
+
+  g_mutex_lock (self->idle_lock);
+  self->idle_stop = TRUE;
+  g_cond_signal (self->idle_cond);
+  g_mutex_unlock (self->idle_lock);
+
+  g_thread_join (self->idle_thread);
+  self->idle_thread = NULL;
+  self->suspended = FALSE;
+}
+
 static GstStateChangeReturn
 change_state (GstElement * element, GstStateChange transition)
 {
@@ -245,15 +881,24 @@ change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_NULL_TO_READY:
       GST_INFO_OBJECT (self, "GST_STATE_CHANGE_NULL_TO_READY");
       if (core->omx_state != OMX_StateLoaded) {
-        ret = GST_STATE_CHANGE_FAILURE;
-        goto leave;
+        /* MODIFICATION: without a component code inline if allowed */
+        if (self->inline_fallback &&
+            GST_OMX_BASE_FILTER_GET_CLASS (self)->inline_chain) {
+          GST_WARNING_OBJECT (self, "no component, coding inline");
+          self->use_inline = TRUE;
+          self->inline_fell_back = TRUE;
+        } else if (!self->use_inline) {
+          ret = GST_STATE_CHANGE_FAILURE;
+          goto leave;
+        }
       }
       break;
 
     case GST_STATE_CHANGE_READY_TO_PAUSED:
       GST_INFO_OBJECT (self, "GST_STATE_CHANGE_READY_TO_PAUSED");
+      idle_start (self);
       /* MODIFICATION: state tuning */
-      if (self->use_state_tuning) {
+      if (self->use_state_tuning && !self->use_inline) {
         GST_INFO_OBJECT (self, "use state-tuning feature");
         /* to handle abnormal state change. */
         if (self->gomx != self->in_port->core) {
@@ -279,6 +924,11 @@ change_state (GstElement * element, GstStateChange transition)
       }
       break;
 
+    /* MODIFICATION: no suspension while stopping */
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      idle_stop (self);
+      break;
+
     default:
       break;
   }
@@ -293,6 +943,11 @@ change_state (GstElement * element, GstStateChange transition)
       GST_INFO_OBJECT (self, "GST_STATE_CHANGE_PAUSED_TO_READY");
       g_mutex_lock (self->ready_lock);
       if (self->ready) {
+        if (self->instances) {
+          gstomx_instances_free (self->instances);
+          self->instances = NULL;
+        }
+
         /* unlock */
         g_omx_port_finish (self->in_port);
         g_omx_port_finish (self->out_port);
@@ -302,6 +957,19 @@ change_state (GstElement * element, GstStateChange transition)
         self->ready = FALSE;
       }
       g_mutex_unlock (self->ready_lock);
+
+      /* the pending buffer went away with the port */
+      self->frame_buffer = NULL;
+      frame_reset (self);
+
+      self->input_frame_peak = 0;
+      self->input_split_frames = 0;
+      self->input_resize = 0;
+      self->need_keyframe = FALSE;
+
+      GST_OBJECT_LOCK (self);
+      gst_segment_init (&self->segment, GST_FORMAT_UNDEFINED);
+      GST_OBJECT_UNLOCK (self);
       if (core->omx_state != OMX_StateLoaded &&
           core->omx_state != OMX_StateInvalid) {
         ret = GST_STATE_CHANGE_FAILURE;
@@ -311,6 +979,11 @@ change_state (GstElement * element, GstStateChange transition)
 
     case GST_STATE_CHANGE_READY_TO_NULL:
       GST_INFO_OBJECT (self, "GST_STATE_CHANGE_READY_TO_NULL");
+      /* MODIFICATION: the component is tried again next time */
+      if (self->inline_fell_back) {
+        self->use_inline = FALSE;
+        self->inline_fell_back = FALSE;
+      }
       break;
 
     default:
@@ -330,20 +1003,29 @@ finalize (GObject * obj)
 
   self = GST_OMX_BASE_FILTER (obj);
 
-  if (self->adapter) {
-    gst_adapter_clear(self->adapter);
-    g_object_unref(self->adapter);
-    self->adapter = NULL;
-  }
+  gstomx_ring_free (&self->ring);
 
   if (self->codec_data) {
     gst_buffer_unref (self->codec_data);
     self->codec_data = NULL;
   }
 
+  if (self->frame_buf) {
+    gst_buffer_unref (self->frame_buf);
+    self->frame_buf = NULL;
+  }
+
+  g_free (self->frame_data);
+  self->frame_data = NULL;
+
+  /* buffers still downstream free the pool when they come back */
+  gstomx_buffer_pool_close (self->out_pool);
+
   g_omx_core_free (self->gomx);
 
   g_mutex_free (self->ready_lock);
+  g_cond_free (self->idle_cond);
+  g_mutex_free (self->idle_lock);
 
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
@@ -366,10 +1048,17 @@ set_property (GObject * obj,
       OMX_PARAM_PORTDEFINITIONTYPE param;
       OMX_HANDLETYPE omx_handle = self->gomx->omx_handle;
       OMX_U32 nBufferCountActual;
-      GOmxPort *port = (prop_id == ARG_NUM_INPUT_BUFFERS) ?
-          self->in_port : self->out_port;
+      GOmxPort *port;
+      guint port_index = 0;
+
+      /* MODIFICATION: the ports are renewed on idle suspension */
+      GST_OBJECT_LOCK (self);
+      port = (prop_id == ARG_NUM_INPUT_BUFFERS) ? self->in_port : self->out_port;
+      if (port)
+        port_index = port->port_index;
+      GST_OBJECT_UNLOCK (self);
 
-      if (G_UNLIKELY (!omx_handle)) {
+      if (G_UNLIKELY (!omx_handle || !port)) {
         GST_WARNING_OBJECT (self, "no component");
         break;
       }
@@ -378,7 +1067,7 @@ set_property (GObject * obj,
 
       G_OMX_INIT_PARAM (param);
 
-      param.nPortIndex = port->port_index;
+      param.nPortIndex = port_index;
       OMX_GetParameter (omx_handle, OMX_IndexParamPortDefinition, &param);
 
       if (nBufferCountActual < param.nBufferCountMin) {
@@ -392,17 +1081,75 @@ set_property (GObject * obj,
       OMX_SetParameter (omx_handle, OMX_IndexParamPortDefinition, &param);
     }
       break;
-    default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+    case ARG_MAX_INPUT_FRAME_SIZE:
+      self->max_input_frame_size = g_value_get_uint (value);
       break;
-  }
-}
-
-static void
-get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
-{
-  GstOmxBaseFilter *self;
-
+    case ARG_BATCH_DURATION:
+      self->batch_duration = g_value_get_uint64 (value);
+      break;
+    case ARG_FRAMES_PER_PACKET:
+      self->frames_per_packet = g_value_get_uint (value);
+      break;
+    case ARG_VAD:
+      self->vad = g_value_get_boolean (value);
+      break;
+    case ARG_VAD_THRESHOLD:
+      self->vad_threshold = g_value_get_int (value);
+      self->vad_threshold_energy = (guint64) (32768.0 * 32768.0 *
+          pow (10.0, self->vad_threshold / 10.0));
+      break;
+    case ARG_VAD_HANGOVER:
+      self->vad_hangover = g_value_get_uint (value);
+      break;
+    case ARG_INSTANCES:
+      self->n_instances = g_value_get_uint (value);
+      break;
+    case ARG_UNIT_FRAMES:
+      self->unit_frames = g_value_get_uint (value);
+      break;
+    case ARG_PRIORITY:
+      self->gomx->priority = g_value_get_int (value);
+      break;
+    case ARG_PREEMPTIBLE:
+      self->gomx->preemptible = g_value_get_boolean (value);
+      break;
+    case ARG_ADMISSION_TIMEOUT:
+      self->gomx->admission_timeout = g_value_get_uint (value) * 1000UL;
+      break;
+    case ARG_IDLE_TIMEOUT:
+      self->idle_timeout = g_value_get_uint (value);
+      break;
+    case ARG_MEMFD:
+      self->memfd = g_value_get_boolean (value);
+      gstomx_buffer_pool_set_memfd (self->out_pool, self->memfd);
+      break;
+    case ARG_HUGE_PAGES:
+      GST_OBJECT_LOCK (self);
+      self->huge_pages = g_value_get_boolean (value);
+      if (self->in_port && self->out_port)
+        self->in_port->huge_pages = self->out_port->huge_pages =
+            self->huge_pages;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case ARG_LOCK_BUFFERS:
+      GST_OBJECT_LOCK (self);
+      self->lock_buffers = g_value_get_boolean (value);
+      if (self->in_port && self->out_port)
+        self->in_port->lock_memory = self->out_port->lock_memory =
+            self->lock_buffers;
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstOmxBaseFilter *self;
+
   self = GST_OMX_BASE_FILTER (obj);
 
   if (gstomx_get_property_helper (self->gomx, prop_id, value))
@@ -417,10 +1164,17 @@ get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
     {
       OMX_PARAM_PORTDEFINITIONTYPE param;
       OMX_HANDLETYPE omx_handle = self->gomx->omx_handle;
-      GOmxPort *port = (prop_id == ARG_NUM_INPUT_BUFFERS) ?
-          self->in_port : self->out_port;
+      GOmxPort *port;
+      guint port_index = 0;
+
+      /* MODIFICATION: the ports are renewed on idle suspension */
+      GST_OBJECT_LOCK (self);
+      port = (prop_id == ARG_NUM_INPUT_BUFFERS) ? self->in_port : self->out_port;
+      if (port)
+        port_index = port->port_index;
+      GST_OBJECT_UNLOCK (self);
 
-      if (G_UNLIKELY (!omx_handle)) {
+      if (G_UNLIKELY (!omx_handle || !port)) {
         GST_WARNING_OBJECT (self, "no component");
         g_value_set_uint (value, 0);
         break;
@@ -428,12 +1182,84 @@ get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
 
       G_OMX_INIT_PARAM (param);
 
-      param.nPortIndex = port->port_index;
+      param.nPortIndex = port_index;
       OMX_GetParameter (omx_handle, OMX_IndexParamPortDefinition, &param);
 
       g_value_set_uint (value, param.nBufferCountActual);
     }
       break;
+    case ARG_MAX_INPUT_FRAME_SIZE:
+      g_value_set_uint (value, self->max_input_frame_size);
+      break;
+    case ARG_BUFFER_MEMORY:
+      /* MODIFICATION: as charged to the memory budget, all instances */
+      g_value_set_uint (value, MIN (g_omx_memory_get_element_usage (self),
+              G_MAXUINT));
+      break;
+    case ARG_POOL_ALLOCATIONS:
+      g_value_set_uint (value, self->out_pool->allocations);
+      break;
+    case ARG_POOL_PEAK:
+      g_value_set_uint (value, self->out_pool->peak);
+      break;
+    case ARG_BATCH_DURATION:
+      g_value_set_uint64 (value, self->batch_duration);
+      break;
+    case ARG_FRAMES_PER_PACKET:
+      g_value_set_uint (value, self->frames_per_packet);
+      break;
+    case ARG_VAD:
+      g_value_set_boolean (value, self->vad);
+      break;
+    case ARG_VAD_THRESHOLD:
+      g_value_set_int (value, self->vad_threshold);
+      break;
+    case ARG_VAD_HANGOVER:
+      g_value_set_uint (value, self->vad_hangover);
+      break;
+    case ARG_MEMFD:
+      g_value_set_boolean (value, self->memfd);
+      break;
+    case ARG_INSTANCES:
+      g_value_set_uint (value, self->n_instances);
+      break;
+    case ARG_UNIT_FRAMES:
+      g_value_set_uint (value, self->unit_frames);
+      break;
+    case ARG_PRIORITY:
+      g_value_set_int (value, self->gomx->priority);
+      break;
+    case ARG_PREEMPTIBLE:
+      g_value_set_boolean (value, self->gomx->preemptible);
+      break;
+    case ARG_ADMISSION_TIMEOUT:
+      g_value_set_uint (value, self->gomx->admission_timeout / 1000);
+      break;
+    case ARG_IDLE_TIMEOUT:
+      g_value_set_uint (value, self->idle_timeout);
+      break;
+    case ARG_RESUME_LATENCY:
+      g_value_set_uint64 (value, self->resume_latency);
+      break;
+    case ARG_HUGE_PAGES:
+      g_value_set_boolean (value, self->huge_pages);
+      break;
+    case ARG_LOCK_BUFFERS:
+      g_value_set_boolean (value, self->lock_buffers);
+      break;
+    case ARG_HUGE_PAGE_MEMORY:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint64 (value, (self->in_port && self->out_port) ?
+          g_omx_port_get_huge_page_bytes (self->in_port) +
+          g_omx_port_get_huge_page_bytes (self->out_port) : 0);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case ARG_ARENA_REUSES:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, (self->in_port && self->out_port) ?
+          self->in_port->arena_reuses + self->out_port->arena_reuses : 0);
+      GST_OBJECT_UNLOCK (self);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
       break;
@@ -469,255 +1295,1334 @@ type_class_init (gpointer g_class, gpointer class_data)
             "Whether or not to use timestamps",
             TRUE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
-    g_object_class_install_property (gobject_class, ARG_NUM_INPUT_BUFFERS,
-        g_param_spec_uint ("input-buffers", "Input buffers",
-            "The number of OMX input buffers",
-            1, 10, 4, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
-    g_object_class_install_property (gobject_class, ARG_NUM_OUTPUT_BUFFERS,
-        g_param_spec_uint ("output-buffers", "Output buffers",
-            "The number of OMX output buffers",
-            1, 10, 4, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_NUM_INPUT_BUFFERS,
+        g_param_spec_uint ("input-buffers", "Input buffers",
+            "The number of OMX input buffers",
+            1, 10, 4, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_NUM_OUTPUT_BUFFERS,
+        g_param_spec_uint ("output-buffers", "Output buffers",
+            "The number of OMX output buffers",
+            1, 10, 4, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_MAX_INPUT_FRAME_SIZE,
+        g_param_spec_uint ("max-input-frame-size", "Max input frame size",
+            "Size of the largest expected input frame in bytes, used as "
+            "the initial input buffer size (0 = component default)",
+            0, GSTOMX_MAX_INPUT_BUFFER_SIZE, 0,
+            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_BUFFER_MEMORY,
+        g_param_spec_uint ("buffer-memory", "Buffer memory",
+            "Bytes taken by the OpenMAX input and output buffers of the "
+            "element, as charged to the OMX_MEMORY_BUDGET",
+            0, G_MAXUINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_POOL_ALLOCATIONS,
+        g_param_spec_uint ("pool-allocations", "Pool allocations",
+            "Output buffers allocated rather than recycled",
+            0, G_MAXUINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_POOL_PEAK,
+        g_param_spec_uint ("pool-peak", "Pool peak",
+            "Most output buffers from the pool alive at once",
+            0, G_MAXUINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_BATCH_DURATION,
+        g_param_spec_uint64 ("batch-duration", "Batch duration",
+            "Pack contiguous input buffers spanning up to this many "
+            "nanoseconds into one OMX buffer (0 = disabled)",
+            0, GST_SECOND, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_MEMFD,
+        g_param_spec_boolean ("memfd", "memfd buffers",
+            "Push output buffers in memfd memory another process can map "
+            "(set in NULL state)",
+            FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_INSTANCES,
+        g_param_spec_uint ("instances", "Instances",
+            "Component instances coding work units side by side, for "
+            "elements whose units are independent (set in NULL state)",
+            1, GSTOMX_MAX_INSTANCES, 1,
+            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_UNIT_FRAMES,
+        g_param_spec_uint ("unit-frames", "Unit frames",
+            "Input frames in a work unit; 0 for one picture, or the I-frame "
+            "interval of a video encoder",
+            0, G_MAXUINT, 0,
+            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_PRIORITY,
+        g_param_spec_int ("priority", "Priority",
+            "Sessions of higher priority get a component instance first "
+            "when the platform runs out of them",
+            G_MININT, G_MAXINT, 0,
+            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_PREEMPTIBLE,
+        g_param_spec_boolean ("preemptible", "Preemptible",
+            "Stop with a resource busy error when a session of higher "
+            "priority waits for the instance",
+            FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_ADMISSION_TIMEOUT,
+        g_param_spec_uint ("admission-timeout", "Admission timeout",
+            "Milliseconds to wait for a free component instance",
+            0, G_MAXUINT / 1000, G_OMX_ADMISSION_TIMEOUT / 1000,
+            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_IDLE_TIMEOUT,
+        g_param_spec_uint ("idle-timeout", "Idle timeout",
+            "Seconds without input after which the component releases its "
+            "buffers and instance until the next buffer, 0 never "
+            "(set in READY state)",
+            0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_RESUME_LATENCY,
+        g_param_spec_uint64 ("resume-latency", "Resume latency",
+            "Nanoseconds the last restore of a suspended component took",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_HUGE_PAGES,
+        g_param_spec_boolean ("huge-pages", "Huge pages",
+            "Ask for transparent huge pages behind port buffers of 2 MiB "
+            "and more (set in NULL state)",
+            FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_LOCK_BUFFERS,
+        g_param_spec_boolean ("lock-buffers", "Lock buffers",
+            "Keep port buffers in RAM with mlock, within RLIMIT_MEMLOCK "
+            "(set in NULL state)",
+            FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_HUGE_PAGE_MEMORY,
+        g_param_spec_uint64 ("huge-page-memory", "Huge page memory",
+            "Bytes of the port buffers backed by huge pages",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+    g_object_class_install_property (gobject_class, ARG_ARENA_REUSES,
+        g_param_spec_uint ("arena-reuses", "Arena reuses",
+            "Port buffer allocations served by memory already mapped",
+            0, G_MAXUINT, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  }
+}
+
+/* MODIFICATION: properties of the output splitting and input gating done for
+ * voice encoders; those install them from their class_init and chain their
+ * set_property and get_property up for ids they do not know */
+void
+gst_omx_base_filter_install_voice_properties (GObjectClass * gobject_class)
+{
+  g_object_class_install_property (gobject_class, ARG_FRAMES_PER_PACKET,
+      g_param_spec_uint ("frames-per-packet", "Frames per packet",
+          "Codec frames per output buffer where the encoder output can "
+          "be split (0 = as produced)",
+          0, G_MAXUINT, 1, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_VAD,
+      g_param_spec_boolean ("vad", "VAD",
+          "Hold back 16 bit raw input that stays below vad-threshold "
+          "for longer than vad-hangover",
+          FALSE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_VAD_THRESHOLD,
+      g_param_spec_int ("vad-threshold", "VAD threshold",
+          "Input level in dBov under which input counts as silence",
+          -96, 0, DEFAULT_VAD_THRESHOLD,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  g_object_class_install_property (gobject_class, ARG_VAD_HANGOVER,
+      g_param_spec_uint ("vad-hangover", "VAD hangover",
+          "Milliseconds of silence still encoded after voice",
+          0, G_MAXUINT, DEFAULT_VAD_HANGOVER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+/* size and duration of the codec frame at data, 0 if it can not be told */
+static guint
+output_frame_size (GstOmxBaseFilter * self, const guint8 * data, guint size,
+    GstClockTime * duration)
+{
+  GstOmxBaseFilterClass *basefilter_class;
+
+  basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+  if (basefilter_class->output_frame_size)
+    return basefilter_class->output_frame_size (self, data, size, duration);
+
+  if (self->codec_frame_bytes == 0)
+    return 0;
+
+  if (size < self->codec_frame_bytes) {
+    *duration = gst_util_uint64_scale_int (self->codec_frame_duration, size,
+        self->codec_frame_bytes);
+    return size;
+  }
+
+  *duration = self->codec_frame_duration;
+  return self->codec_frame_bytes;
+}
+
+/*
+ *  description : push multi-frame output as a list of sub-buffers
+ *  params      : @self: base filter, @buf: output buffer, consumed
+ *  return      : flow return of the push
+ *  comments    : each group of the list is one sub-buffer of frames_per_packet
+ *                codec frames of buf, so nothing is copied; bytes that do not
+ *                parse as frames go out as the last group without a duration
+ */
+static GstFlowReturn
+push_frames (GstOmxBaseFilter * self, GstBuffer * buf)
+{
+  GstBufferList *list;
+  GstBufferListIterator *it;
+  GstClockTime timestamp = GST_BUFFER_TIMESTAMP (buf);
+  guint offset = 0, groups = 0;
+
+  list = gst_buffer_list_new ();
+  it = gst_buffer_list_iterate (list);
+
+  while (offset < GST_BUFFER_SIZE (buf)) {
+    guint remaining = GST_BUFFER_SIZE (buf) - offset;
+    guint size = 0, frames;
+    GstClockTime duration = 0;
+    GstBuffer *sub;
+
+    for (frames = 0; frames < self->frames_per_packet && size < remaining;
+        frames++) {
+      GstClockTime frame_duration = 0;
+      guint frame;
+
+      frame = output_frame_size (self, GST_BUFFER_DATA (buf) + offset + size,
+          remaining - size, &frame_duration);
+      if (frame == 0 || frame > remaining - size)
+        break;
+
+      size += frame;
+      duration += frame_duration;
+    }
+
+    if (size == 0) {
+      size = remaining;
+      duration = GST_CLOCK_TIME_NONE;
+    }
+
+    sub = gst_buffer_create_sub (buf, offset, size);
+    gst_buffer_copy_metadata (sub, buf, (offset == 0) ?
+        GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_CAPS : GST_BUFFER_COPY_CAPS);
+    GST_BUFFER_TIMESTAMP (sub) = timestamp;
+    GST_BUFFER_DURATION (sub) = duration;
+
+    if (GST_CLOCK_TIME_IS_VALID (timestamp) &&
+        GST_CLOCK_TIME_IS_VALID (duration))
+      timestamp += duration;
+    else
+      timestamp = GST_CLOCK_TIME_NONE;
+
+    gst_buffer_list_iterator_add_group (it);
+    gst_buffer_list_iterator_add (it, sub);
+
+    offset += size;
+    groups++;
+  }
+
+  gst_buffer_list_iterator_free (it);
+
+  if (groups <= 1) {
+    gst_buffer_list_unref (list);
+    return gst_pad_push (self->srcpad, buf);
+  }
+
+  GST_LOG_OBJECT (self, "split into %u buffers", groups);
+
+  /* the sub-buffers hold on to the data */
+  gst_buffer_unref (buf);
+
+  return gst_pad_push_list (self->srcpad, list);
+}
+
+/*
+ *  description : latency the element adds to its input
+ *  params      : @self: base filter, @min: always added, @max: at most added
+ *  return      : none
+ *  comments    : min is the measured component time plus input held back for
+ *                batching or framing, max adds the frames both ports can hold
+ */
+static void
+get_latency (GstOmxBaseFilter * self, GstClockTime * min, GstClockTime * max)
+{
+  GstClockTime frame;
+
+  *min = *max = 0;
+  if (self->use_inline)
+    return;
+
+  GST_OBJECT_LOCK (self);
+  frame = GST_CLOCK_TIME_IS_VALID (self->in_frame_duration) ?
+      self->in_frame_duration : 0;
+
+  *min = self->proc_latency;
+  if (self->batch_duration > 0)
+    *min += self->batch_duration;
+  else if (self->adapter_size > 0 || self->use_framing)
+    *min += frame;
+
+  *max = *min;
+  if (self->in_port && self->out_port)
+    *max += (self->in_port->num_buffers + self->out_port->num_buffers) * frame;
+  GST_OBJECT_UNLOCK (self);
+}
+
+/* keep the duration of the input frames for the latency */
+static void
+note_input_duration (GstOmxBaseFilter * self, GstBuffer * buf)
+{
+  GstClockTime duration = GST_CLOCK_TIME_NONE;
+
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    duration = GST_BUFFER_DURATION (buf);
+  else if (GST_BUFFER_TIMESTAMP_IS_VALID (buf) &&
+      GST_CLOCK_TIME_IS_VALID (self->last_in_timestamp) &&
+      GST_BUFFER_TIMESTAMP (buf) > self->last_in_timestamp)
+    duration = GST_BUFFER_TIMESTAMP (buf) - self->last_in_timestamp;
+
+  self->last_in_timestamp = GST_BUFFER_TIMESTAMP (buf);
+
+  if (GST_CLOCK_TIME_IS_VALID (duration)) {
+    GST_OBJECT_LOCK (self);
+    self->in_frame_duration = duration;
+    GST_OBJECT_UNLOCK (self);
+  }
+}
+
+/* time one input buffer at once through the component */
+static void
+latency_probe_input (GstOmxBaseFilter * self, OMX_BUFFERHEADERTYPE * omx_buffer)
+{
+  if (!self->use_timestamps || omx_buffer->nFilledLen == 0)
+    return;
+
+  GST_OBJECT_LOCK (self);
+  if (!GST_CLOCK_TIME_IS_VALID (self->probe_sent)) {
+    self->probe_timestamp = omx_buffer->nTimeStamp;
+    self->probe_sent = gst_util_get_timestamp ();
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/*
+ *  description : finish the timing of latency_probe_input with its output
+ *  params      : @self: base filter, @omx_buffer: output buffer
+ *  return      : none
+ *  comments    : the processing time is smoothed over about eight probes; a
+ *                latency message goes out when the minimum moved by a quarter
+ */
+static void
+latency_probe_output (GstOmxBaseFilter * self,
+    OMX_BUFFERHEADERTYPE * omx_buffer)
+{
+  GstClockTime elapsed, min, max, posted;
+
+  GST_OBJECT_LOCK (self);
+  if (!GST_CLOCK_TIME_IS_VALID (self->probe_sent) ||
+      omx_buffer->nTimeStamp < self->probe_timestamp) {
+    GST_OBJECT_UNLOCK (self);
+    return;
+  }
+
+  elapsed = gst_util_get_timestamp () - self->probe_sent;
+  self->probe_sent = GST_CLOCK_TIME_NONE;
+
+  if (self->proc_latency == 0)
+    self->proc_latency = elapsed;
+  else
+    self->proc_latency = (self->proc_latency * 7 + elapsed) / 8;
+  GST_OBJECT_UNLOCK (self);
+
+  get_latency (self, &min, &max);
+
+  posted = self->posted_latency;
+  if (GST_CLOCK_TIME_IS_VALID (posted) &&
+      min <= posted + posted / 4 && min + posted / 4 >= posted)
+    return;
+
+  self->posted_latency = min;
+
+  GST_INFO_OBJECT (self, "latency %" GST_TIME_FORMAT " - %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (min), GST_TIME_ARGS (max));
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_latency (GST_OBJECT (self)));
+}
+
+/* MODIFICATION: add the latency of the element to the upstream one */
+static gboolean
+src_query (GstPad * pad, GstQuery * query)
+{
+  GstOmxBaseFilter *self;
+  gboolean ret;
+
+  self = GST_OMX_BASE_FILTER (gst_pad_get_parent (pad));
+
+  /* MODIFICATION: where downstream in another process maps our buffers */
+  if (GST_QUERY_TYPE (query) == gstomx_memfd_query_type ()) {
+    ret = gstomx_memfd_query_answer (query);
+    gst_object_unref (self);
+    return ret;
+  }
+
+  switch (GST_QUERY_TYPE (query)) {
+    case GST_QUERY_LATENCY:
+    {
+      gboolean live;
+      GstClockTime min, max, own_min, own_max;
+
+      ret = gst_pad_peer_query (self->sinkpad, query);
+      if (ret) {
+        gst_query_parse_latency (query, &live, &min, &max);
+        get_latency (self, &own_min, &own_max);
+
+        GST_DEBUG_OBJECT (self, "own latency %" GST_TIME_FORMAT " - %"
+            GST_TIME_FORMAT, GST_TIME_ARGS (own_min), GST_TIME_ARGS (own_max));
+
+        min += own_min;
+        if (GST_CLOCK_TIME_IS_VALID (max))
+          max += own_max;
+
+        gst_query_set_latency (query, live, min, max);
+      }
+      break;
+    }
+    default:
+      ret = gst_pad_query_default (pad, query);
+      break;
+  }
+
+  gst_object_unref (self);
+
+  return ret;
+}
+
+/* push an output buffer downstream, split into codec frames if asked */
+static GstFlowReturn
+push_out (GstOmxBaseFilter * self, GstBuffer * buf)
+{
+  GstOmxBaseFilterClass *basefilter_class;
+  GstFlowReturn ret;
+
+  basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+
+  GST_LOG_OBJECT (self, "OUT_BUFFER: timestamp = %" GST_TIME_FORMAT " size = %lu",
+      GST_TIME_ARGS(GST_BUFFER_TIMESTAMP (buf)), GST_BUFFER_SIZE (buf));
+  if (self->frames_per_packet > 0 && (self->codec_frame_bytes > 0 ||
+          basefilter_class->output_frame_size))
+    ret = push_frames (self, buf);
+  else
+    ret = gst_pad_push (self->srcpad, buf);
+  GST_LOG_OBJECT (self, "gst_pad_push end. ret = %d", ret);
+
+  return ret;
+}
+
+/* MODIFICATION: index is the component instance the output comes from */
+static GstFlowReturn
+push_lane_buffer (GstOmxBaseFilter * self, GstBuffer * buf,
+    OMX_BUFFERHEADERTYPE * omx_buffer, guint index)
+{
+  GstOmxBaseFilterClass *basefilter_class;
+
+  if (index == 0)
+    latency_probe_output (self, omx_buffer);
+
+  /* the instances share the subclass state */
+  if (self->instances)
+    g_mutex_lock (self->instances->process_lock);
+
+  basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+  /* process output gst buffer before gst_pad_push */
+  if (basefilter_class->process_output_buf) {
+    basefilter_class->process_output_buf(self, &buf, omx_buffer);
+  }
+
+  /* MODIFICATION: the first output after held back silence starts a talk
+   * spurt, which payloaders mark */
+  if (self->vad && GST_BUFFER_TIMESTAMP_IS_VALID (buf)) {
+    gboolean discont = FALSE;
+
+    GST_OBJECT_LOCK (self);
+    if (GST_CLOCK_TIME_IS_VALID (self->vad_resume_timestamp) &&
+        GST_BUFFER_TIMESTAMP (buf) >= self->vad_resume_timestamp) {
+      self->vad_resume_timestamp = GST_CLOCK_TIME_NONE;
+      discont = TRUE;
+    }
+    GST_OBJECT_UNLOCK (self);
+
+    if (discont) {
+      buf = gst_buffer_make_metadata_writable (buf);
+      GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+    }
+  }
+
+  if (self->instances) {
+    g_mutex_unlock (self->instances->process_lock);
+    return gstomx_instances_push (self->instances, index, buf);
+  }
+
+  return push_out (self, buf);
+}
+
+static inline GstFlowReturn
+push_buffer (GstOmxBaseFilter * self, GstBuffer * buf, OMX_BUFFERHEADERTYPE * omx_buffer)
+{
+  return push_lane_buffer (self, buf, omx_buffer, 0);
+}
+
+/* Returns FALSE when the whole output buffer falls outside the current
+ * segment, so it can go straight back to the component. Boundary buffers
+ * may be trimmed by the subclass through nOffset/nFilledLen. Only the
+ * decoder base classes clip; encoder output keeps the timestamps of input
+ * upstream already clipped. */
+static inline gboolean
+clip_output_buf (GstOmxBaseFilter * self, OMX_BUFFERHEADERTYPE * omx_buffer)
+{
+  GstOmxBaseFilterClass *basefilter_class;
+  gboolean in_segment = TRUE;
+
+  basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+
+  if (!self->use_timestamps || !basefilter_class->clip_output_buf)
+    return TRUE;
+
+  GST_OBJECT_LOCK (self);
+  if (self->segment.format == GST_FORMAT_TIME)
+    in_segment = basefilter_class->clip_output_buf (self, omx_buffer,
+        &self->segment);
+  GST_OBJECT_UNLOCK (self);
+
+  return in_segment;
+}
+
+/*
+ *  description : push the picture of an extended color format output buffer
+ *  params      : @self: base filter, @omx_buffer: output buffer, kept by the caller
+ *  return      : flow return of the push, GST_FLOW_ERROR for a broken picture
+ *  comments    : tiled pixels are converted to NV12, physical addresses are
+ *                copied as they are
+ */
+static GstFlowReturn
+push_extended_buffer (GstOmxBaseFilter * self, OMX_BUFFERHEADERTYPE * omx_buffer)
+{
+  GstCaps *caps = NULL;
+  GstStructure *structure;
+  GstBuffer *buf;
+  gint width = 0, height = 0;
+  gboolean tiled;
+
+  if (G_UNLIKELY (omx_buffer->nFlags & OMX_BUFFERFLAG_DECODEONLY))
+    return GST_FLOW_OK;
+
+  caps = gst_pad_get_negotiated_caps (self->srcpad);
+  if (G_UNLIKELY (!caps)) {
+    GST_ERROR_OBJECT (self, "no caps for extended color format output");
+    return GST_FLOW_NOT_NEGOTIATED;
+  }
+  structure = gst_caps_get_structure (caps, 0);
+
+  gst_structure_get_int (structure, "width", &width);
+  gst_structure_get_int (structure, "height", &height);
+
+  if (G_UNLIKELY ((width <= 0) || (height <= 0))) {
+    GST_ERROR_OBJECT (self, "invalid buffer size");
+    gst_caps_unref (caps);
+    return GST_FLOW_UNEXPECTED;
+  }
+
+  tiled = port_color_format (self, self->out_port) ==
+      (guint) OMX_EXT_COLOR_FormatNV12Tiled;
+
+  buf = gstomx_buffer_pool_get (self->out_pool,
+      tiled ? gstomx_nv12_size (width, height) : width * height * 3 / 2);
+
+  if (!tiled) {
+    memcpy (GST_BUFFER_MALLOCDATA (buf), omx_buffer->pBuffer,
+        omx_buffer->nFilledLen);
+  } else if (omx_buffer->nFilledLen >= gstomx_nv12t_size (width, height)) {
+    gstomx_nv12t_to_nv12 (GST_BUFFER_MALLOCDATA (buf),
+        omx_buffer->pBuffer + omx_buffer->nOffset, width, height);
+  } else {
+    GST_ELEMENT_ERROR (self, STREAM, DECODE, (NULL),
+        ("tiled frame too short: %lu < %" G_GSIZE_FORMAT,
+            omx_buffer->nFilledLen, gstomx_nv12t_size (width, height)));
+    gst_buffer_unref (buf);
+    gst_caps_unref (caps);
+    return GST_FLOW_ERROR;
+  }
+
+  if (self->use_timestamps) {
+    GST_BUFFER_TIMESTAMP (buf) =
+        gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
+        OMX_TICKS_PER_SECOND);
+  }
+  gst_buffer_set_caps (buf, GST_PAD_CAPS (self->srcpad));
+  gst_caps_unref (caps);
+
+  return push_buffer (self, buf, omx_buffer);
+}
+
+/*
+ *  description : push the data of an output buffer downstream
+ *  params      : @self: base filter, @omx_buffer: output buffer, kept by the caller
+ *  return      : flow return of the push, GST_FLOW_UNEXPECTED after EOS
+ *  comments    : used by output_loop and for the buffers drained while the
+ *                output port is resized, so both clip, convert and forward
+ *                EOS the same way
+ */
+static GstFlowReturn
+push_output_buffer (GstOmxBaseFilter * self, OMX_BUFFERHEADERTYPE * omx_buffer)
+{
+  GOmxCore *gomx = self->gomx;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  if (G_LIKELY (omx_buffer->nFilledLen > 0)) {
+    GstBuffer *buf;
+    OMX_U32 offset = omx_buffer->nOffset;
+
+#if 1
+          /** @todo remove this check */
+    if (G_LIKELY (self->in_port->enabled)) {
+      GstCaps *caps = NULL;
+
+      caps = gst_pad_get_negotiated_caps (self->srcpad);
+
+      if (!caps) {
+                  /** @todo We shouldn't be doing this. */
+        GST_WARNING_OBJECT (self, "faking settings changed notification");
+        if (gomx->settings_changed_cb)
+          gomx->settings_changed_cb (gomx);
+      } else {
+        GST_LOG_OBJECT (self, "caps already fixed: %" GST_PTR_FORMAT, caps);
+        gst_caps_unref (caps);
+      }
+    }
+#endif
+
+    /* buf is always null when the output buffer pointer isn't shared. */
+    buf = omx_buffer->pAppPrivate;
+
+          /** @todo we need to move all the caps handling to one single
+           * place, in the output loop probably. */
+    if (G_UNLIKELY (omx_buffer->nFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+      /* modification: to handle both byte-stream and packetized codec_data */
+      GstOmxBaseFilterClass *basefilter_class;
+
+      basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+      if (basefilter_class->process_output_caps) {
+        basefilter_class->process_output_caps(self, omx_buffer);
+      }
+    } else if (!clip_output_buf (self, omx_buffer)) {
+      /* nothing downstream would keep it, recycle without copying */
+      GST_LOG_OBJECT (self, "dropping buffer outside of segment");
+      /* MODIFICATION: to handle output ST12 HW addr (dec) */
+    } else if (is_extended_color_format(self, self->out_port)) {
+      ret = push_extended_buffer (self, omx_buffer);
+    } else if (self->convert_output) {
+      /* MODIFICATION: only the visible part is copied, in the caps layout */
+      GstOmxBaseFilterClass *basefilter_class;
+
+      basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+      ret = gst_pad_alloc_buffer_and_set_caps (self->srcpad,
+          GST_BUFFER_OFFSET_NONE, self->out_frame_size,
+          GST_PAD_CAPS (self->srcpad), &buf);
+
+      if (G_LIKELY (buf)) {
+        if (basefilter_class->convert_output_buf (self, omx_buffer,
+                GST_BUFFER_DATA (buf))) {
+          if (self->use_timestamps) {
+            GST_BUFFER_TIMESTAMP (buf) =
+                gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
+                OMX_TICKS_PER_SECOND);
+          }
+          ret = push_buffer (self, buf, omx_buffer);
+        } else {
+          gst_buffer_unref (buf);
+        }
+      } else {
+        GST_WARNING_OBJECT (self, "couldn't allocate buffer of size %u",
+            self->out_frame_size);
+      }
+    } else if (buf && !(omx_buffer->nFlags & OMX_BUFFERFLAG_EOS)) {
+      GST_BUFFER_DATA (buf) += omx_buffer->nOffset;
+      GST_BUFFER_SIZE (buf) = omx_buffer->nFilledLen;
+      if (self->use_timestamps) {
+        GST_BUFFER_TIMESTAMP (buf) =
+            gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
+            OMX_TICKS_PER_SECOND);
+      }
+
+      omx_buffer->pAppPrivate = NULL;
+      omx_buffer->pBuffer = NULL;
+
+      ret = push_buffer (self, buf, omx_buffer);
+
+      gst_buffer_unref (buf);
+    } else {
+      /* This is only meant for the first OpenMAX buffers,
+       * which need to be pre-allocated. */
+      /* Also for the very last one. */
+      if (self->memfd) {
+        /* one pool size for every fill level, so the buffers recycle; the
+         * pool restores the size when a buffer comes back */
+        buf = gstomx_buffer_pool_get (self->out_pool, omx_buffer->nAllocLen);
+        GST_BUFFER_SIZE (buf) = omx_buffer->nFilledLen;
+        gst_buffer_set_caps (buf, GST_PAD_CAPS (self->srcpad));
+        ret = GST_FLOW_OK;
+      } else {
+        ret = gst_pad_alloc_buffer_and_set_caps (self->srcpad,
+            GST_BUFFER_OFFSET_NONE,
+            omx_buffer->nFilledLen, GST_PAD_CAPS (self->srcpad), &buf);
+      }
+
+      if (G_LIKELY (buf)) {
+        memcpy (GST_BUFFER_DATA (buf),
+            omx_buffer->pBuffer + omx_buffer->nOffset,
+            omx_buffer->nFilledLen);
+        if (self->use_timestamps) {
+          GST_BUFFER_TIMESTAMP (buf) =
+              gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
+              OMX_TICKS_PER_SECOND);
+        }
+
+        if (self->out_port->shared_buffer) {
+          GST_WARNING_OBJECT (self, "couldn't zero-copy");
+          /* If pAppPrivate is NULL, it means it was a dummy
+           * allocation, free it. */
+          if (!omx_buffer->pAppPrivate) {
+            g_free (omx_buffer->pBuffer);
+            omx_buffer->pBuffer = NULL;
+          }
+        }
+
+        ret = push_buffer (self, buf, omx_buffer);
+      } else {
+        GST_WARNING_OBJECT (self, "couldn't allocate buffer of size %lu",
+            omx_buffer->nFilledLen);
+      }
+    }
+
+    /* undo any trimming done by clip_output_buf */
+    omx_buffer->nOffset = offset;
+  } else {
+    GST_WARNING_OBJECT (self, "empty buffer");
+  }
+
+  if (G_UNLIKELY (omx_buffer->nFlags & OMX_BUFFERFLAG_EOS)) {
+    GST_DEBUG_OBJECT (self, "got eos");
+    if (self->instances)
+      gstomx_instances_finish (self->instances);
+    gst_pad_push_event (self->srcpad, gst_event_new_eos ());
+    omx_buffer->nFlags &= ~OMX_BUFFERFLAG_EOS;
+    ret = GST_FLOW_UNEXPECTED;
+  }
+
+  return ret;
+}
+
+/* MODIFICATION: send the data of an output buffer returned while the port
+ * is being disabled, like output_loop would */
+static void
+drain_output_buffer (GOmxPort * port, OMX_BUFFERHEADERTYPE * omx_buffer,
+    gpointer data)
+{
+  GstOmxBaseFilter *self = data;
+
+  if (self->last_pad_push_return != GST_FLOW_OK)
+    return;
+
+  self->last_pad_push_return = push_output_buffer (self, omx_buffer);
+  omx_buffer->nFilledLen = 0;
+}
+
+/* MODIFICATION: grow the output buffers to out_buffer_size_max after the
+ * component filled a whole one; called from output_loop holding omx_buffer,
+ * which is then recycled */
+static void
+resize_output_port (GstOmxBaseFilter * self, OMX_BUFFERHEADERTYPE * omx_buffer)
+{
+  GOmxPort *port = self->out_port;
+  guint size;
+
+  /* disabling the port stalls the stream, it is done once per size set */
+  size = self->out_buffer_size_max;
+  if (self->out_resized || size <= port->buffer_size) {
+    g_omx_port_release_buffer (port, omx_buffer);
+    return;
+  }
+  self->out_resized = TRUE;
+
+  GST_INFO_OBJECT (self, "output buffer size %lu -> %u", port->buffer_size,
+      size);
+
+  if (!g_omx_port_set_buffer_size (port, size, 1, drain_output_buffer, self)) {
+    GST_ELEMENT_ERROR (self, STREAM, FAILED, (NULL),
+        ("output buffers not resized"));
+    self->last_pad_push_return = GST_FLOW_ERROR;
+  }
+}
+
+static void
+output_loop (gpointer data)
+{
+  GstPad *pad;
+  GOmxCore *gomx;
+  GOmxPort *out_port;
+  GstOmxBaseFilter *self;
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  pad = data;
+  self = GST_OMX_BASE_FILTER (gst_pad_get_parent (pad));
+  gomx = self->gomx;
+
+  GST_LOG_OBJECT (self, "begin");
+
+  /* do not bother if we have been setup to bail out */
+  if ((ret = g_atomic_int_get (&self->last_pad_push_return)) != GST_FLOW_OK)
+    goto leave;
+
+  if (!self->ready) {
+    g_error ("not ready");
+    return;
+  }
+
+  out_port = self->out_port;
+
+  if (G_LIKELY (out_port->enabled)) {
+    OMX_BUFFERHEADERTYPE *omx_buffer = NULL;
+    gboolean overflow;
+
+    GST_LOG_OBJECT (self, "request buffer");
+    omx_buffer = g_omx_port_request_buffer (out_port);
+
+    GST_LOG_OBJECT (self, "omx_buffer: %p", omx_buffer);
+
+    if (G_UNLIKELY (!omx_buffer)) {
+      GST_WARNING_OBJECT (self, "null buffer: leaving");
+      ret = GST_FLOW_WRONG_STATE;
+      goto leave;
+    }
+
+    log_buffer (self, omx_buffer, "output_loop");
+
+    /* a full buffer without the end of a frame means the frame did not fit */
+    overflow = self->out_buffer_size_max > 0 &&
+        omx_buffer->nOffset + omx_buffer->nFilledLen >= omx_buffer->nAllocLen &&
+        !(omx_buffer->nFlags & (OMX_BUFFERFLAG_ENDOFFRAME |
+                OMX_BUFFERFLAG_CODECCONFIG | OMX_BUFFERFLAG_EOS));
+
+    ret = push_output_buffer (self, omx_buffer);
+
+    if (self->out_port->shared_buffer &&
+        !omx_buffer->pBuffer && omx_buffer->nOffset == 0) {
+      GstBuffer *buf;
+      GstFlowReturn result;
+
+      GST_LOG_OBJECT (self, "allocate buffer");
+      /* MODIFICATION: memfd output is always the pool's own */
+      if (self->out_pool_shared || self->memfd) {
+        buf = gstomx_buffer_pool_get (self->out_pool, omx_buffer->nAllocLen);
+        gst_buffer_set_caps (buf, GST_PAD_CAPS (self->srcpad));
+        result = GST_FLOW_OK;
+      } else {
+        result = gst_pad_alloc_buffer_and_set_caps (self->srcpad,
+            GST_BUFFER_OFFSET_NONE,
+            omx_buffer->nAllocLen, GST_PAD_CAPS (self->srcpad), &buf);
+
+        /* MODIFICATION: plain memory from downstream can come from the pool */
+        if (result == GST_FLOW_OK &&
+            G_TYPE_FROM_INSTANCE (buf) == GST_TYPE_BUFFER &&
+            GST_BUFFER_CAPS (buf) && GST_PAD_CAPS (self->srcpad) &&
+            gst_caps_is_equal (GST_BUFFER_CAPS (buf), GST_PAD_CAPS (self->srcpad))) {
+          GST_DEBUG_OBJECT (self, "downstream allocates plain buffers, using pool");
+          self->out_pool_shared = TRUE;
+        }
+      }
+
+      if (G_LIKELY (result == GST_FLOW_OK)) {
+        gst_buffer_ref (buf);
+        omx_buffer->pAppPrivate = buf;
+
+        omx_buffer->pBuffer = GST_BUFFER_DATA (buf);
+        omx_buffer->nAllocLen = GST_BUFFER_SIZE (buf);
+      } else {
+        GST_WARNING_OBJECT (self,
+            "could not pad allocate buffer, using malloc");
+        omx_buffer->pBuffer = g_malloc (omx_buffer->nAllocLen);
+      }
+    }
+
+    if (self->out_port->shared_buffer && !omx_buffer->pBuffer) {
+      GST_ERROR_OBJECT (self, "no input buffer to share");
+    }
+
+    omx_buffer->nFilledLen = 0;
+
+    if (G_UNLIKELY (overflow) && ret == GST_FLOW_OK) {
+      resize_output_port (self, omx_buffer);
+      ret = self->last_pad_push_return;
+      goto leave;
+    }
+
+    GST_LOG_OBJECT (self, "release_buffer");
+    g_omx_port_release_buffer (out_port, omx_buffer);
+  }
+
+leave:
+
+  self->last_pad_push_return = ret;
+
+  if (gomx->omx_error != OMX_ErrorNone)
+    ret = GST_FLOW_ERROR;
+
+  if (ret != GST_FLOW_OK) {
+    GST_INFO_OBJECT (self, "pause task, reason:  %s", gst_flow_get_name (ret));
+    gst_pad_pause_task (self->srcpad);
+  }
+
+  GST_LOG_OBJECT (self, "end");
+
+  gst_object_unref (self);
+}
+
+/*
+ * Picture framing.
+ *
+ * When the upstream chunking does not follow picture boundaries, the
+ * subclass find_frame_start scanner splits the stream so that every OMX
+ * input buffer carries exactly one picture flagged with ENDOFFRAME. In copy
+ * mode the pending picture is assembled straight into an OMX buffer; in
+ * shared mode pictures contained in one GstBuffer are handed over without
+ * copying and only the ones straddling GstBuffers are assembled.
+ */
+
+static inline void
+frame_pending (GstOmxBaseFilter * self, guint8 ** data, guint * size)
+{
+  if (self->frame_buffer) {
+    *data = self->frame_buffer->pBuffer + self->frame_buffer->nOffset;
+    *size = self->frame_buffer->nFilledLen;
+  } else if (self->frame_buf) {
+    *data = GST_BUFFER_DATA (self->frame_buf);
+    *size = GST_BUFFER_SIZE (self->frame_buf);
+  } else {
+    *data = self->frame_data;
+    *size = self->frame_size;
+  }
+}
+
+/* the first picture starting in a buffer carries its timestamp, the
+ * following ones are interpolated from the frame duration */
+static inline void
+frame_begin (GstOmxBaseFilter * self, GstBuffer * buf, gboolean * first)
+{
+  GstClockTime timestamp = GST_BUFFER_TIMESTAMP (buf);
+
+  if (!*first || !GST_CLOCK_TIME_IS_VALID (timestamp)) {
+    timestamp = GST_CLOCK_TIME_NONE;
+    if (GST_CLOCK_TIME_IS_VALID (self->frame_timestamp) &&
+        GST_CLOCK_TIME_IS_VALID (self->frame_duration))
+      timestamp = self->frame_timestamp + self->frame_duration;
+  }
+
+  self->frame_timestamp = timestamp;
+  self->frame_scanned = 0;
+  *first = FALSE;
+}
+
+static inline void
+frame_set_header (GstOmxBaseFilter * self, OMX_BUFFERHEADERTYPE * omx_buffer,
+    gboolean end_of_frame)
+{
+  if (end_of_frame)
+    omx_buffer->nFlags |= OMX_BUFFERFLAG_ENDOFFRAME;
+
+  if (self->use_timestamps && GST_CLOCK_TIME_IS_VALID (self->frame_timestamp)) {
+    omx_buffer->nTimeStamp = gst_util_uint64_scale_int (self->frame_timestamp,
+        OMX_TICKS_PER_SECOND, GST_SECOND);
+  }
+}
+
+/* send the pending picture, or the part of it that filled a buffer */
+static GstFlowReturn
+frame_finish (GstOmxBaseFilter * self, gboolean end_of_frame)
+{
+  OMX_BUFFERHEADERTYPE *omx_buffer;
+
+  if (self->frame_buffer) {
+    omx_buffer = self->frame_buffer;
+    self->frame_buffer = NULL;
+
+    if (end_of_frame) {
+      note_input_frame (self, self->frame_sent + omx_buffer->nFilledLen);
+      self->frame_sent = 0;
+    } else {
+      self->frame_sent += omx_buffer->nFilledLen;
+    }
+  } else if (self->frame_buf || self->frame_data) {
+    omx_buffer = g_omx_port_request_buffer (self->in_port);
+    if (G_UNLIKELY (!omx_buffer))
+      return GST_FLOW_WRONG_STATE;
+
+    reclaim_shared_buffer (omx_buffer);
+    if (self->frame_buf) {
+      omx_buffer->pBuffer = GST_BUFFER_DATA (self->frame_buf);
+      omx_buffer->nAllocLen = GST_BUFFER_SIZE (self->frame_buf);
+      omx_buffer->pAppPrivate = self->frame_buf;
+      self->frame_buf = NULL;
+    } else {
+      omx_buffer->pBuffer = self->frame_data;
+      omx_buffer->nAllocLen = self->frame_size;
+      self->frame_data = NULL;
+      self->frame_size = 0;
+    }
+    omx_buffer->nFilledLen = omx_buffer->nAllocLen;
+    omx_buffer->nOffset = 0;
+    omx_buffer->nFlags = 0;
+  } else {
+    return GST_FLOW_OK;
+  }
+
+  frame_set_header (self, omx_buffer, end_of_frame);
+
+  log_buffer (self, omx_buffer, "frame_finish");
+  latency_probe_input (self, omx_buffer);
+  g_omx_port_release_buffer (self->in_port, omx_buffer);
+
+  /* nothing is pending between two pictures */
+  if (end_of_frame && self->input_resize)
+    resize_input_port (self);
+
+  return GST_FLOW_OK;
+}
+
+/* append data, which is inside buf unless buf is NULL, to the pending
+ * picture */
+static GstFlowReturn
+frame_append (GstOmxBaseFilter * self, GstBuffer * buf, const guint8 * data,
+    guint size)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+
+  if (self->in_port->shared_buffer) {
+    if (size == 0)
+      return GST_FLOW_OK;
+
+    if (buf && !self->frame_buf && !self->frame_data) {
+      /* keep a reference as long as the picture needs no assembly */
+      self->frame_buf = gst_buffer_create_sub (buf,
+          data - GST_BUFFER_DATA (buf), size);
+      return GST_FLOW_OK;
+    }
+
+    if (self->frame_buf) {
+      self->frame_size = GST_BUFFER_SIZE (self->frame_buf);
+      self->frame_data = g_malloc (self->frame_size + size);
+      memcpy (self->frame_data, GST_BUFFER_DATA (self->frame_buf),
+          self->frame_size);
+      gst_buffer_unref (self->frame_buf);
+      self->frame_buf = NULL;
+    } else {
+      self->frame_data = g_realloc (self->frame_data, self->frame_size + size);
+    }
+
+    memcpy (self->frame_data + self->frame_size, data, size);
+    self->frame_size += size;
+    return GST_FLOW_OK;
+  }
+
+  while (size > 0) {
+    OMX_BUFFERHEADERTYPE *omx_buffer;
+    guint len;
 
+    if (!self->frame_buffer) {
+      omx_buffer = g_omx_port_request_buffer (self->in_port);
+      if (G_UNLIKELY (!omx_buffer))
+        return GST_FLOW_WRONG_STATE;
+
+      omx_buffer->nFilledLen = 0;
+      omx_buffer->nFlags = 0;
+      self->frame_buffer = omx_buffer;
+    }
+
+    omx_buffer = self->frame_buffer;
+    len = MIN (size, omx_buffer->nAllocLen - omx_buffer->nOffset -
+        omx_buffer->nFilledLen);
+
+    memcpy (omx_buffer->pBuffer + omx_buffer->nOffset + omx_buffer->nFilledLen,
+        data, len);
+    omx_buffer->nFilledLen += len;
+    data += len;
+    size -= len;
+
+    if (size > 0) {
+      /* picture larger than a buffer, it continues in the next one */
+      GST_DEBUG_OBJECT (self, "picture exceeds input buffer size %lu",
+          omx_buffer->nAllocLen);
+      ret = frame_finish (self, FALSE);
+      self->frame_scanned = 0;
+      if (ret != GST_FLOW_OK)
+        break;
+    }
   }
+
+  return ret;
 }
 
-static inline GstFlowReturn
-push_buffer (GstOmxBaseFilter * self, GstBuffer * buf, OMX_BUFFERHEADERTYPE * omx_buffer)
+/* check the start positions at the end of the pending picture that could
+ * not be checked before data arrived; returns the position in the pending
+ * picture where the next one starts, or -1 */
+static gint
+frame_scan_tail (GstOmxBaseFilter * self, const guint8 * data, guint size)
 {
-  GstFlowReturn ret = GST_FLOW_OK;
   GstOmxBaseFilterClass *basefilter_class;
+  guint8 window[2 * GSTOMX_FRAME_LOOKAHEAD];
+  guint8 *pending;
+  guint pending_size, tail, head, limit;
+  gint start;
 
   basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
-  /* process output gst buffer before gst_pad_push */
-  if (basefilter_class->process_output_buf) {
-    basefilter_class->process_output_buf(self, &buf, omx_buffer);
-  }
 
-  GST_LOG_OBJECT (self, "OUT_BUFFER: timestamp = %" GST_TIME_FORMAT " size = %lu",
-      GST_TIME_ARGS(GST_BUFFER_TIMESTAMP (buf)), GST_BUFFER_SIZE (buf));
-  ret = gst_pad_push (self->srcpad, buf);
-  GST_LOG_OBJECT (self, "gst_pad_push end. ret = %d", ret);
+  frame_pending (self, &pending, &pending_size);
+  if (pending_size <= self->frame_scanned)
+    return -1;
 
-  return ret;
+  tail = MIN (pending_size - self->frame_scanned, GSTOMX_FRAME_LOOKAHEAD - 1);
+  head = MIN (size, GSTOMX_FRAME_LOOKAHEAD - 1);
+  memcpy (window, pending + pending_size - tail, tail);
+  memcpy (window + tail, data, head);
+
+  /* only positions inside the tail, the rest is scanned in place */
+  limit = MIN (tail + head, tail - 1 + GSTOMX_FRAME_LOOKAHEAD);
+  if (limit < GSTOMX_FRAME_LOOKAHEAD)
+    return -1;
+
+  start = basefilter_class->find_frame_start (self, window, limit, 0);
+  if (start >= 0)
+    return pending_size - tail + start;
+
+  self->frame_scanned = pending_size - tail + limit - GSTOMX_FRAME_LOOKAHEAD + 1;
+  return -1;
 }
 
-static void
-output_loop (gpointer data)
+static GstFlowReturn
+frame_chain (GstOmxBaseFilter * self, GstBuffer * buf)
 {
-  GstPad *pad;
-  GOmxCore *gomx;
-  GOmxPort *out_port;
-  GstOmxBaseFilter *self;
+  GstOmxBaseFilterClass *basefilter_class;
+  const guint8 *data;
+  guint size, offset = 0, scan = 0;
+  gboolean first = TRUE;
   GstFlowReturn ret = GST_FLOW_OK;
+  guint8 *pending;
+  guint pending_size;
+  gint start;
 
-  pad = data;
-  self = GST_OMX_BASE_FILTER (gst_pad_get_parent (pad));
-  gomx = self->gomx;
-
-  GST_LOG_OBJECT (self, "begin");
-
-  /* do not bother if we have been setup to bail out */
-  if ((ret = g_atomic_int_get (&self->last_pad_push_return)) != GST_FLOW_OK)
-    goto leave;
+  basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
 
-  if (!self->ready) {
-    g_error ("not ready");
-    return;
-  }
+  data = GST_BUFFER_DATA (buf);
+  size = GST_BUFFER_SIZE (buf);
 
-  out_port = self->out_port;
+  frame_pending (self, &pending, &pending_size);
+  if (pending_size == 0)
+    frame_begin (self, buf, &first);
 
-  if (G_LIKELY (out_port->enabled)) {
-    OMX_BUFFERHEADERTYPE *omx_buffer = NULL;
+  /* a start code straddling the previous buffer */
+  while ((start = frame_scan_tail (self, data, size)) >= 0) {
+    guint8 carry[GSTOMX_FRAME_LOOKAHEAD];
 
-    GST_LOG_OBJECT (self, "request buffer");
-    omx_buffer = g_omx_port_request_buffer (out_port);
+    frame_pending (self, &pending, &pending_size);
+    pending_size -= start;
+    memcpy (carry, pending + start, pending_size);
+    if (self->frame_buffer)
+      self->frame_buffer->nFilledLen = start;
+    else if (self->frame_buf)
+      GST_BUFFER_SIZE (self->frame_buf) = start;
+    else
+      self->frame_size = start;
 
-    GST_LOG_OBJECT (self, "omx_buffer: %p", omx_buffer);
+    if ((ret = frame_finish (self, TRUE)) != GST_FLOW_OK)
+      goto leave;
 
-    if (G_UNLIKELY (!omx_buffer)) {
-      GST_WARNING_OBJECT (self, "null buffer: leaving");
-      ret = GST_FLOW_WRONG_STATE;
+    frame_begin (self, buf, &first);
+    if ((ret = frame_append (self, NULL, carry, pending_size)) != GST_FLOW_OK)
       goto leave;
-    }
+    self->frame_scanned = 1;
+  }
 
-    log_buffer (self, omx_buffer, "output_loop");
+  while ((start = basefilter_class->find_frame_start (self, data, size,
+              scan)) >= 0) {
+    frame_pending (self, &pending, &pending_size);
+    scan = start + 1;
 
-    if (G_LIKELY (omx_buffer->nFilledLen > 0)) {
-      GstBuffer *buf;
+    /* still the picture begun at the start of buf */
+    if (pending_size == 0 && start == offset)
+      continue;
 
-#if 1
-            /** @todo remove this check */
-      if (G_LIKELY (self->in_port->enabled)) {
-        GstCaps *caps = NULL;
+    if ((ret = frame_append (self, buf, data + offset, start - offset)) !=
+        GST_FLOW_OK)
+      goto leave;
+    if ((ret = frame_finish (self, TRUE)) != GST_FLOW_OK)
+      goto leave;
 
-        caps = gst_pad_get_negotiated_caps (self->srcpad);
+    frame_begin (self, buf, &first);
+    offset = start;
+  }
 
-        if (!caps) {
-                    /** @todo We shouldn't be doing this. */
-          GST_WARNING_OBJECT (self, "faking settings changed notification");
-          if (gomx->settings_changed_cb)
-            gomx->settings_changed_cb (gomx);
-        } else {
-          GST_LOG_OBJECT (self, "caps already fixed: %" GST_PTR_FORMAT, caps);
-          gst_caps_unref (caps);
-        }
-      }
-#endif
+  /* the rest starts the next picture */
+  if (offset < size) {
+    guint unscanned;
 
-      /* buf is always null when the output buffer pointer isn't shared. */
-      buf = omx_buffer->pAppPrivate;
+    if (size >= GSTOMX_FRAME_LOOKAHEAD)
+      unscanned = size - MAX (scan, size - GSTOMX_FRAME_LOOKAHEAD + 1);
+    else
+      unscanned = 0;
 
-            /** @todo we need to move all the caps handling to one single
-             * place, in the output loop probably. */
-      if (G_UNLIKELY (omx_buffer->nFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
-        /* modification: to handle both byte-stream and packetized codec_data */
-        GstOmxBaseFilterClass *basefilter_class;
+    if ((ret = frame_append (self, buf, data + offset, size - offset)) !=
+        GST_FLOW_OK)
+      goto leave;
 
-        basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
-        if (basefilter_class->process_output_caps) {
-          basefilter_class->process_output_caps(self, omx_buffer);
-        }
-        /* MODIFICATION: to handle output ST12 HW addr (dec) */
-      } else if (is_extended_color_format(self, self->out_port)) {
-        GstCaps *caps = NULL;
-        GstStructure *structure;
-        gint width = 0, height = 0;
+    frame_pending (self, &pending, &pending_size);
+    if (size >= GSTOMX_FRAME_LOOKAHEAD)
+      self->frame_scanned = pending_size > unscanned ?
+          pending_size - unscanned : 0;
+  }
 
-      if (G_UNLIKELY (omx_buffer->nFlags & OMX_BUFFERFLAG_DECODEONLY))
-              goto leave;
+leave:
+  gst_buffer_unref (buf);
 
-        caps = gst_pad_get_negotiated_caps(self->srcpad);
-        structure = gst_caps_get_structure(caps, 0);
+  return ret;
+}
 
-        gst_structure_get_int(structure, "width", &width);
-        gst_structure_get_int(structure, "height", &height);
+/* drop the pending picture, e.g. on flush */
+static void
+frame_reset (GstOmxBaseFilter * self)
+{
+  if (self->frame_buffer) {
+    self->frame_buffer->nFilledLen = 0;
+    g_omx_port_push_buffer (self->in_port, self->frame_buffer);
+    self->frame_buffer = NULL;
+  }
 
-        if (G_LIKELY((width > 0) && (height > 0))) {
-          buf = gst_buffer_new_and_alloc(width * height * 3 / 2);
-        } else {
-          GST_ERROR_OBJECT (self, "invalid buffer size");
-          ret = GST_FLOW_UNEXPECTED;
-          goto leave;
-        }
+  if (self->frame_buf) {
+    gst_buffer_unref (self->frame_buf);
+    self->frame_buf = NULL;
+  }
 
-        memcpy (GST_BUFFER_MALLOCDATA(buf), omx_buffer->pBuffer, omx_buffer->nFilledLen);
+  g_free (self->frame_data);
+  self->frame_data = NULL;
+  self->frame_size = 0;
+  self->frame_sent = 0;
+  self->frame_scanned = 0;
+  self->frame_has_picture = FALSE;
+  self->frame_timestamp = GST_CLOCK_TIME_NONE;
+}
 
-        if (self->use_timestamps) {
-          GST_BUFFER_TIMESTAMP (buf) =
-              gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
-              OMX_TICKS_PER_SECOND);
-        }
-        gst_buffer_set_caps(buf, GST_PAD_CAPS(self->srcpad));
-        gst_caps_unref (caps);
+/*
+ *  description : whether buf can join the input pending in the ring
+ *  params      : @self: base filter, @buf: next input buffer
+ *  return      : FALSE when the pending input has to be sent first
+ *  comments    : a batch only holds timestamp contiguous buffers, so the time of
+ *                each frame in it stays implied by its position, fits one OMX
+ *                buffer and makes its first frame wait at most batch_duration
+ */
+static gboolean
+ring_accepts (GstOmxBaseFilter * self, GstBuffer * buf)
+{
+  GstOmxRing *ring = &self->ring;
+  guint size = gstomx_ring_available (ring) + GST_BUFFER_SIZE (buf);
+  GstClockTime end;
 
-        ret = push_buffer (self, buf, omx_buffer);
-      } else if (buf && !(omx_buffer->nFlags & OMX_BUFFERFLAG_EOS)) {
-        GST_BUFFER_SIZE (buf) = omx_buffer->nFilledLen;
-        if (self->use_timestamps) {
-          GST_BUFFER_TIMESTAMP (buf) =
-              gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
-              OMX_TICKS_PER_SECOND);
-        }
+  if (self->batch_duration == 0)
+    return size <= self->adapter_size;
 
-        omx_buffer->pAppPrivate = NULL;
-        omx_buffer->pBuffer = NULL;
+  if (gstomx_ring_available (ring) == 0)
+    return TRUE;
 
-        ret = push_buffer (self, buf, omx_buffer);
+  if (GST_BUFFER_IS_DISCONT (buf) || size > self->in_port->buffer_size)
+    return FALSE;
 
-        gst_buffer_unref (buf);
-      } else {
-        /* This is only meant for the first OpenMAX buffers,
-         * which need to be pre-allocated. */
-        /* Also for the very last one. */
-        ret = gst_pad_alloc_buffer_and_set_caps (self->srcpad,
-            GST_BUFFER_OFFSET_NONE,
-            omx_buffer->nFilledLen, GST_PAD_CAPS (self->srcpad), &buf);
+  if (!GST_CLOCK_TIME_IS_VALID (ring->timestamp) ||
+      !GST_BUFFER_TIMESTAMP_IS_VALID (buf))
+    return ring->duration + GST_BUFFER_DURATION (buf) <= self->batch_duration;
 
-        if (G_LIKELY (buf)) {
-          memcpy (GST_BUFFER_DATA (buf),
-              omx_buffer->pBuffer + omx_buffer->nOffset,
-              omx_buffer->nFilledLen);
-          if (self->use_timestamps) {
-            GST_BUFFER_TIMESTAMP (buf) =
-                gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
-                OMX_TICKS_PER_SECOND);
-          }
+  end = ring->timestamp + ring->duration;
+  if (GST_BUFFER_TIMESTAMP (buf) + GSTOMX_BATCH_TOLERANCE < end ||
+      GST_BUFFER_TIMESTAMP (buf) > end + GSTOMX_BATCH_TOLERANCE)
+    return FALSE;
 
-          if (self->out_port->shared_buffer) {
-            GST_WARNING_OBJECT (self, "couldn't zero-copy");
-            /* If pAppPrivate is NULL, it means it was a dummy
-             * allocation, free it. */
-            if (!omx_buffer->pAppPrivate) {
-              g_free (omx_buffer->pBuffer);
-              omx_buffer->pBuffer = NULL;
-            }
-          }
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    end = GST_BUFFER_TIMESTAMP (buf) + GST_BUFFER_DURATION (buf);
+  else
+    end = GST_BUFFER_TIMESTAMP (buf);
 
-          ret = push_buffer (self, buf, omx_buffer);
-        } else {
-          GST_WARNING_OBJECT (self, "couldn't allocate buffer of size %lu",
-              omx_buffer->nFilledLen);
-        }
-      }
-    } else {
-      GST_WARNING_OBJECT (self, "empty buffer");
-    }
+  return end - ring->timestamp <= self->batch_duration;
+}
 
-    if (self->out_port->shared_buffer &&
-        !omx_buffer->pBuffer && omx_buffer->nOffset == 0) {
-      GstBuffer *buf;
-      GstFlowReturn result;
+/*
+ *  description : voice activity detection on raw input
+ *  params      : @self: base filter, @buf: input buffer
+ *  return      : TRUE when buf is silence past the hangover and is dropped
+ *  comments    : the mean energy of the 16 bit samples is compared to the
+ *                vad-threshold level; other input formats are never gated
+ */
+static gboolean
+vad_gate (GstOmxBaseFilter * self, GstBuffer * buf)
+{
+  GstStructure *structure;
+  const gint16 *samples;
+  gint rate = 0, channels = 0, width = 0;
+  guint64 energy = 0;
+  guint n, i;
 
-      GST_LOG_OBJECT (self, "allocate buffer");
-      result = gst_pad_alloc_buffer_and_set_caps (self->srcpad,
-          GST_BUFFER_OFFSET_NONE,
-          omx_buffer->nAllocLen, GST_PAD_CAPS (self->srcpad), &buf);
+  if (!GST_PAD_CAPS (self->sinkpad))
+    return FALSE;
 
-      if (G_LIKELY (result == GST_FLOW_OK)) {
-        gst_buffer_ref (buf);
-        omx_buffer->pAppPrivate = buf;
+  structure = gst_caps_get_structure (GST_PAD_CAPS (self->sinkpad), 0);
+  if (!gst_structure_has_name (structure, "audio/x-raw-int") ||
+      !gst_structure_get_int (structure, "width", &width) || width != 16 ||
+      !gst_structure_get_int (structure, "rate", &rate) || rate <= 0 ||
+      !gst_structure_get_int (structure, "channels", &channels) ||
+      channels <= 0)
+    return FALSE;
 
-        omx_buffer->pBuffer = GST_BUFFER_DATA (buf);
-        omx_buffer->nAllocLen = GST_BUFFER_SIZE (buf);
-      } else {
-        GST_WARNING_OBJECT (self,
-            "could not pad allocate buffer, using malloc");
-        omx_buffer->pBuffer = g_malloc (omx_buffer->nAllocLen);
-      }
-    }
+  samples = (const gint16 *) GST_BUFFER_DATA (buf);
+  n = GST_BUFFER_SIZE (buf) / 2;
+  if (n == 0)
+    return FALSE;
 
-    if (self->out_port->shared_buffer && !omx_buffer->pBuffer) {
-      GST_ERROR_OBJECT (self, "no input buffer to share");
-    }
+  for (i = 0; i < n; i++)
+    energy += (guint32) (samples[i] * samples[i]);
 
-    if (G_UNLIKELY (omx_buffer->nFlags & OMX_BUFFERFLAG_EOS)) {
-      GST_DEBUG_OBJECT (self, "got eos");
-      gst_pad_push_event (self->srcpad, gst_event_new_eos ());
-      omx_buffer->nFlags &= ~OMX_BUFFERFLAG_EOS;
-      ret = GST_FLOW_UNEXPECTED;
+  if (energy / n >= self->vad_threshold_energy) {
+    if (self->vad_silence > self->vad_hangover * GST_MSECOND) {
+      GST_OBJECT_LOCK (self);
+      self->vad_resume_timestamp = GST_BUFFER_TIMESTAMP (buf);
+      GST_OBJECT_UNLOCK (self);
     }
-
-    omx_buffer->nFilledLen = 0;
-    GST_LOG_OBJECT (self, "release_buffer");
-    g_omx_port_release_buffer (out_port, omx_buffer);
+    self->vad_silence = 0;
+    return FALSE;
   }
 
-leave:
+  self->vad_silence += gst_util_uint64_scale_int (n / channels, GST_SECOND,
+      rate);
 
-  self->last_pad_push_return = ret;
+  return self->vad_silence > self->vad_hangover * GST_MSECOND;
+}
 
-  if (gomx->omx_error != OMX_ErrorNone)
-    ret = GST_FLOW_ERROR;
+/*
+ *  description : give up the component for inline_chain in the middle of a stream
+ *  params      : @self: base filter whose component failed to load
+ *  return      : none, use_inline is left FALSE when the caps were refused
+ *  comments    : the sink caps go through the subclass setcaps again, which
+ *                sets the src caps of inline coding like on a fresh start
+ */
+static void
+inline_fall_back (GstOmxBaseFilter * self)
+{
+  GstPadSetCapsFunction setcaps;
+  GstCaps *caps;
 
-  if (ret != GST_FLOW_OK) {
-    GST_INFO_OBJECT (self, "pause task, reason:  %s", gst_flow_get_name (ret));
-    gst_pad_pause_task (self->srcpad);
-  }
+  unload_renew_ports (self);
 
-  GST_LOG_OBJECT (self, "end");
+  self->use_inline = TRUE;
+  self->inline_fell_back = TRUE;
 
-  gst_object_unref (self);
+  caps = gst_pad_get_negotiated_caps (self->sinkpad);
+  setcaps = GST_PAD_SETCAPSFUNC (self->sinkpad);
+  if (caps && setcaps && !setcaps (self->sinkpad, caps)) {
+    GST_ELEMENT_ERROR (self, CORE, NEGOTIATION, (NULL),
+        ("inline coding refused %" GST_PTR_FORMAT, caps));
+    self->use_inline = FALSE;
+  }
+  if (caps)
+    gst_caps_unref (caps);
 }
 
 static GstFlowReturn
@@ -736,10 +2641,37 @@ pad_chain (GstPad * pad, GstBuffer * buf)
   GST_LOG_OBJECT (self, "IN_BUFFER: timestamp = %" GST_TIME_FORMAT " size = %lu, state:%d",
       GST_TIME_ARGS(GST_BUFFER_TIMESTAMP (buf)), GST_BUFFER_SIZE (buf), gomx->omx_state);
 
+  basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+
+  /* MODIFICATION: coded in the element, the component is not used */
+  if (self->use_inline)
+    return basefilter_class->inline_chain (self, buf);
+
+  /* MODIFICATION: input keeps the component loaded */
+  if (self->idle_thread)
+    g_atomic_int_set (&self->idle_since,
+        gst_util_get_timestamp () / GST_SECOND);
+
   /* STATE_TUNING */
   if (!self->use_state_tuning) {
-    if (G_UNLIKELY (gomx->omx_state == OMX_StateLoaded))
+    if (G_UNLIKELY (gomx->omx_state == OMX_StateLoaded)) {
+      if (self->suspended)
+        self->resume_start = gst_util_get_timestamp ();
+
       omx_change_state(self, GstOmx_LodedToIdle, NULL, NULL);
+
+      /* MODIFICATION: a component out of resources is given up if allowed */
+      if (!self->ready && self->inline_fallback &&
+          basefilter_class->inline_chain) {
+        GST_WARNING_OBJECT (self, "component not ready, coding inline");
+        inline_fall_back (self);
+        if (!self->use_inline) {
+          gst_buffer_unref (buf);
+          return GST_FLOW_NOT_NEGOTIATED;
+        }
+        return basefilter_class->inline_chain (self, buf);
+      }
+    }
   }
 
   in_port = self->in_port;
@@ -751,38 +2683,90 @@ pad_chain (GstPad * pad, GstBuffer * buf)
     GstClockTime src_timestamp = 0;
     GstClockTime src_duration = 0;
 
-    if (G_UNLIKELY (gomx->omx_state == OMX_StateIdle))
+    if (G_UNLIKELY (gomx->omx_state == OMX_StateIdle)) {
       omx_change_state(self, GstOmx_IdleToExcuting,in_port, buf);
 
+      if (self->suspended && gomx->omx_state == OMX_StateExecuting)
+        idle_resumed (self);
+    }
+
     if (G_UNLIKELY (gomx->omx_state != OMX_StateExecuting)) {
       GST_ERROR_OBJECT (self, "Whoa! very wrong");
     }
 
-    basefilter_class = GST_OMX_BASE_FILTER_GET_CLASS (self);
+    /* MODIFICATION: a resumed component decodes from a keyframe on */
+    if (G_UNLIKELY (self->need_keyframe)) {
+      if (GST_BUFFER_FLAG_IS_SET (buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        GST_DEBUG_OBJECT (self, "dropping delta unit until a keyframe");
+        gst_buffer_unref (buf);
+        goto leave;
+      }
+      self->need_keyframe = FALSE;
+    }
+
     /* process input gst buffer before OMX_EmptyThisBuffer */
     if (basefilter_class->process_input_buf)
     {
       basefilter_class->process_input_buf(self,&buf);
     }
 
-    if (self->adapter_size > 0) {
-      if (!self->adapter) {
-        self->adapter = gst_adapter_new();
+    note_input_duration (self, buf);
+
+    /* MODIFICATION: silence past the hangover is not encoded */
+    if (self->vad && vad_gate (self, buf)) {
+      GST_LOG_OBJECT (self, "holding back silence");
+      gst_buffer_unref (buf);
+      goto leave;
+    }
+
+    /* MODIFICATION: units of the other instances are copied to them */
+    if (self->instances) {
+      guint index = gstomx_instances_assign (self->instances);
+
+      if (index > 0) {
+        ret = gstomx_instances_send (self->instances, index, buf);
+        goto leave;
+      }
+    }
+
+    if (self->use_framing && basefilter_class->find_frame_start &&
+        !is_extended_color_format(self, self->in_port)) {
+      if (self->last_pad_push_return != GST_FLOW_OK)
+        goto out_flushing;
+
+      ret = frame_chain (self, buf);
+      if (ret == GST_FLOW_WRONG_STATE || gomx->omx_error) {
+        buf = NULL;
+        goto out_flushing;
       }
+      goto leave;
+    }
+
+    /* MODIFICATION: small buffers are accumulated contiguously in the ring
+     * and sent together once adapter_size or batch_duration would be exceeded */
+    if (uses_ring (self)) {
+      if (!self->ring.capacity)
+        self->ring.capacity = MAX (self->adapter_size,
+            self->in_port->buffer_size) * GSTOMX_RING_REGIONS;
 
-      if (GST_BUFFER_IS_DISCONT(buf))
+      /* a batch is sent as it is, the adapter drops partial input */
+      if (GST_BUFFER_IS_DISCONT(buf) && self->batch_duration == 0)
       {
-        gst_adapter_clear(self->adapter);
+        gstomx_ring_clear (&self->ring);
       }
 
-      src_size = gst_adapter_available(self->adapter);
-      if (src_size + GST_BUFFER_SIZE(buf) <= self->adapter_size) {
-        gst_adapter_push(self->adapter, buf);
+      src_size = gstomx_ring_available (&self->ring);
+      if (ring_accepts (self, buf)) {
+        gstomx_ring_push (&self->ring, buf);
         goto leave;
       }
-      src_data = (guint8*) gst_adapter_peek(self->adapter, src_size);
-      src_timestamp = gst_adapter_prev_timestamp(self->adapter, NULL);
-      src_duration = GST_BUFFER_TIMESTAMP (buf) - src_timestamp;
+      src_data = gstomx_ring_peek (&self->ring);
+      src_timestamp = self->ring.timestamp;
+      if (GST_CLOCK_TIME_IS_VALID (src_timestamp) &&
+          GST_BUFFER_TIMESTAMP_IS_VALID (buf))
+        src_duration = GST_BUFFER_TIMESTAMP (buf) - src_timestamp;
+      else
+        src_duration = self->ring.duration;
     } else {
       src_data = GST_BUFFER_DATA (buf);
       src_size = GST_BUFFER_SIZE (buf);
@@ -790,8 +2774,16 @@ pad_chain (GstPad * pad, GstBuffer * buf)
       src_duration = GST_BUFFER_DURATION (buf);
     }
 
+    if (!self->in_port->shared_buffer && !self->convert_input &&
+        !is_extended_color_format (self, self->in_port)) {
+      note_input_frame (self, src_size);
+      if (self->input_resize)
+        resize_input_port (self);
+    }
+
     while (G_LIKELY (buffer_offset < src_size)) {
       OMX_BUFFERHEADERTYPE *omx_buffer;
+      guint sent = buffer_offset;
 
       if (self->last_pad_push_return != GST_FLOW_OK ||
           !(gomx->omx_state == OMX_StateExecuting ||
@@ -807,55 +2799,31 @@ pad_chain (GstPad * pad, GstBuffer * buf)
       if (G_LIKELY (omx_buffer)) {
         log_buffer (self, omx_buffer, "pad_chain");
 
-        /* MODIFICATION: to handle input SN12 HW addr. (enc) */
-        if (is_extended_color_format(self, self->in_port)) {
-          if (!GST_BUFFER_MALLOCDATA(buf)) {
-              GST_WARNING_OBJECT (self, "null MALLOCDATA in hw color format. skip this.");
-              goto out_flushing;
-          }
-          /* Copy p[0], p[1] of SCMN_IMGB to pAddrY, pAddrC of MFC_ENC_ADDR_INFO */
-          memcpy (omx_buffer->pBuffer,
-              GST_BUFFER_MALLOCDATA(buf)
-              + (sizeof (int) * 4 + sizeof (void*)) * 4, sizeof (void*));
-          memcpy (omx_buffer->pBuffer + sizeof (void*),
-              GST_BUFFER_MALLOCDATA(buf)
-              + (sizeof (int) * 4 + sizeof (void*)) * 4 + sizeof (void*),
-              sizeof (void*));
-          omx_buffer->nAllocLen = sizeof (void*) * 2;
-          omx_buffer->nFilledLen = sizeof (void*) * 2;
-        } else if (omx_buffer->nOffset == 0 && self->in_port->shared_buffer) {
-          {
-            GstBuffer *old_buf;
-            old_buf = omx_buffer->pAppPrivate;
-
-            if (old_buf) {
-              if (self->adapter_size > 0) {
-                g_object_unref ((GstAdapter *)old_buf);
-              } else {
-                gst_buffer_unref ((GstBuffer *)old_buf);
-              }
-            } else if (omx_buffer->pBuffer) {
-              g_free (omx_buffer->pBuffer);
-              omx_buffer->pBuffer = NULL;
-            }
-          }
+        if (!is_extended_color_format (self, self->in_port) &&
+            self->in_port->shared_buffer) {
+          /* MODIFICATION: the header comes back from EmptyBufferDone with
+           * nothing behind pBuffer, it is always lent whole */
+          reclaim_shared_buffer (omx_buffer);
 
           omx_buffer->pBuffer = src_data;
+          omx_buffer->nOffset = 0;
           omx_buffer->nAllocLen = src_size;
           omx_buffer->nFilledLen = src_size;
-          omx_buffer->pAppPrivate = (self->adapter_size > 0) ? (OMX_PTR)self->adapter : (OMX_PTR)buf;
-        } else {
-          omx_buffer->nFilledLen = MIN (src_size - buffer_offset,
-              omx_buffer->nAllocLen - omx_buffer->nOffset);
-          memcpy (omx_buffer->pBuffer + omx_buffer->nOffset,
-              src_data + buffer_offset, omx_buffer->nFilledLen);
+          /* the ring region stays valid until the component returns it */
+          omx_buffer->pAppPrivate = uses_ring (self) ?
+              gstomx_ring_take (&self->ring) : buf;
+          buffer_offset = src_size;
+        } else if (!fill_input_buffer (self, in_port, omx_buffer, buf,
+                src_data, src_size, &buffer_offset)) {
+          g_omx_port_push_buffer (in_port, omx_buffer);
+          goto out_flushing;
         }
 
         if (self->use_timestamps) {
           GstClockTime timestamp_offset = 0;
 
-          if (buffer_offset && src_duration != GST_CLOCK_TIME_NONE) {
-            timestamp_offset = gst_util_uint64_scale_int (buffer_offset,
+          if (sent && src_duration != GST_CLOCK_TIME_NONE) {
+            timestamp_offset = gst_util_uint64_scale_int (sent,
                 src_duration, src_size);
           }
 
@@ -864,15 +2832,9 @@ pad_chain (GstPad * pad, GstBuffer * buf)
               timestamp_offset, OMX_TICKS_PER_SECOND, GST_SECOND);
         }
 
-        /* MODIFICATION: hw addr */
-        if (is_extended_color_format(self, self->in_port)) {
-          buffer_offset = GST_BUFFER_SIZE (buf);
-        } else {
-          buffer_offset += omx_buffer->nFilledLen;
-        }
-
         GST_LOG_OBJECT (self, "release_buffer");
                 /** @todo untaint buffer */
+        latency_probe_input (self, omx_buffer);
         g_omx_port_release_buffer (in_port, omx_buffer);
       } else {
         GST_WARNING_OBJECT (self, "null buffer");
@@ -885,13 +2847,10 @@ pad_chain (GstPad * pad, GstBuffer * buf)
     ret = GST_FLOW_UNEXPECTED;
   }
 
-  if (self->adapter_size > 0) {
-    if (!self->in_port->shared_buffer) {
-      gst_adapter_clear(self->adapter);
-    } else {
-      self->adapter = gst_adapter_new();
-    }
-    gst_adapter_push(self->adapter, buf);
+  if (uses_ring (self)) {
+    /* whatever was not lent has been copied */
+    gstomx_ring_clear (&self->ring);
+    gstomx_ring_push (&self->ring, buf);
   } else {
     if (!self->in_port->shared_buffer) {
       gst_buffer_unref (buf);
@@ -921,12 +2880,68 @@ out_flushing:
       ret = GST_FLOW_ERROR;
     }
 
-    gst_buffer_unref (buf);
+    if (buf)
+      gst_buffer_unref (buf);
 
     goto leave;
   }
 }
 
+/* MODIFICATION: send what the ring still holds the way pad_chain would, lent
+ * in shared mode and copied over as many buffers as needed otherwise */
+static gboolean
+ring_flush (GstOmxBaseFilter * self)
+{
+  GOmxPort *in_port = self->in_port;
+  guint size = gstomx_ring_available (&self->ring);
+  const guint8 *data = gstomx_ring_peek (&self->ring);
+  GstClockTime timestamp = self->ring.timestamp;
+  GstClockTime duration = self->ring.duration;
+  guint offset = 0;
+
+  while (offset < size) {
+    OMX_BUFFERHEADERTYPE *omx_buffer;
+    guint sent = offset;
+
+    omx_buffer = g_omx_port_request_buffer (in_port);
+    if (!omx_buffer)
+      return FALSE;
+
+    if (in_port->shared_buffer) {
+      reclaim_shared_buffer (omx_buffer);
+      omx_buffer->pBuffer = (guint8 *) data;
+      omx_buffer->nOffset = 0;
+      omx_buffer->nAllocLen = size;
+      omx_buffer->nFilledLen = size;
+      omx_buffer->pAppPrivate = gstomx_ring_take (&self->ring);
+      offset = size;
+    } else {
+      omx_buffer->nFilledLen = MIN (size - offset,
+          omx_buffer->nAllocLen - omx_buffer->nOffset);
+      memcpy (omx_buffer->pBuffer + omx_buffer->nOffset, data + offset,
+          omx_buffer->nFilledLen);
+      offset += omx_buffer->nFilledLen;
+    }
+
+    if (self->use_timestamps && GST_CLOCK_TIME_IS_VALID (timestamp)) {
+      GstClockTime timestamp_offset = 0;
+
+      if (sent && duration != GST_CLOCK_TIME_NONE)
+        timestamp_offset = gst_util_uint64_scale_int (sent, duration, size);
+
+      omx_buffer->nTimeStamp = gst_util_uint64_scale_int (timestamp +
+          timestamp_offset, OMX_TICKS_PER_SECOND, GST_SECOND);
+    }
+
+    latency_probe_input (self, omx_buffer);
+    g_omx_port_release_buffer (in_port, omx_buffer);
+  }
+
+  gstomx_ring_clear (&self->ring);
+
+  return TRUE;
+}
+
 static gboolean
 pad_event (GstPad * pad, GstEvent * event)
 {
@@ -948,6 +2963,10 @@ pad_event (GstPad * pad, GstEvent * event)
       return TRUE;
   }
 
+  /* MODIFICATION: inline coding holds nothing to drain or flush */
+  if (self->use_inline)
+    return gst_pad_push_event (self->srcpad, event);
+
   switch (GST_EVENT_TYPE (event)) {
     case GST_EVENT_EOS:
       /* if we are init'ed, and there is a running loop; then
@@ -959,32 +2978,22 @@ pad_event (GstPad * pad, GstEvent * event)
         {
           OMX_BUFFERHEADERTYPE *omx_buffer;
 
+          /* the last picture has no start code behind it */
+          frame_finish (self, TRUE);
+
+          /* the other instances are done before this one */
+          if (self->instances)
+            gstomx_instances_drain (self->instances);
+
+          /* the accumulated input goes first, the EOS buffer is empty */
+          if (gstomx_ring_available (&self->ring) > 0 && !ring_flush (self))
+            gstomx_ring_clear (&self->ring);
+
           GST_LOG_OBJECT (self, "request buffer");
           omx_buffer = g_omx_port_request_buffer (in_port);
 
           if (G_LIKELY (omx_buffer)) {
-
-            if ((self->adapter_size > 0) &&(self->adapter)) {
-              guint8 *src = NULL;
-              guint src_len = 0;
-
-              src_len = gst_adapter_available(self->adapter);
-              if (src_len > 0) {
-                src = (guint8*) gst_adapter_peek(self->adapter, src_len);
-                omx_buffer->nFilledLen = src_len;
-                memcpy (omx_buffer->pBuffer + omx_buffer->nOffset,
-                    src, omx_buffer->nFilledLen);
-                if (self->use_timestamps) {
-                  omx_buffer->nTimeStamp = gst_util_uint64_scale_int (
-                  gst_adapter_prev_timestamp(self->adapter, NULL),
-                  OMX_TICKS_PER_SECOND, GST_SECOND);
-                }
-                gst_adapter_clear(self->adapter);
-                g_object_unref(self->adapter);
-                self->adapter = NULL;
-              }
-            }
-
+            omx_buffer->nFilledLen = 0;
             omx_buffer->nFlags |= OMX_BUFFERFLAG_EOS;
 
             GST_LOG_OBJECT (self, "release_buffer");
@@ -1007,11 +3016,15 @@ pad_event (GstPad * pad, GstEvent * event)
         self->last_pad_push_return = GST_FLOW_WRONG_STATE;
 
         g_omx_core_flush_start (gomx);
-
+        if (self->instances)
+          gstomx_instances_flush_start (self->instances);
 
         gst_pad_pause_task (self->srcpad);
 
         ret = TRUE;
+      } else if (self->suspended) {
+        /* MODIFICATION: nothing in the unloaded component to flush */
+        ret = gst_pad_push_event (self->srcpad, event);
       } else {
         GST_WARNING_OBJECT (self, "flush start in wrong omx state");
         ret = FALSE;
@@ -1024,18 +3037,27 @@ pad_event (GstPad * pad, GstEvent * event)
         self->last_pad_push_return = GST_FLOW_OK;
 
         g_omx_core_flush_stop (gomx);
+        if (self->instances)
+          gstomx_instances_flush_stop (self->instances);
 
+        gstomx_ring_clear (&self->ring);
 
-        if ((self->adapter_size > 0) && (self->adapter)) {
-          gst_adapter_clear(self->adapter);
-          g_object_unref(self->adapter);
-          self->adapter = NULL;
-        }
+        GST_OBJECT_LOCK (self);
+        gst_segment_init (&self->segment, GST_FORMAT_UNDEFINED);
+        /* the timed buffer may have been flushed out */
+        self->probe_sent = GST_CLOCK_TIME_NONE;
+        GST_OBJECT_UNLOCK (self);
+        self->last_in_timestamp = GST_CLOCK_TIME_NONE;
+
+        frame_reset (self);
 
         if (self->ready)
           gst_pad_start_task (self->srcpad, output_loop, self->srcpad);
 
         ret = TRUE;
+      } else if (self->suspended) {
+        /* MODIFICATION: nothing in the unloaded component to flush */
+        ret = gst_pad_push_event (self->srcpad, event);
       } else {
         GST_WARNING_OBJECT (self, "flush start in wrong omx state");
         ret = FALSE;
@@ -1043,8 +3065,32 @@ pad_event (GstPad * pad, GstEvent * event)
       break;
 
     case GST_EVENT_NEWSEGMENT:
+    {
+      gboolean update;
+      gdouble rate, applied_rate;
+      GstFormat format;
+      gint64 start, stop, position;
+
+      gst_event_parse_new_segment_full (event, &update, &rate, &applied_rate,
+          &format, &start, &stop, &position);
+
+      GST_DEBUG_OBJECT (self, "new segment: start %" GST_TIME_FORMAT
+          " stop %" GST_TIME_FORMAT, GST_TIME_ARGS (start),
+          GST_TIME_ARGS (stop));
+
+      /* only time segments can be used to clip the output */
+      GST_OBJECT_LOCK (self);
+      if (format == GST_FORMAT_TIME) {
+        gst_segment_set_newsegment_full (&self->segment, update, rate,
+            applied_rate, format, start, stop, position);
+      } else {
+        gst_segment_init (&self->segment, GST_FORMAT_UNDEFINED);
+      }
+      GST_OBJECT_UNLOCK (self);
+
       ret = gst_pad_push_event (self->srcpad, event);
       break;
+    }
 
     default:
       ret = gst_pad_push_event (self->srcpad, event);
@@ -1106,6 +3152,16 @@ activate_push (GstPad * pad, gboolean active)
   return result;
 }
 
+/* MODIFICATION: buffers of the old caps are not reused */
+static void
+src_caps_notify (GObject * pad, GParamSpec * pspec, gpointer data)
+{
+  GstOmxBaseFilter *self = data;
+
+  gstomx_buffer_pool_drain (self->out_pool);
+  self->out_pool_shared = FALSE;
+}
+
 static void
 type_instance_init (GTypeInstance * instance, gpointer g_class)
 {
@@ -1121,13 +3177,58 @@ type_instance_init (GTypeInstance * instance, gpointer g_class)
   self->use_timestamps = TRUE;
   self->use_state_tuning = FALSE;
   self->adapter_size = 0;
+  gstomx_ring_init (&self->ring, 0);
+  self->batch_duration = 0;
+  self->frames_per_packet = 1;
+  self->codec_frame_bytes = 0;
+  self->codec_frame_duration = GST_CLOCK_TIME_NONE;
+  self->use_inline = FALSE;
+  self->inline_fallback = FALSE;
+  self->inline_fell_back = FALSE;
+  self->memfd = FALSE;
+  self->huge_pages = FALSE;
+  self->lock_buffers = FALSE;
+  self->share_input = FALSE;
+  self->share_output = FALSE;
+  self->n_instances = 1;
+  self->unit_frames = 0;
+  self->default_unit_frames = 1;
+  self->instances = NULL;
+  self->vad = FALSE;
+  self->vad_threshold = DEFAULT_VAD_THRESHOLD;
+  self->vad_threshold_energy = (guint64) (32768.0 * 32768.0 *
+      pow (10.0, DEFAULT_VAD_THRESHOLD / 10.0));
+  self->vad_hangover = DEFAULT_VAD_HANGOVER;
+  self->vad_silence = 0;
+  self->vad_resume_timestamp = GST_CLOCK_TIME_NONE;
+  self->in_frame_duration = GST_CLOCK_TIME_NONE;
+  self->last_in_timestamp = GST_CLOCK_TIME_NONE;
+  self->proc_latency = 0;
+  self->probe_sent = GST_CLOCK_TIME_NONE;
+  self->posted_latency = GST_CLOCK_TIME_NONE;
+
+  gst_segment_init (&self->segment, GST_FORMAT_UNDEFINED);
+
+  self->use_framing = FALSE;
+  self->frame_timestamp = GST_CLOCK_TIME_NONE;
+  self->frame_duration = GST_CLOCK_TIME_NONE;
 
   self->gomx = gstomx_core_new (self, G_TYPE_FROM_CLASS (g_class));
+  self->gomx->preempt_cb = preempt_cb;
   self->in_port = g_omx_core_new_port (self->gomx, 0);
   self->out_port = g_omx_core_new_port (self->gomx, 1);
 
   self->ready_lock = g_mutex_new ();
 
+  self->idle_timeout = 0;
+  self->idle_thread = NULL;
+  self->idle_lock = g_mutex_new ();
+  self->idle_cond = g_cond_new ();
+  self->suspended = FALSE;
+  self->need_keyframe = FALSE;
+  self->resume_start = GST_CLOCK_TIME_NONE;
+  self->resume_latency = 0;
+
   self->sinkpad =
       gst_pad_new_from_template (gst_element_class_get_pad_template
       (element_class, "sink"), "sink");
@@ -1140,9 +3241,14 @@ type_instance_init (GTypeInstance * instance, gpointer g_class)
       (element_class, "src"), "src");
 
   gst_pad_set_activatepush_function (self->srcpad, activate_push);
+  gst_pad_set_query_function (self->srcpad, src_query);
 
   gst_pad_use_fixed_caps (self->srcpad);
 
+  self->out_pool = gstomx_buffer_pool_new ();
+  g_signal_connect (self->srcpad, "notify::caps",
+      G_CALLBACK (src_caps_notify), self);
+
   gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
   gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
 
@@ -23,8 +23,10 @@
 #define GSTOMX_BASE_FILTER_H
 
 #include <gst/gst.h>
-#include <gst/base/gstadapter.h>
 #include "gstomx_util.h"
+#include "gstomx_buffer_pool.h"
+#include "gstomx_ring.h"
+#include "gstomx_instances.h"
 #include <async_queue.h>
 
 G_BEGIN_DECLS
@@ -45,6 +47,17 @@ typedef enum _EXT_OMX_COLOR_FORMATTYPE {
     OMX_EXT_COLOR_FormatNV12Tiled            = 0x7FC00002  /* 0x7FC00002 */
 }EXT_OMX_COLOR_FORMATTYPE;
 
+/* bytes find_frame_start may read from a candidate start position onwards */
+#define GSTOMX_FRAME_LOOKAHEAD 6
+
+/* MODIFICATION: nBufferSize for an encoded stream of bitrate bits per second
+ * in frames of duration, allowing factor times the average frame */
+static inline guint
+gstomx_encoded_buffer_size (guint bitrate, GstClockTime duration, guint factor)
+{
+  return gst_util_uint64_scale (bitrate, duration, 8 * GST_SECOND) * factor;
+}
+
 typedef enum GstOmxChangeState
 {
     GstOmx_ToLoaded,
@@ -75,8 +88,97 @@ struct GstOmxBaseFilter
   /* MODIFICATION: state-tuning */
   gboolean use_state_tuning;
 
-  GstAdapter *adapter;  /* adapter */
+  GstOmxRing ring;  /* accumulates input up to adapter_size */
   guint adapter_size;
+  /* MODIFICATION: or whole buffers up to this duration, 0 disables */
+  GstClockTime batch_duration;
+
+  /* current downstream segment, protected by the object lock */
+  GstSegment segment;
+
+  /* MODIFICATION: picture framing of unparsed elementary streams */
+  gboolean use_framing;
+  gboolean frame_has_picture;
+  OMX_BUFFERHEADERTYPE *frame_buffer; /* pending frame, copy mode */
+  GstBuffer *frame_buf;               /* pending frame, shared mode */
+  guint8 *frame_data;                 /* assembled pending frame, shared mode */
+  guint frame_size;
+  guint frame_scanned;                /* start positions already checked */
+  GstClockTime frame_timestamp;
+  GstClockTime frame_duration;
+  guint frame_sent;                   /* part of the pending picture already sent */
+
+  /* MODIFICATION: input buffer size adaptation, copy mode only */
+  guint max_input_frame_size;         /* 0 keeps the component default */
+  guint input_frame_peak;             /* largest input frame so far */
+  guint input_split_frames;           /* frames that did not fit a buffer */
+  guint input_resize;                 /* nBufferSize to switch to, 0 if none */
+  guint out_buffer_size_max;          /* output buffers grow up to this, 0 never */
+  gboolean out_resized;               /* grown since the size was last set */
+
+  /* MODIFICATION: input frames go through convert_input_buf, copy mode only */
+  gboolean convert_input;
+  /* output frames go through convert_output_buf into out_frame_size bytes */
+  gboolean convert_output;
+  guint out_frame_size;
+
+  /* MODIFICATION: recycled output buffers, drained on caps changes */
+  GstOmxBufferPool *out_pool;
+  gboolean out_pool_shared;           /* serves shared mode, downstream allocates plainly */
+  gboolean memfd;                     /* buffers are exported as memfd */
+  gboolean huge_pages;                /* port arenas on transparent huge pages */
+  gboolean lock_buffers;              /* port arenas locked in RAM */
+
+  /* MODIFICATION: the component goes back to Loaded after idle_timeout
+   * seconds without input and is brought back by the next buffer */
+  guint idle_timeout;                 /* 0 never suspends */
+  GThread *idle_thread;
+  GMutex *idle_lock;
+  GCond *idle_cond;
+  gboolean idle_stop;
+  volatile gint idle_since;           /* seconds, of the last input */
+  gboolean suspended;
+  gboolean need_keyframe;             /* delta units are dropped until one */
+  GstClockTime resume_start;
+  GstClockTime resume_latency;        /* of the last restore */
+
+  /* MODIFICATION: set by omx_transcode, so the decoder output memory is the
+   * encoder input memory; ignored for extended formats and omx_allocate */
+  gboolean share_input;
+  gboolean share_output;
+
+  /* MODIFICATION: more component instances coding units side by side */
+  guint n_instances;
+  guint unit_frames;                  /* 0 for default_unit_frames */
+  guint default_unit_frames;          /* one picture, or the subclass's own */
+  GstOmxInstances *instances;         /* NULL with one instance */
+
+  /* MODIFICATION: output split into buffers of frames_per_packet codec frames,
+   * found by output_frame_size or, if unset, codec_frame_bytes */
+  guint frames_per_packet;            /* 0 pushes output as produced */
+  guint codec_frame_bytes;            /* constant frame size, 0 if unknown */
+  GstClockTime codec_frame_duration;
+
+  /* MODIFICATION: input goes to inline_chain instead of the component */
+  gboolean use_inline;
+  gboolean inline_fallback;           /* switch to it when the component fails */
+  gboolean inline_fell_back;          /* use_inline was set by the fallback */
+
+  /* MODIFICATION: voice activity gating of raw input */
+  gboolean vad;
+  gint vad_threshold;                 /* dBov */
+  guint64 vad_threshold_energy;       /* mean squared sample at that level */
+  guint vad_hangover;                 /* ms */
+  GstClockTime vad_silence;           /* since the last voiced buffer */
+  GstClockTime vad_resume_timestamp;  /* first voice after gating, object lock */
+
+  /* MODIFICATION: latency reporting, object lock */
+  GstClockTime in_frame_duration;     /* of the latest input frame */
+  GstClockTime last_in_timestamp;
+  GstClockTime proc_latency;          /* smoothed component processing time */
+  OMX_TICKS probe_timestamp;          /* of the input being timed */
+  GstClockTime probe_sent;            /* when it was sent, NONE if none */
+  GstClockTime posted_latency;        /* minimum of the last latency message */
 };
 
 struct GstOmxBaseFilterClass
@@ -86,10 +188,31 @@ struct GstOmxBaseFilterClass
   void (*process_input_buf)(GstOmxBaseFilter *omx_base_filter, GstBuffer **buf);
   void (*process_output_buf)(GstOmxBaseFilter *omx_base_filter, GstBuffer **buf, OMX_BUFFERHEADERTYPE *omx_buffer);
   void (*process_output_caps)(GstOmxBaseFilter *omx_base_filter, OMX_BUFFERHEADERTYPE *omx_buffer);
+  /* return FALSE when omx_buffer lies outside the segment; may trim nOffset/nFilledLen; NULL never clips */
+  gboolean (*clip_output_buf)(GstOmxBaseFilter *omx_base_filter, OMX_BUFFERHEADERTYPE *omx_buffer, GstSegment *segment);
+  /* return the first position in [from, size - GSTOMX_FRAME_LOOKAHEAD] where a new picture starts, -1 if none */
+  gint (*find_frame_start)(GstOmxBaseFilter *omx_base_filter, const guint8 *data, guint size, guint from);
+  /* fill omx_buffer from one whole input frame, converting it on the way */
+  void (*convert_input_buf)(GstOmxBaseFilter *omx_base_filter, OMX_BUFFERHEADERTYPE *omx_buffer, const guint8 *data, guint size);
+  /* write the frame in omx_buffer to data; return FALSE to drop it */
+  gboolean (*convert_output_buf)(GstOmxBaseFilter *omx_base_filter, OMX_BUFFERHEADERTYPE *omx_buffer, guint8 *data);
+  /* return the size of the codec frame at data and set its duration, 0 if none */
+  guint (*output_frame_size)(GstOmxBaseFilter *omx_base_filter, const guint8 *data, guint size, GstClockTime *duration);
+  /* code buf in the element and push the result, consumes buf */
+  GstFlowReturn (*inline_chain)(GstOmxBaseFilter *omx_base_filter, GstBuffer *buf);
+  /* make the next frame sent to gomx start an independent work unit; NULL
+   * when frames depend on the ones before, which rules out more instances */
+  void (*unit_start)(GstOmxBaseFilter *omx_base_filter, GOmxCore *gomx, guint port_index);
 
 };
 
 GType gst_omx_base_filter_get_type (void);
+void gst_omx_base_filter_set_out_buffer_size (GstOmxBaseFilter * self,
+    guint size, guint max);
+guint gst_omx_base_filter_frames_per_output (GstOmxBaseFilter * self,
+    GstClockTime frame_duration, guint bytes_per_second);
+void gst_omx_base_filter_install_voice_properties (GObjectClass *
+    gobject_class);
 
 G_END_DECLS
 #endif /* GSTOMX_BASE_FILTER_H */
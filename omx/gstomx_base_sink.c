@@ -97,6 +97,8 @@ change_state (GstElement * element, GstStateChange transition)
 
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       g_omx_core_stop (self->gomx);
+      /* MODIFICATION: the next stream may have other frame durations */
+      self->last_timestamp = GST_CLOCK_TIME_NONE;
       break;
 
     case GST_STATE_CHANGE_READY_TO_NULL:
@@ -125,6 +127,49 @@ finalize (GObject * obj)
   G_OBJECT_CLASS (parent_class)->finalize (obj);
 }
 
+/*
+ *  description : keep the render delay at the frames the port queues
+ *  params      : @self: base sink, @buf: buffer about to be rendered
+ *  return      : none
+ *  comments    : a buffer handed to the component is presented after the ones
+ *                already queued, so the clock sync has to happen that early
+ */
+static void
+update_render_delay (GstOmxBaseSink * self, GstBuffer * buf)
+{
+  GstClockTime duration = GST_CLOCK_TIME_NONE;
+  GstClockTime delay;
+
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    duration = GST_BUFFER_DURATION (buf);
+  else if (GST_BUFFER_TIMESTAMP_IS_VALID (buf) &&
+      GST_CLOCK_TIME_IS_VALID (self->last_timestamp) &&
+      GST_BUFFER_TIMESTAMP (buf) > self->last_timestamp)
+    duration = GST_BUFFER_TIMESTAMP (buf) - self->last_timestamp;
+
+  self->last_timestamp = GST_BUFFER_TIMESTAMP (buf);
+
+  if (!GST_CLOCK_TIME_IS_VALID (duration) || self->in_port->num_buffers == 0)
+    return;
+
+  delay = duration * (self->in_port->num_buffers - 1);
+
+  /* jitter in the frame durations does not renegotiate the latency, only a
+   * change by more than a quarter does */
+  if (delay <= self->render_delay + self->render_delay / 4 &&
+      delay + self->render_delay / 4 >= self->render_delay &&
+      self->render_delay > 0)
+    return;
+
+  GST_INFO_OBJECT (self, "render delay %" GST_TIME_FORMAT,
+      GST_TIME_ARGS (delay));
+
+  self->render_delay = delay;
+  gst_base_sink_set_render_delay (GST_BASE_SINK (self), delay);
+  gst_element_post_message (GST_ELEMENT (self),
+      gst_message_new_latency (GST_OBJECT (self)));
+}
+
 static GstFlowReturn
 render (GstBaseSink * gst_base, GstBuffer * buf)
 {
@@ -144,6 +189,8 @@ render (GstBaseSink * gst_base, GstBuffer * buf)
 
   in_port = self->in_port;
 
+  update_render_delay (self, buf);
+
   if (G_LIKELY (in_port->enabled)) {
     guint buffer_offset = 0;
 
@@ -159,7 +206,9 @@ render (GstBaseSink * gst_base, GstBuffer * buf)
             omx_buffer->nAllocLen, omx_buffer->nFilledLen, omx_buffer->nFlags,
             omx_buffer->nOffset, omx_buffer->nTimeStamp);
 
-        if (omx_buffer->nOffset == 0 && self->in_port->shared_buffer) {
+        if (self->in_port->shared_buffer) {
+          /* MODIFICATION: the header may come back from EmptyBufferDone
+           * with nothing behind pBuffer, so it is always lent whole */
           {
             GstBuffer *old_buf;
             old_buf = omx_buffer->pAppPrivate;
@@ -168,17 +217,32 @@ render (GstBaseSink * gst_base, GstBuffer * buf)
               gst_buffer_unref (old_buf);
             } else if (omx_buffer->pBuffer) {
               g_free (omx_buffer->pBuffer);
-              omx_buffer->pBuffer = NULL;
             }
+            omx_buffer->pBuffer = NULL;
           }
 
           /* We are going to use this. */
           gst_buffer_ref (buf);
 
           omx_buffer->pBuffer = GST_BUFFER_DATA (buf);
+          omx_buffer->nOffset = 0;
           omx_buffer->nAllocLen = GST_BUFFER_SIZE (buf);
           omx_buffer->nFilledLen = GST_BUFFER_SIZE (buf);
           omx_buffer->pAppPrivate = buf;
+        } else if (self->repack_input) {
+          /* MODIFICATION: whole frames go in one buffer, row by row */
+          if (GST_BUFFER_SIZE (buf) < self->caps_layout.size ||
+              omx_buffer->nAllocLen - omx_buffer->nOffset <
+              self->port_layout.size) {
+            GST_WARNING_OBJECT (self, "cannot repack %u bytes into %lu bytes",
+                GST_BUFFER_SIZE (buf), omx_buffer->nAllocLen - omx_buffer->nOffset);
+            omx_buffer->nFilledLen = 0;
+          } else {
+            gstomx_frame_copy (omx_buffer->pBuffer + omx_buffer->nOffset,
+                &self->port_layout, GST_BUFFER_DATA (buf), &self->caps_layout);
+            omx_buffer->nFilledLen = self->port_layout.size;
+          }
+          buffer_offset = GST_BUFFER_SIZE (buf);
         } else {
           omx_buffer->nFilledLen = MIN (GST_BUFFER_SIZE (buf) - buffer_offset,
               omx_buffer->nAllocLen - omx_buffer->nOffset);
@@ -239,6 +303,8 @@ handle_event (GstBaseSink * gst_base, GstEvent * event)
       g_sem_down (gomx->flush_sem);
 
       g_omx_port_resume (in_port);
+      /* MODIFICATION: no frame duration across a seek */
+      self->last_timestamp = GST_CLOCK_TIME_NONE;
       break;
 
     default:
@@ -446,6 +512,9 @@ type_instance_init (GTypeInstance * instance, gpointer g_class)
   self->gomx = gstomx_core_new (self, G_TYPE_FROM_CLASS (g_class));
   self->in_port = g_omx_core_new_port (self->gomx, 0);
 
+  self->last_timestamp = GST_CLOCK_TIME_NONE;
+  self->render_delay = 0;
+
   {
     GstPad *sinkpad;
     self->sinkpad = sinkpad = GST_BASE_SINK_PAD (self);
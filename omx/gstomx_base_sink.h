@@ -34,6 +34,7 @@ typedef struct GstOmxBaseSinkClass GstOmxBaseSinkClass;
 typedef void (*GstOmxBaseSinkCb) (GstOmxBaseSink * self);
 
 #include <gstomx_util.h>
+#include "gstomx_colorspace.h"
 
 struct GstOmxBaseSink
 {
@@ -47,6 +48,15 @@ struct GstOmxBaseSink
   gboolean ready;
   GstPadActivateModeFunction base_activatepush;
   gboolean initialized;
+
+  /* MODIFICATION: raw video written in the port layout while copying */
+  gboolean repack_input;
+  GstOmxFrameLayout caps_layout;
+  GstOmxFrameLayout port_layout;
+
+  /* MODIFICATION: frames queued in the component delay the rendering */
+  GstClockTime last_timestamp;
+  GstClockTime render_delay;
 };
 
 struct GstOmxBaseSinkClass
@@ -36,6 +36,64 @@ process_input_buf (GstOmxBaseFilter * omx_base_filter, GstBuffer **buf)
 {
 }
 
+/* A decoded frame is kept if any part of its duration overlaps the segment. */
+static gboolean
+clip_output_buf (GstOmxBaseFilter * omx_base, OMX_BUFFERHEADERTYPE * omx_buffer,
+    GstSegment * segment)
+{
+  GstOmxBaseVideoDec *self;
+  gint64 start, stop = GST_CLOCK_TIME_NONE;
+
+  self = GST_OMX_BASE_VIDEODEC (omx_base);
+
+  start = gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
+      OMX_TICKS_PER_SECOND);
+  if (self->framerate_num > 0 && self->framerate_denom > 0)
+    stop = start + gst_util_uint64_scale_int (GST_SECOND,
+        self->framerate_denom, self->framerate_num);
+
+  return gst_segment_clip (segment, GST_FORMAT_TIME, start, stop, NULL, NULL);
+}
+
+/* modification: copy the visible rectangle of a padded frame */
+static gboolean
+convert_output_buf (GstOmxBaseFilter * omx_base,
+    OMX_BUFFERHEADERTYPE * omx_buffer, guint8 * data)
+{
+  GstOmxBaseVideoDec *self;
+
+  self = GST_OMX_BASE_VIDEODEC (omx_base);
+
+  if (omx_buffer->nFilledLen < gstomx_frame_layout_end (&self->crop_layout)) {
+    GST_WARNING_OBJECT (self, "frame of %lu bytes is shorter than %" G_GSIZE_FORMAT,
+        omx_buffer->nFilledLen, gstomx_frame_layout_end (&self->crop_layout));
+    return FALSE;
+  }
+
+  return gstomx_frame_copy (data, &self->caps_layout,
+      omx_buffer->pBuffer + omx_buffer->nOffset, &self->crop_layout);
+}
+
+/* modification: downstream listing a "stride" field reads padded frames */
+static gboolean
+downstream_handles_strides (GstOmxBaseFilter * omx_base)
+{
+  GstCaps *peer;
+  gboolean ret = FALSE;
+  guint i;
+
+  peer = gst_pad_peer_get_caps (omx_base->srcpad);
+  if (!peer)
+    return FALSE;
+
+  for (i = 0; i < gst_caps_get_size (peer) && !ret; i++)
+    ret = gst_structure_has_field (gst_caps_get_structure (peer, i), "stride");
+
+  gst_caps_unref (peer);
+
+  return ret;
+}
+
 static void
 type_base_init (gpointer g_class)
 {
@@ -100,6 +158,8 @@ type_class_init (gpointer g_class, gpointer class_data)
         FALSE, G_PARAM_READWRITE));
   }
   basefilter_class->process_input_buf = process_input_buf;
+  basefilter_class->clip_output_buf = clip_output_buf;
+  basefilter_class->convert_output_buf = convert_output_buf;
 }
 
 static void
@@ -110,6 +170,8 @@ settings_changed_cb (GOmxCore * core)
   guint width;
   guint height;
   guint32 format = 0;
+  guint stride, slice;
+  gboolean raw = FALSE, padded = FALSE;
 
   omx_base = core->object;
   self = GST_OMX_BASE_VIDEODEC (omx_base);
@@ -127,6 +189,8 @@ settings_changed_cb (GOmxCore * core)
 
     width = param.format.video.nFrameWidth;
     height = param.format.video.nFrameHeight;
+    stride = MAX (param.format.video.nStride, 0);
+    slice = param.format.video.nSliceHeight;
     switch ((guint)param.format.video.eColorFormat) {
       case OMX_COLOR_FormatYUV420Planar:
       case OMX_COLOR_FormatYUV420PackedPlanar:
@@ -146,11 +210,50 @@ settings_changed_cb (GOmxCore * core)
         format = GST_MAKE_FOURCC ('S', 'N', '1', '2');
         break;
       case OMX_COLOR_FormatYUV420SemiPlanar:
+      case OMX_EXT_COLOR_FormatNV12Tiled:    /* detiled in output_loop */
         format = GST_MAKE_FOURCC ('N', 'V', '1', '2');
         break;
       default:
         break;
     }
+
+    /* MODIFICATION: padded and cropped frames, extended formats carry their own */
+    if (param.format.video.eColorFormat < OMX_COLOR_FormatVendorStartUnused &&
+        gstomx_frame_layout_port (&self->crop_layout, format, width, height,
+            stride, slice)) {
+      OMX_CONFIG_RECTTYPE crop;
+
+      G_OMX_INIT_PARAM (crop);
+      crop.nPortIndex = omx_base->out_port->port_index;
+      if (OMX_GetConfig (omx_base->gomx->omx_handle,
+              OMX_IndexConfigCommonOutputCrop, &crop) == OMX_ErrorNone &&
+          crop.nWidth > 0 && crop.nHeight > 0 &&
+          crop.nLeft + crop.nWidth <= width && crop.nTop + crop.nHeight <= height) {
+        GST_INFO_OBJECT (omx_base, "crop %lux%lu at %ld,%ld", crop.nWidth,
+            crop.nHeight, crop.nLeft, crop.nTop);
+        gstomx_frame_layout_crop (&self->crop_layout, crop.nLeft, crop.nTop,
+            crop.nWidth, crop.nHeight);
+        width = crop.nWidth;
+        height = crop.nHeight;
+      }
+
+      gstomx_frame_layout_caps (&self->caps_layout, format, width, height);
+      raw = TRUE;
+      padded = !gstomx_frame_layout_equal (&self->crop_layout, &self->caps_layout);
+    }
+  }
+
+  /* MODIFICATION: downstream reading strides takes padded frames as they are;
+   * an offset into the frame cannot be expressed, so that needs the copy */
+  omx_base->convert_output = FALSE;
+  if (padded) {
+    if (self->crop_layout.offset[0] != 0 || !downstream_handles_strides (omx_base)) {
+      omx_base->convert_output = TRUE;
+      omx_base->out_frame_size = self->caps_layout.size;
+      padded = FALSE;
+    }
+    GST_INFO_OBJECT (omx_base, "padded frames, %s",
+        omx_base->convert_output ? "copying visible part" : "passed as they are");
   }
 
   {
@@ -169,6 +272,14 @@ settings_changed_cb (GOmxCore * core)
       /* FIXME this is a workaround for xvimagesink */
       gst_structure_set (struc, "framerate", GST_TYPE_FRACTION, 0, 1, NULL);
 
+    if (padded)
+      gst_structure_set (struc,
+          "stride", G_TYPE_INT, self->crop_layout.stride[0],
+          "slice-height", G_TYPE_INT,
+          self->crop_layout.n_planes > 1 ?
+          (gint) (self->crop_layout.offset[1] / self->crop_layout.stride[0]) :
+          (gint) height, NULL);
+
     gst_caps_append_structure (new_caps, struc);
 
     GST_INFO_OBJECT (omx_base, "caps are: %" GST_PTR_FORMAT, new_caps);
@@ -208,6 +319,9 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     if (framerate) {
       self->framerate_num = gst_value_get_fraction_numerator (framerate);
       self->framerate_denom = gst_value_get_fraction_denominator (framerate);
+      if (self->framerate_num > 0 && self->framerate_denom > 0)
+        omx_base->frame_duration = gst_util_uint64_scale_int (GST_SECOND,
+            self->framerate_denom, self->framerate_num);
     }
   }
 
@@ -225,6 +339,17 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     }
   }
 
+  /* modification: only a parser or a container guarantees one picture per buffer */
+  {
+    gboolean parsed = FALSE;
+    gboolean framed = FALSE;
+
+    gst_structure_get_boolean (structure, "parsed", &parsed);
+    gst_structure_get_boolean (structure, "framed", &framed);
+    omx_base->use_framing = !parsed && !framed &&
+        !gst_structure_has_field (structure, "codec_data");
+  }
+
   /* Input port configuration. */
   {
     param.nPortIndex = omx_base->in_port->port_index;
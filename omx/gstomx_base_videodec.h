@@ -23,6 +23,8 @@
 #define GSTOMX_BASE_VIDEODEC_H
 
 #include <gst/gst.h>
+#include <string.h>
+#include "gstomx_colorspace.h"
 
 G_BEGIN_DECLS
 #define GST_OMX_BASE_VIDEODEC(obj) (GstOmxBaseVideoDec *) (obj)
@@ -40,6 +42,10 @@ struct GstOmxBaseVideoDec
   OMX_VIDEO_CODINGTYPE compression_format;
   gint framerate_num;
   gint framerate_denom;
+
+  /* MODIFICATION: visible part of padded output frames */
+  GstOmxFrameLayout crop_layout;      /* inside the component's frame */
+  GstOmxFrameLayout caps_layout;      /* as downstream reads it */
 };
 
 struct GstOmxBaseVideoDecClass
@@ -49,5 +55,34 @@ struct GstOmxBaseVideoDecClass
 
 GType gst_omx_base_videodec_get_type (void);
 
+/* return the first position in [pos, limit) where two zero bytes begin,
+ * limit if none; data[limit] must be readable. Start codes of
+ * MPEG-4 part 2 and H.263 all begin with 00 00, so words without a zero
+ * byte are skipped four bytes at a time. */
+static inline guint
+gstomx_video_find_zero_pair (const guint8 * data, guint limit, guint pos)
+{
+  while (pos < limit) {
+    guint32 word;
+
+    if (pos + 3 <= limit) {
+      memcpy (&word, data + pos, 4);
+      if (!((word - 0x01010101) & ~word & 0x80808080)) {
+        pos += 4;
+        continue;
+      }
+    }
+
+    if (data[pos + 1])
+      pos += 2;
+    else if (data[pos])
+      pos++;
+    else
+      return pos;
+  }
+
+  return limit;
+}
+
 G_END_DECLS
 #endif /* GSTOMX_BASE_VIDEODEC_H */
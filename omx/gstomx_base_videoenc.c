@@ -29,10 +29,18 @@ enum
   ARG_0,
   ARG_BITRATE,
   ARG_FORCE_KEY_FRAME,
+  ARG_CONVERT_TIME,
 };
 
 #define DEFAULT_BITRATE 0
 
+/* modification: an intra frame may take this many times the average frame */
+#define OUTPUT_BUFFER_PEAK_FACTOR 8
+#define OUTPUT_BUFFER_MIN_SIZE (32 * 1024)
+
+/* modification: bound on the entries of OMX_IndexParamVideoPortFormat read */
+#define MAX_PORT_FORMATS 32
+
 GSTOMX_BOILERPLATE (GstOmxBaseVideoEnc, gst_omx_base_videoenc, GstOmxBaseFilter,
     GST_OMX_BASE_FILTER_TYPE);
 
@@ -54,13 +62,26 @@ process_output_buf(GstOmxBaseFilter * omx_base, GstBuffer **buf, OMX_BUFFERHEADE
   }
 }
 
+static void
+request_intra_frame (GOmxCore * gomx, guint port_index)
+{
+  OMX_CONFIG_INTRAREFRESHVOPTYPE config;
+
+  G_OMX_INIT_PARAM (config);
+  config.nPortIndex = port_index;
+
+  OMX_GetConfig (gomx->omx_handle, OMX_IndexConfigVideoIntraVOPRefresh, &config);
+  config.IntraRefreshVOP = OMX_TRUE;
+
+  OMX_SetConfig (gomx->omx_handle, OMX_IndexConfigVideoIntraVOPRefresh, &config);
+}
+
 /* modification: user force I frame */
 static void
 add_force_key_frame(GstOmxBaseVideoEnc *enc)
 {
   GstOmxBaseFilter *omx_base;
   GOmxCore *gomx;
-  OMX_CONFIG_INTRAREFRESHVOPTYPE config;
   omx_base = GST_OMX_BASE_FILTER (enc);
   gomx = (GOmxCore *) omx_base->gomx;
 
@@ -71,13 +92,74 @@ add_force_key_frame(GstOmxBaseVideoEnc *enc)
     return;
   }
 
-  G_OMX_INIT_PARAM (config);
-  config.nPortIndex = omx_base->out_port->port_index;
+  request_intra_frame (gomx, omx_base->out_port->port_index);
+}
 
-  OMX_GetConfig (gomx->omx_handle, OMX_IndexConfigVideoIntraVOPRefresh, &config);
-  config.IntraRefreshVOP = OMX_TRUE;
+/* modification: a unit of another instance opens a closed GOP */
+static void
+unit_start (GstOmxBaseFilter * omx_base, GOmxCore * gomx, guint port_index)
+{
+  if (!gomx->omx_handle)
+    return;
 
-  OMX_SetConfig (gomx->omx_handle, OMX_IndexConfigVideoIntraVOPRefresh, &config);
+  request_intra_frame (gomx, port_index);
+}
+
+/* modification: TRUE when the input port lists color_format, or lists nothing */
+static gboolean
+port_supports_color_format (GstOmxBaseFilter * omx_base,
+    OMX_COLOR_FORMATTYPE color_format)
+{
+  OMX_VIDEO_PARAM_PORTFORMATTYPE param;
+  guint i;
+
+  G_OMX_INIT_PARAM (param);
+  param.nPortIndex = omx_base->in_port->port_index;
+
+  for (i = 0; i < MAX_PORT_FORMATS; i++) {
+    param.nIndex = i;
+    if (OMX_GetParameter (omx_base->gomx->omx_handle,
+            OMX_IndexParamVideoPortFormat, &param) != OMX_ErrorNone)
+      break;
+    if (param.eColorFormat == color_format)
+      return TRUE;
+  }
+
+  return i == 0;
+}
+
+/* modification: write one upstream frame in the port layout straight into the omx buffer */
+static void
+convert_input_buf (GstOmxBaseFilter * omx_base,
+    OMX_BUFFERHEADERTYPE * omx_buffer, const guint8 * data, guint size)
+{
+  GstOmxBaseVideoEnc *self;
+  GstClockTime start;
+
+  self = GST_OMX_BASE_VIDEOENC (omx_base);
+
+  if (size < self->caps_layout.size ||
+      omx_buffer->nAllocLen - omx_buffer->nOffset < self->port_layout.size) {
+    GST_WARNING_OBJECT (self, "cannot convert %u bytes into %lu bytes, skip this",
+        size, omx_buffer->nAllocLen - omx_buffer->nOffset);
+    omx_buffer->nFilledLen = 0;
+    return;
+  }
+
+  start = gst_util_get_timestamp ();
+  if (!gstomx_frame_copy (omx_buffer->pBuffer + omx_buffer->nOffset,
+          &self->port_layout, data, &self->caps_layout)) {
+    GST_WARNING_OBJECT (self, "cannot convert %" GST_FOURCC_FORMAT " into %"
+        GST_FOURCC_FORMAT ", skip this",
+        GST_FOURCC_ARGS (self->caps_layout.fourcc),
+        GST_FOURCC_ARGS (self->port_layout.fourcc));
+    omx_buffer->nFilledLen = 0;
+    return;
+  }
+  self->convert_time += gst_util_get_timestamp () - start;
+  self->convert_frames++;
+
+  omx_buffer->nFilledLen = self->port_layout.size;
 }
 
 /* modification: get codec_data from omx component and set it caps */
@@ -151,6 +233,10 @@ get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
             /** @todo propagate this to OpenMAX when processing. */
       g_value_set_uint (value, self->bitrate);
       break;
+    case ARG_CONVERT_TIME:
+      g_value_set_uint64 (value, self->convert_frames ?
+          self->convert_time / self->convert_frames : 0);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
       break;
@@ -184,9 +270,16 @@ type_class_init (gpointer g_class, gpointer class_data)
             "force the encoder to produce I frame",
             FALSE,
             G_PARAM_WRITABLE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, ARG_CONVERT_TIME,
+        g_param_spec_uint64 ("convert-time", "Conversion time",
+            "Average nanoseconds spent converting or repacking an input frame",
+            0, G_MAXUINT64, 0, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
   }
   basefilter_class->process_output_buf = process_output_buf;
   basefilter_class->process_output_caps = process_output_caps;
+  basefilter_class->convert_input_buf = convert_input_buf;
+  basefilter_class->unit_start = unit_start;
 }
 
 static gboolean
@@ -200,6 +293,9 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
   gint width = 0;
   gint height = 0;
   const GValue *framerate = NULL;
+  guint32 fourcc = 0;
+  guint32 port_fourcc;
+  gboolean raw;
 
   self = GST_OMX_BASE_VIDEOENC (GST_PAD_PARENT (pad));
   omx_base = GST_OMX_BASE_FILTER (self);
@@ -215,8 +311,6 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
   gst_structure_get_int (structure, "height", &height);
 
   if (strcmp (gst_structure_get_name (structure), "video/x-raw-yuv") == 0) {
-    guint32 fourcc;
-
     framerate = gst_structure_get_value (structure, "framerate");
     if (framerate) {
       self->framerate_num = gst_value_get_fraction_numerator (framerate);
@@ -235,6 +329,9 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
         case GST_MAKE_FOURCC ('U', 'Y', 'V', 'Y'):
           color_format = OMX_COLOR_FormatCbYCrY;
           break;
+        case GST_MAKE_FOURCC ('N', 'V', '1', '2'):
+          color_format = OMX_COLOR_FormatYUV420SemiPlanar;
+          break;
         /* MODIFICATION: Add extended_color_format */
         case GST_MAKE_FOURCC ('S', 'T', '1', '2'):
           color_format = OMX_EXT_COLOR_FormatNV12TPhysicalAddress;
@@ -246,6 +343,15 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     }
   }
 
+  /* modification: convert in the input copy when the component lacks the format */
+  port_fourcc = fourcc;
+  raw = gstomx_frame_layout_caps (&self->caps_layout, fourcc, width, height);
+  if (raw && !port_supports_color_format (omx_base, color_format) &&
+      port_supports_color_format (omx_base, OMX_COLOR_FormatYUV420SemiPlanar)) {
+    port_fourcc = GST_MAKE_FOURCC ('N', 'V', '1', '2');
+    color_format = OMX_COLOR_FormatYUV420SemiPlanar;
+  }
+
   {
     OMX_PARAM_PORTDEFINITIONTYPE param;
 
@@ -267,21 +373,96 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
       }
 
       OMX_SetParameter (gomx->omx_handle, OMX_IndexParamPortDefinition, &param);
+
+      /* modification: the component may want padded strides and slices */
+      OMX_GetParameter (gomx->omx_handle, OMX_IndexParamPortDefinition, &param);
+      if (raw)
+        gstomx_frame_layout_port (&self->port_layout, port_fourcc, width, height,
+            MAX (param.format.video.nStride, 0), param.format.video.nSliceHeight);
     }
+  }
 
-    /* modification: set nBufferSize */
-    G_OMX_INIT_PARAM (param);
+  omx_base->convert_input = raw &&
+      !gstomx_frame_layout_equal (&self->caps_layout, &self->port_layout);
+  if (omx_base->convert_input) {
+    GST_INFO_OBJECT (self, "copying %" GST_FOURCC_FORMAT " frames as %"
+        GST_FOURCC_FORMAT ", stride %u, %" G_GSIZE_FORMAT " bytes",
+        GST_FOURCC_ARGS (fourcc), GST_FOURCC_ARGS (port_fourcc),
+        self->port_layout.stride[0], self->port_layout.size);
+  }
 
-    param.nPortIndex = omx_base->out_port->port_index;
-    OMX_GetParameter (gomx->omx_handle, OMX_IndexParamPortDefinition, &param);
+  /* modification: set nBufferSize from the bitrate, a raw frame at most */
+  {
+    guint size = 0;
+
+    if (self->bitrate > 0 && self->framerate_num > 0 &&
+        self->framerate_denom > 0) {
+      size = gstomx_encoded_buffer_size (self->bitrate,
+          gst_util_uint64_scale_int (GST_SECOND, self->framerate_denom,
+              self->framerate_num), OUTPUT_BUFFER_PEAK_FACTOR);
+      size = MAX (size, OUTPUT_BUFFER_MIN_SIZE);
+    }
 
-    param.nBufferSize = width * height * 3 / 2;
-    OMX_SetParameter (gomx->omx_handle, OMX_IndexParamPortDefinition, &param);
+    gst_omx_base_filter_set_out_buffer_size (omx_base, size,
+        width * height * 3 / 2);
   }
 
   return gst_pad_set_caps (pad, caps);
 }
 
+/* modification: frames from one I frame to the next, as the component is set */
+static guint
+iframe_interval (GstOmxBaseVideoEnc * self, GOmxCore * gomx, guint port_index)
+{
+  OMX_U32 p_frames, b_frames;
+
+  switch (self->compression_format) {
+    case OMX_VIDEO_CodingAVC:
+    {
+      OMX_VIDEO_PARAM_AVCTYPE param;
+
+      G_OMX_INIT_PARAM (param);
+      param.nPortIndex = port_index;
+      if (OMX_GetParameter (gomx->omx_handle, OMX_IndexParamVideoAvc,
+              &param) != OMX_ErrorNone)
+        return 1;
+      p_frames = param.nPFrames;
+      b_frames = param.nBFrames;
+      break;
+    }
+    case OMX_VIDEO_CodingMPEG4:
+    {
+      OMX_VIDEO_PARAM_MPEG4TYPE param;
+
+      G_OMX_INIT_PARAM (param);
+      param.nPortIndex = port_index;
+      if (OMX_GetParameter (gomx->omx_handle, OMX_IndexParamVideoMpeg4,
+              &param) != OMX_ErrorNone)
+        return 1;
+      p_frames = param.nPFrames;
+      b_frames = param.nBFrames;
+      break;
+    }
+    case OMX_VIDEO_CodingH263:
+    {
+      OMX_VIDEO_PARAM_H263TYPE param;
+
+      G_OMX_INIT_PARAM (param);
+      param.nPortIndex = port_index;
+      if (OMX_GetParameter (gomx->omx_handle, OMX_IndexParamVideoH263,
+              &param) != OMX_ErrorNone)
+        return 1;
+      p_frames = param.nPFrames;
+      b_frames = param.nBFrames;
+      break;
+    }
+    default:
+      return 1;
+  }
+
+  return p_frames + b_frames + 1;
+}
+
 static void
 omx_setup (GstOmxBaseFilter * omx_base)
 {
@@ -327,6 +508,12 @@ omx_setup (GstOmxBaseFilter * omx_base)
     OMX_SetParameter (gomx->omx_handle, OMX_IndexParamVideoBitrate, &param);
   }
 
+  /* modification: a work unit of the other instances is one GOP */
+  omx_base->default_unit_frames =
+      iframe_interval (self, gomx, omx_base->out_port->port_index);
+  GST_INFO_OBJECT (omx_base, "I-frame interval: %u",
+      omx_base->default_unit_frames);
+
   GST_INFO_OBJECT (omx_base, "end");
 }
 
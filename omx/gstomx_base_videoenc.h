@@ -23,6 +23,7 @@
 #define GSTOMX_BASE_VIDEOENC_H
 
 #include <gst/gst.h>
+#include "gstomx_colorspace.h"
 
 G_BEGIN_DECLS
 #define GST_OMX_BASE_VIDEOENC(obj) (GstOmxBaseVideoEnc *) (obj)
@@ -42,6 +43,12 @@ struct GstOmxBaseVideoEnc
   gint framerate_num;
   gint framerate_denom;
   gboolean use_force_key_frame;
+
+  /* MODIFICATION: input converted or repacked while copying */
+  GstOmxFrameLayout caps_layout;      /* frames as upstream writes them */
+  GstOmxFrameLayout port_layout;      /* frames as the component reads them */
+  GstClockTime convert_time;          /* spent converting, for convert-time */
+  guint convert_frames;
 };
 
 struct GstOmxBaseVideoEncClass
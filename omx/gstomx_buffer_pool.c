@@ -0,0 +1,329 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gstomx_buffer_pool.h"
+#include "gstomx_memfd.h"
+
+/*
+ * Buffers come from a GstBuffer subclass whose finalize puts them back on
+ * the free list by taking a new reference, the way the X video sinks keep
+ * their images. The pool outlives the element until its last buffer is
+ * back.
+ *
+ * With memfd set the data of new buffers is a memfd of their own, which
+ * another process maps from the fd; buffers imported from such an fd are of
+ * the same type without a pool.
+ */
+
+typedef struct
+{
+  GstBuffer buffer;
+
+  GstOmxBufferPool *pool;     /* NULL when imported */
+  guint8 *data;               /* what GST_BUFFER_DATA is reset to */
+  guint size;
+
+  gint fd;                    /* holding the data, -1 for heap memory */
+  guint64 fd_offset;          /* of data in the fd */
+  gpointer map;               /* mapping of the fd containing data */
+  gsize map_size;
+} GstOmxPoolBuffer;
+
+static GstMiniObjectClass *pool_buffer_parent_class = NULL;
+
+static void
+pool_free (GstOmxBufferPool * pool)
+{
+  g_mutex_free (pool->lock);
+  g_free (pool);
+}
+
+static void
+pool_buffer_finalize (GstOmxPoolBuffer * buf)
+{
+  GstOmxBufferPool *pool = buf->pool;
+  gboolean last;
+
+  if (!pool)
+    goto free;
+
+  g_mutex_lock (pool->lock);
+  if (!pool->closed && buf->size == pool->size && pool->n_free < pool->max_free &&
+      (buf->fd >= 0) == pool->memfd) {
+    /* back to the pool: take a reference again and reset what users change */
+    gst_buffer_ref (GST_BUFFER_CAST (buf));
+    gst_caps_replace (&GST_BUFFER_CAPS (buf), NULL);
+    GST_BUFFER_FLAGS (buf) = 0;
+    GST_BUFFER_DATA (buf) = buf->data;
+    GST_BUFFER_SIZE (buf) = buf->size;
+    GST_BUFFER_TIMESTAMP (buf) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_DURATION (buf) = GST_CLOCK_TIME_NONE;
+    GST_BUFFER_OFFSET (buf) = GST_BUFFER_OFFSET_NONE;
+    GST_BUFFER_OFFSET_END (buf) = GST_BUFFER_OFFSET_NONE;
+
+    pool->free_buffers = g_slist_prepend (pool->free_buffers, buf);
+    pool->n_free++;
+    g_mutex_unlock (pool->lock);
+    return;
+  }
+
+  pool->n_buffers--;
+  last = pool->closed && pool->n_buffers == 0;
+  g_mutex_unlock (pool->lock);
+
+  if (last)
+    pool_free (pool);
+
+free:
+  if (buf->fd >= 0)
+    gstomx_memfd_free (buf->fd, buf->map, buf->map_size);
+
+  pool_buffer_parent_class->finalize (GST_MINI_OBJECT_CAST (buf));
+}
+
+static void
+pool_buffer_class_init (gpointer g_class, gpointer class_data)
+{
+  GstMiniObjectClass *mini_object_class = GST_MINI_OBJECT_CLASS (g_class);
+
+  pool_buffer_parent_class = g_type_class_peek_parent (g_class);
+  mini_object_class->finalize = (GstMiniObjectFinalizeFunction)
+      pool_buffer_finalize;
+}
+
+static GType
+pool_buffer_get_type (void)
+{
+  static GType type = 0;
+
+  if (G_UNLIKELY (type == 0)) {
+    static const GTypeInfo info = {
+      sizeof (GstBufferClass),
+      NULL,
+      NULL,
+      pool_buffer_class_init,
+      NULL,
+      NULL,
+      sizeof (GstOmxPoolBuffer),
+      0,
+      NULL,
+      NULL
+    };
+
+    type = g_type_register_static (GST_TYPE_BUFFER, "GstOmxPoolBuffer",
+        &info, 0);
+  }
+
+  return type;
+}
+
+/* pool_buffer_get_type () is called here so the type is registered from the
+ * thread creating elements rather than from a streaming thread */
+GstOmxBufferPool *
+gstomx_buffer_pool_new (void)
+{
+  GstOmxBufferPool *pool;
+
+  pool_buffer_get_type ();
+
+  pool = g_new0 (GstOmxBufferPool, 1);
+  pool->lock = g_mutex_new ();
+
+  return pool;
+}
+
+/* free every buffer in the pool; buffers still out are freed on return */
+void
+gstomx_buffer_pool_drain (GstOmxBufferPool * pool)
+{
+  GSList *buffers;
+
+  g_mutex_lock (pool->lock);
+  buffers = pool->free_buffers;
+  pool->free_buffers = NULL;
+  pool->n_free = 0;
+  pool->size = 0;
+  g_mutex_unlock (pool->lock);
+
+  /* the finalize of each buffer takes the lock */
+  g_slist_foreach (buffers, (GFunc) gst_mini_object_unref, NULL);
+  g_slist_free (buffers);
+}
+
+/* called instead of freeing the pool when the element goes away */
+void
+gstomx_buffer_pool_close (GstOmxBufferPool * pool)
+{
+  gboolean last;
+
+  g_mutex_lock (pool->lock);
+  pool->closed = TRUE;
+  g_mutex_unlock (pool->lock);
+
+  gstomx_buffer_pool_drain (pool);
+
+  g_mutex_lock (pool->lock);
+  last = pool->n_buffers == 0;
+  g_mutex_unlock (pool->lock);
+
+  if (last)
+    pool_free (pool);
+}
+
+void
+gstomx_buffer_pool_set_limit (GstOmxBufferPool * pool, guint max_free)
+{
+  g_mutex_lock (pool->lock);
+  pool->max_free = max_free;
+  g_mutex_unlock (pool->lock);
+}
+
+/* hand out buffers in memfd memory from now on */
+void
+gstomx_buffer_pool_set_memfd (GstOmxBufferPool * pool, gboolean memfd)
+{
+  g_mutex_lock (pool->lock);
+  pool->memfd = memfd;
+  g_mutex_unlock (pool->lock);
+
+  gstomx_buffer_pool_drain (pool);
+}
+
+/* a buffer of size bytes, recycled when one of that size is free */
+GstBuffer *
+gstomx_buffer_pool_get (GstOmxBufferPool * pool, guint size)
+{
+  GstOmxPoolBuffer *buf = NULL;
+  GSList *stale = NULL;
+  gboolean memfd;
+
+  g_mutex_lock (pool->lock);
+  memfd = pool->memfd;
+  if (pool->size != size) {
+    stale = pool->free_buffers;
+    pool->free_buffers = NULL;
+    pool->n_free = 0;
+    pool->size = size;
+  }
+  if (pool->free_buffers) {
+    buf = pool->free_buffers->data;
+    pool->free_buffers = g_slist_delete_link (pool->free_buffers,
+        pool->free_buffers);
+    pool->n_free--;
+  } else {
+    pool->n_buffers++;
+    pool->allocations++;
+    pool->peak = MAX (pool->peak, pool->n_buffers);
+  }
+  g_mutex_unlock (pool->lock);
+
+  g_slist_foreach (stale, (GFunc) gst_mini_object_unref, NULL);
+  g_slist_free (stale);
+
+  if (!buf) {
+    buf = (GstOmxPoolBuffer *) gst_mini_object_new (pool_buffer_get_type ());
+    buf->pool = pool;
+    buf->size = size;
+    buf->fd = -1;
+    if (memfd) {
+      buf->fd = gstomx_memfd_alloc ("gst-omx-buffer", size, &buf->map);
+      buf->map_size = size;
+      buf->fd_offset = 0;
+      buf->data = buf->map;
+    }
+    if (buf->fd < 0) {
+      /* heap memory is not taken back by a memfd pool */
+      buf->data = g_malloc (size);
+      GST_BUFFER_MALLOCDATA (buf) = buf->data;
+    }
+    GST_BUFFER_DATA (buf) = buf->data;
+    GST_BUFFER_SIZE (buf) = size;
+  }
+
+  return GST_BUFFER_CAST (buf);
+}
+
+/* the fd and offset another process maps buf from, FALSE if it has none */
+gboolean
+gstomx_buffer_get_memfd (GstBuffer * buf, gint * fd, guint64 * offset)
+{
+  GstOmxPoolBuffer *pool_buf;
+
+  if (G_TYPE_FROM_INSTANCE (buf) != pool_buffer_get_type ())
+    return FALSE;
+
+  pool_buf = (GstOmxPoolBuffer *) buf;
+  if (pool_buf->fd < 0)
+    return FALSE;
+
+  *fd = pool_buf->fd;
+  *offset = pool_buf->fd_offset + (GST_BUFFER_DATA (buf) - pool_buf->data);
+
+  return TRUE;
+}
+
+GstQueryType
+gstomx_memfd_query_type (void)
+{
+  static gsize type = 0;
+
+  if (g_once_init_enter (&type)) {
+    GstQueryType registered;
+
+    registered = gst_query_type_register (GSTOMX_MEMFD_QUERY,
+        "memfd and offset another process maps a buffer from");
+    g_once_init_leave (&type, registered);
+  }
+
+  return (GstQueryType) type;
+}
+
+/*
+ *  description : answer a GSTOMX_MEMFD_QUERY from downstream
+ *  params      : @query: query whose "buffer" field is a buffer pushed before
+ *  return      : FALSE when that buffer is not memfd memory
+ *  comments    : sets "fd" and "offset"; the fd stays owned by the buffer,
+ *                so the consumer passes it on while it holds the buffer
+ */
+gboolean
+gstomx_memfd_query_answer (GstQuery * query)
+{
+  GstStructure *structure;
+  const GValue *value;
+  GstBuffer *buf;
+  gint fd;
+  guint64 offset;
+
+  structure = gst_query_get_structure (query);
+  if (!structure)
+    return FALSE;
+
+  value = gst_structure_get_value (structure, "buffer");
+  if (!value || !GST_VALUE_HOLDS_BUFFER (value))
+    return FALSE;
+
+  buf = gst_value_get_buffer (value);
+  if (!buf || !gstomx_buffer_get_memfd (buf, &fd, &offset))
+    return FALSE;
+
+  gst_structure_set (structure, "fd", G_TYPE_INT, fd,
+      "offset", G_TYPE_UINT64, offset, NULL);
+
+  return TRUE;
+}
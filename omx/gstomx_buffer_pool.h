@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_BUFFER_POOL_H
+#define GSTOMX_BUFFER_POOL_H
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* modification: output buffers of one size, handed back to the pool instead
+ * of being freed when downstream drops them */
+typedef struct GstOmxBufferPool GstOmxBufferPool;
+
+struct GstOmxBufferPool
+{
+  GMutex *lock;
+  GSList *free_buffers;
+  guint n_free;
+  guint max_free;             /* buffers kept for reuse */
+  guint size;                 /* bytes of every buffer, 0 before the first */
+  guint n_buffers;            /* buffers alive, free or not */
+  gboolean closed;            /* element gone, buffers are freed on return */
+  gboolean memfd;             /* new buffers are memfd memory */
+
+  guint allocations;          /* buffers allocated since creation */
+  guint peak;                 /* most buffers alive at once */
+};
+
+GstOmxBufferPool *gstomx_buffer_pool_new (void);
+void gstomx_buffer_pool_close (GstOmxBufferPool * pool);
+void gstomx_buffer_pool_set_limit (GstOmxBufferPool * pool, guint max_free);
+void gstomx_buffer_pool_drain (GstOmxBufferPool * pool);
+GstBuffer *gstomx_buffer_pool_get (GstOmxBufferPool * pool, guint size);
+void gstomx_buffer_pool_set_memfd (GstOmxBufferPool * pool, gboolean memfd);
+
+gboolean gstomx_buffer_get_memfd (GstBuffer * buf, gint * fd,
+    guint64 * offset);
+
+/* modification: application query a consumer sends upstream with a
+ * GSTOMX_MEMFD_QUERY structure holding a pushed "buffer"; memfd buffers are
+ * answered with their "fd" (gint) and "offset" (guint64) */
+#define GSTOMX_MEMFD_QUERY "omx-memfd"
+
+GstQueryType gstomx_memfd_query_type (void);
+gboolean gstomx_memfd_query_answer (GstQuery * query);
+
+G_END_DECLS
+#endif /* GSTOMX_BUFFER_POOL_H */
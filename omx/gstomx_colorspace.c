@@ -0,0 +1,322 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gstomx_colorspace.h"
+
+#include <string.h>             /* for memcpy */
+
+#define FOURCC_I420 GST_MAKE_FOURCC ('I', '4', '2', '0')
+#define FOURCC_NV12 GST_MAKE_FOURCC ('N', 'V', '1', '2')
+#define FOURCC_YUY2 GST_MAKE_FOURCC ('Y', 'U', 'Y', '2')
+#define FOURCC_UYVY GST_MAKE_FOURCC ('U', 'Y', 'V', 'Y')
+
+/* bytes of picture in one row of plane */
+static guint
+plane_row_bytes (const GstOmxFrameLayout * layout, guint plane)
+{
+  switch (layout->fourcc) {
+    case FOURCC_I420:
+      return plane ? (layout->width + 1) / 2 : layout->width;
+    case FOURCC_NV12:
+      return plane ? GST_ROUND_UP_2 (layout->width) : layout->width;
+    default:
+      return GST_ROUND_UP_2 (layout->width) * 2;
+  }
+}
+
+static guint
+plane_rows (const GstOmxFrameLayout * layout, guint plane)
+{
+  return plane ? (layout->height + 1) / 2 : layout->height;
+}
+
+gboolean
+gstomx_frame_layout_caps (GstOmxFrameLayout * layout, guint32 fourcc,
+    guint width, guint height)
+{
+  guint rows = GST_ROUND_UP_2 (height);
+
+  layout->fourcc = fourcc;
+  layout->width = width;
+  layout->height = height;
+  layout->offset[0] = 0;
+
+  /* strides and plane offsets follow gst_video_format_get_*() */
+  switch (fourcc) {
+    case FOURCC_I420:
+      layout->n_planes = 3;
+      layout->stride[0] = GST_ROUND_UP_4 (width);
+      layout->stride[1] = layout->stride[2] = GST_ROUND_UP_8 (width) / 2;
+      layout->offset[1] = layout->stride[0] * rows;
+      layout->offset[2] = layout->offset[1] + layout->stride[1] * (rows / 2);
+      layout->size = layout->offset[2] + layout->stride[2] * (rows / 2);
+      return TRUE;
+    case FOURCC_NV12:
+      layout->n_planes = 2;
+      layout->stride[0] = layout->stride[1] = GST_ROUND_UP_4 (width);
+      layout->offset[1] = layout->stride[0] * rows;
+      layout->size = layout->offset[1] + layout->stride[1] * (rows / 2);
+      return TRUE;
+    case FOURCC_YUY2:
+    case FOURCC_UYVY:
+      layout->n_planes = 1;
+      layout->stride[0] = GST_ROUND_UP_4 (width * 2);
+      layout->size = layout->stride[0] * height;
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
+
+gboolean
+gstomx_frame_layout_port (GstOmxFrameLayout * layout, guint32 fourcc,
+    guint width, guint height, guint stride, guint slice)
+{
+  guint chroma;
+
+  layout->fourcc = fourcc;
+  layout->width = width;
+  layout->height = height;
+  layout->offset[0] = 0;
+
+  switch (fourcc) {
+    case FOURCC_I420:
+    case FOURCC_NV12:
+      stride = MAX (stride, width);
+      break;
+    case FOURCC_YUY2:
+    case FOURCC_UYVY:
+      stride = MAX (stride, GST_ROUND_UP_2 (width) * 2);
+      break;
+    default:
+      return FALSE;
+  }
+  slice = MAX (slice, height);
+  chroma = (slice + 1) / 2;
+
+  switch (fourcc) {
+    case FOURCC_I420:
+      layout->n_planes = 3;
+      layout->stride[0] = stride;
+      layout->stride[1] = layout->stride[2] = (stride + 1) / 2;
+      layout->offset[1] = stride * slice;
+      layout->offset[2] = layout->offset[1] + layout->stride[1] * chroma;
+      layout->size = layout->offset[2] + layout->stride[2] * chroma;
+      break;
+    case FOURCC_NV12:
+      layout->n_planes = 2;
+      layout->stride[0] = layout->stride[1] = stride;
+      layout->offset[1] = stride * slice;
+      layout->size = layout->offset[1] + stride * chroma;
+      break;
+    default:
+      layout->n_planes = 1;
+      layout->stride[0] = stride;
+      layout->size = stride * slice;
+      break;
+  }
+
+  return TRUE;
+}
+
+/* offsets are rounded down to even so chroma stays sited; size still covers
+ * the whole frame the rectangle was taken from */
+void
+gstomx_frame_layout_crop (GstOmxFrameLayout * layout, guint left, guint top,
+    guint width, guint height)
+{
+  left &= ~1;
+  top &= ~1;
+
+  switch (layout->fourcc) {
+    case FOURCC_I420:
+      layout->offset[2] += (top / 2) * layout->stride[2] + left / 2;
+      /* fall through */
+    case FOURCC_NV12:
+      layout->offset[1] += (top / 2) * layout->stride[1] +
+          (layout->fourcc == FOURCC_NV12 ? left : left / 2);
+      layout->offset[0] += top * layout->stride[0] + left;
+      break;
+    default:
+      layout->offset[0] += top * layout->stride[0] + left * 2;
+      break;
+  }
+
+  layout->width = width;
+  layout->height = height;
+}
+
+/* one past the last byte of picture, the least a buffer must hold */
+gsize
+gstomx_frame_layout_end (const GstOmxFrameLayout * layout)
+{
+  gsize end = 0;
+  guint p, rows;
+
+  for (p = 0; p < layout->n_planes; p++) {
+    rows = plane_rows (layout, p);
+    if (rows > 0)
+      end = MAX (end, layout->offset[p] + (gsize) layout->stride[p] *
+          (rows - 1) + plane_row_bytes (layout, p));
+  }
+
+  return end;
+}
+
+/* TRUE when a frame written for one layout can be read with the other */
+gboolean
+gstomx_frame_layout_equal (const GstOmxFrameLayout * a,
+    const GstOmxFrameLayout * b)
+{
+  guint p;
+
+  if (a->fourcc != b->fourcc || a->width != b->width ||
+      a->height != b->height || a->n_planes != b->n_planes)
+    return FALSE;
+
+  for (p = 0; p < a->n_planes; p++) {
+    if (a->offset[p] != b->offset[p] || a->stride[p] != b->stride[p])
+      return FALSE;
+  }
+
+  return TRUE;
+}
+
+static void
+copy_plane (guint8 * dst, guint dst_stride, const guint8 * src,
+    guint src_stride, guint row_bytes, guint rows)
+{
+  guint y;
+
+  if (dst_stride == src_stride && rows > 0) {
+    memcpy (dst, src, (gsize) src_stride * (rows - 1) + row_bytes);
+    return;
+  }
+
+  for (y = 0; y < rows; y++)
+    memcpy (dst + y * dst_stride, src + y * src_stride, row_bytes);
+}
+
+/*
+ *  description : copy I420 into NV12, interleaving the chroma planes
+ *  params      : @dst, @d: NV12 frame and its layout, @src, @s: I420 frame and its layout
+ *  return      : none
+ */
+static void
+i420_to_nv12 (guint8 * dst, const GstOmxFrameLayout * d,
+    const guint8 * src, const GstOmxFrameLayout * s)
+{
+  const guint8 *u, *v;
+  guint8 *uv;
+  guint cw = plane_row_bytes (s, 1), ch = plane_rows (s, 1);
+  guint x, y;
+
+  copy_plane (dst, d->stride[0], src, s->stride[0], s->width, s->height);
+
+  u = src + s->offset[1];
+  v = src + s->offset[2];
+  uv = dst + d->offset[1];
+
+  for (y = 0; y < ch; y++) {
+    for (x = 0; x < cw; x++) {
+      uv[2 * x] = u[x];
+      uv[2 * x + 1] = v[x];
+    }
+    u += s->stride[1];
+    v += s->stride[2];
+    uv += d->stride[1];
+  }
+}
+
+/*
+ *  description : copy YUY2 or UYVY into NV12
+ *  params      : @dst, @d: NV12 frame and its layout, @src, @s: packed 4:2:2
+ *                frame and its layout, @y0: offset of the first luma sample
+ *                in a macropixel (0 YUY2, 1 UYVY)
+ *  return      : none
+ *  comments    : chroma of each row pair is averaged to go from 4:2:2 to 4:2:0;
+ *                the last row of an odd height is taken alone
+ */
+static void
+packed_to_nv12 (guint8 * dst, const GstOmxFrameLayout * d,
+    const guint8 * src, const GstOmxFrameLayout * s, guint y0)
+{
+  guint stride = s->stride[0];
+  guint c0 = y0 ^ 1;
+  guint8 *uv = dst + d->offset[1];
+  guint x, y;
+
+  for (y = 0; y < s->height; y++) {
+    const guint8 *row = src + y * stride;
+    guint8 *out = dst + y * d->stride[0];
+
+    for (x = 0; x < s->width; x++)
+      out[x] = row[2 * x + y0];
+  }
+
+  for (y = 0; y < s->height; y += 2) {
+    const guint8 *s0 = src + y * stride + c0;
+    const guint8 *s1 = (y + 1 < s->height) ? s0 + stride : s0;
+
+    for (x = 0; x < GST_ROUND_UP_2 (s->width); x += 2) {
+      uv[x] = (s0[2 * x] + s1[2 * x] + 1) >> 1;
+      uv[x + 1] = (s0[2 * x + 2] + s1[2 * x + 2] + 1) >> 1;
+    }
+    uv += d->stride[1];
+  }
+}
+
+/* every byte is read and written once; returns FALSE for an unhandled pair
+ * of formats, or when the picture sizes differ */
+gboolean
+gstomx_frame_copy (guint8 * dst, const GstOmxFrameLayout * dst_layout,
+    const guint8 * src, const GstOmxFrameLayout * src_layout)
+{
+  guint p;
+
+  if (dst_layout->width != src_layout->width ||
+      dst_layout->height != src_layout->height)
+    return FALSE;
+
+  if (dst_layout->fourcc == src_layout->fourcc) {
+    for (p = 0; p < src_layout->n_planes; p++) {
+      copy_plane (dst + dst_layout->offset[p], dst_layout->stride[p],
+          src + src_layout->offset[p], src_layout->stride[p],
+          plane_row_bytes (src_layout, p), plane_rows (src_layout, p));
+    }
+    return TRUE;
+  }
+
+  if (dst_layout->fourcc != FOURCC_NV12)
+    return FALSE;
+
+  switch (src_layout->fourcc) {
+    case FOURCC_I420:
+      i420_to_nv12 (dst, dst_layout, src, src_layout);
+      return TRUE;
+    case FOURCC_YUY2:
+      packed_to_nv12 (dst, dst_layout, src, src_layout, 0);
+      return TRUE;
+    case FOURCC_UYVY:
+      packed_to_nv12 (dst, dst_layout, src, src_layout, 1);
+      return TRUE;
+    default:
+      return FALSE;
+  }
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_COLORSPACE_H
+#define GSTOMX_COLORSPACE_H
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* modification: where the planes of a raw video frame lie in memory */
+typedef struct
+{
+  guint32 fourcc;
+  guint width;
+  guint height;
+  guint n_planes;
+  gsize offset[3];
+  guint stride[3];
+  gsize size;
+} GstOmxFrameLayout;
+
+/* layout of video/x-raw-yuv caps, as used by upstream elements */
+gboolean gstomx_frame_layout_caps (GstOmxFrameLayout * layout, guint32 fourcc,
+    guint width, guint height);
+/* layout of an OMX port with nStride and nSliceHeight, 0 meaning packed */
+gboolean gstomx_frame_layout_port (GstOmxFrameLayout * layout, guint32 fourcc,
+    guint width, guint height, guint stride, guint slice);
+/* narrow a layout to the width x height rectangle at left, top */
+void gstomx_frame_layout_crop (GstOmxFrameLayout * layout, guint left,
+    guint top, guint width, guint height);
+/* one past the last byte of picture */
+gsize gstomx_frame_layout_end (const GstOmxFrameLayout * layout);
+gboolean gstomx_frame_layout_equal (const GstOmxFrameLayout * a,
+    const GstOmxFrameLayout * b);
+/* copy between layouts of one format, or I420/YUY2/UYVY into NV12 */
+gboolean gstomx_frame_copy (guint8 * dst, const GstOmxFrameLayout * dst_layout,
+    const guint8 * src, const GstOmxFrameLayout * src_layout);
+
+G_END_DECLS
+#endif /* GSTOMX_COLORSPACE_H */
@@ -0,0 +1,189 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gstomx_g711.h"
+
+/* modification: every code maps to one sample and every sample to one code,
+ * so both directions are table lookups; the encoder tables are indexed by
+ * the 14 (mu-law) or 13 (A-law) significant bits of the sample */
+#define ULAW_BITS 14
+#define ALAW_BITS 13
+
+static gint16 ulaw_to_linear[256];
+static gint16 alaw_to_linear[256];
+static guint8 linear_to_ulaw[1 << ULAW_BITS];
+static guint8 linear_to_alaw[1 << ALAW_BITS];
+
+GType
+gstomx_g711_implementation_get_type (void)
+{
+  static GType gstomx_g711_implementation_type = 0;
+
+  if (!gstomx_g711_implementation_type) {
+    static GEnumValue gstomx_g711_implementation[] = {
+      {GSTOMX_G711_IMPLEMENTATION_AUTO,
+          "OpenMAX component, inline if it can not be used", "auto"},
+      {GSTOMX_G711_IMPLEMENTATION_OMX, "OpenMAX component", "omx"},
+      {GSTOMX_G711_IMPLEMENTATION_INLINE, "Table lookup in the element",
+          "inline"},
+      {0, NULL, NULL},
+    };
+
+    gstomx_g711_implementation_type =
+        g_enum_register_static ("GstOmxG711Implementation",
+        gstomx_g711_implementation);
+  }
+
+  return gstomx_g711_implementation_type;
+}
+
+/* segment of value, the number of its bits above the first 5, 8 if more */
+static inline gint
+segment (gint value, gint first_end)
+{
+  gint seg;
+
+  for (seg = 0; seg < 8; seg++) {
+    if (value <= first_end)
+      return seg;
+    first_end = (first_end << 1) | 1;
+  }
+
+  return 8;
+}
+
+/* ITU-T G.711 reference coding of a 16 bit sample */
+static guint8
+encode_ulaw (gint16 sample)
+{
+  gint value = sample >> 2;
+  guint8 mask = 0xff;
+  gint seg;
+
+  if (value < 0) {
+    value = -value;
+    mask = 0x7f;
+  }
+  value = MIN (value, 8159) + 0x21;
+
+  seg = segment (value, 0x3f);
+  if (seg >= 8)
+    return 0x7f ^ mask;
+
+  return ((seg << 4) | ((value >> (seg + 1)) & 0xf)) ^ mask;
+}
+
+static guint8
+encode_alaw (gint16 sample)
+{
+  gint value = sample >> 3;
+  guint8 mask = 0xd5;
+  gint seg;
+
+  if (value < 0) {
+    value = -value - 1;
+    mask = 0x55;
+  }
+
+  seg = segment (value, 0x1f);
+  if (seg >= 8)
+    return 0x7f ^ mask;
+
+  if (seg < 2)
+    return ((seg << 4) | ((value >> 1) & 0xf)) ^ mask;
+
+  return ((seg << 4) | ((value >> seg) & 0xf)) ^ mask;
+}
+
+static gint16
+decode_ulaw (guint8 code)
+{
+  gint t;
+
+  code = ~code;
+  t = (((code & 0xf) << 3) + 0x84) << ((code & 0x70) >> 4);
+
+  return (code & 0x80) ? 0x84 - t : t - 0x84;
+}
+
+static gint16
+decode_alaw (guint8 code)
+{
+  gint t, seg;
+
+  code ^= 0x55;
+  t = (code & 0xf) << 4;
+  seg = (code & 0x70) >> 4;
+
+  if (seg == 0)
+    t += 8;
+  else
+    t = (t + 0x108) << (seg - 1);
+
+  return (code & 0x80) ? t : -t;
+}
+
+/* fill the tables, safe to call from any thread */
+void
+gstomx_g711_init (void)
+{
+  static gsize initialized = 0;
+  guint i;
+
+  if (!g_once_init_enter (&initialized))
+    return;
+
+  for (i = 0; i < 256; i++) {
+    ulaw_to_linear[i] = decode_ulaw (i);
+    alaw_to_linear[i] = decode_alaw (i);
+  }
+
+  for (i = 0; i < (1 << ULAW_BITS); i++)
+    linear_to_ulaw[i] = encode_ulaw ((gint16) (i << (16 - ULAW_BITS)));
+  for (i = 0; i < (1 << ALAW_BITS); i++)
+    linear_to_alaw[i] = encode_alaw ((gint16) (i << (16 - ALAW_BITS)));
+
+  g_once_init_leave (&initialized, 1);
+}
+
+/* n codes of src to n native endian samples of dst */
+void
+gstomx_g711_decode (gint16 * dst, const guint8 * src, guint n, gboolean alaw)
+{
+  const gint16 *table = alaw ? alaw_to_linear : ulaw_to_linear;
+  guint i;
+
+  for (i = 0; i < n; i++)
+    dst[i] = table[src[i]];
+}
+
+/* n native endian samples of src to n codes of dst */
+void
+gstomx_g711_encode (guint8 * dst, const gint16 * src, guint n, gboolean alaw)
+{
+  guint i;
+
+  if (alaw) {
+    for (i = 0; i < n; i++)
+      dst[i] = linear_to_alaw[(guint16) src[i] >> (16 - ALAW_BITS)];
+  } else {
+    for (i = 0; i < n; i++)
+      dst[i] = linear_to_ulaw[(guint16) src[i] >> (16 - ULAW_BITS)];
+  }
+}
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_G711_H
+#define GSTOMX_G711_H
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* modification: where G.711 is coded, the OpenMAX component or a table
+ * lookup inside the element */
+typedef enum
+{
+  GSTOMX_G711_IMPLEMENTATION_AUTO,
+  GSTOMX_G711_IMPLEMENTATION_OMX,
+  GSTOMX_G711_IMPLEMENTATION_INLINE,
+} GstOmxG711Implementation;
+
+#define GST_TYPE_OMX_G711_IMPLEMENTATION (gstomx_g711_implementation_get_type ())
+GType gstomx_g711_implementation_get_type (void);
+
+void gstomx_g711_init (void);
+void gstomx_g711_decode (gint16 * dst, const guint8 * src, guint n,
+    gboolean alaw);
+void gstomx_g711_encode (guint8 * dst, const gint16 * src, guint n,
+    gboolean alaw);
+
+G_END_DECLS
+#endif /* GSTOMX_G711_H */
@@ -25,6 +25,12 @@
 
 #include <string.h>             /* for strcmp */
 
+enum
+{
+  ARG_0,
+  ARG_IMPLEMENTATION,
+};
+
 /* should this class extend GstOmxBaseAudioDec? */
 GSTOMX_BOILERPLATE (GstOmxG711Dec, gst_omx_g711dec, GstOmxBaseFilter,
     GST_OMX_BASE_FILTER_TYPE);
@@ -50,9 +56,99 @@ type_base_init (gpointer g_class)
           gstomx_template_caps (G_TYPE_FROM_CLASS (g_class), "src")));
 }
 
+/* modification: decode buf in the element, two bytes per code */
+static GstFlowReturn
+inline_chain (GstOmxBaseFilter * omx_base, GstBuffer * buf)
+{
+  GstOmxG711Dec *self;
+  GstBuffer *out = NULL;
+  GstFlowReturn ret;
+
+  self = GST_OMX_G711DEC (omx_base);
+
+  ret = gst_pad_alloc_buffer_and_set_caps (omx_base->srcpad,
+      GST_BUFFER_OFFSET_NONE, GST_BUFFER_SIZE (buf) * 2,
+      GST_PAD_CAPS (omx_base->srcpad), &out);
+
+  if (ret == GST_FLOW_OK) {
+    gstomx_g711_decode ((gint16 *) GST_BUFFER_DATA (out),
+        GST_BUFFER_DATA (buf), GST_BUFFER_SIZE (buf), self->alaw);
+    gst_buffer_copy_metadata (out, buf,
+        GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS);
+    ret = gst_pad_push (omx_base->srcpad, out);
+  }
+
+  gst_buffer_unref (buf);
+
+  return ret;
+}
+
+static void
+set_property (GObject * obj,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstOmxBaseFilter *omx_base;
+  GstOmxG711Dec *self;
+
+  omx_base = GST_OMX_BASE_FILTER (obj);
+  self = GST_OMX_G711DEC (obj);
+
+  switch (prop_id) {
+    case ARG_IMPLEMENTATION:
+      self->implementation = g_value_get_enum (value);
+      omx_base->use_inline =
+          (self->implementation == GSTOMX_G711_IMPLEMENTATION_INLINE);
+      omx_base->inline_fallback =
+          (self->implementation == GSTOMX_G711_IMPLEMENTATION_AUTO);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstOmxG711Dec *self;
+
+  self = GST_OMX_G711DEC (obj);
+
+  switch (prop_id) {
+    case ARG_IMPLEMENTATION:
+      g_value_set_enum (value, self->implementation);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+  }
+}
+
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
+  GObjectClass *gobject_class;
+  GstOmxBaseFilterClass *basefilter_class;
+
+  gobject_class = G_OBJECT_CLASS (g_class);
+  basefilter_class = GST_OMX_BASE_FILTER_CLASS (g_class);
+
+  /* Properties stuff */
+  {
+    gobject_class->set_property = set_property;
+    gobject_class->get_property = get_property;
+
+    g_object_class_install_property (gobject_class, ARG_IMPLEMENTATION,
+        g_param_spec_enum ("implementation", "Implementation",
+            "Code with the OpenMAX component or inline in the element "
+            "(only in NULL state)",
+            GST_TYPE_OMX_G711_IMPLEMENTATION, GSTOMX_G711_IMPLEMENTATION_AUTO,
+            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  }
+
+  basefilter_class->inline_chain = inline_chain;
+
+  gstomx_g711_init ();
 }
 
 static gboolean
@@ -60,11 +156,13 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
 {
   GstStructure *structure;
   GstOmxBaseFilter *omx_base;
+  GstOmxG711Dec *self;
   GOmxCore *gomx;
   const gchar *mode;
   gboolean ret = TRUE;
 
   omx_base = GST_OMX_BASE_FILTER (GST_PAD_PARENT (pad));
+  self = GST_OMX_G711DEC (omx_base);
   gomx = (GOmxCore *) omx_base->gomx;
 
   GST_INFO_OBJECT (omx_base, "setcaps (sink): %" GST_PTR_FORMAT, caps);
@@ -72,6 +170,29 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
   structure = gst_caps_get_structure (caps, 0);
 
   mode = gst_structure_get_name (structure);
+  self->alaw = (strcmp (mode, "audio/x-alaw") == 0);
+
+  /* modification: inline decoding produces native endian 16 bit samples */
+  if (omx_base->use_inline) {
+    GstCaps *src_caps;
+    gint rate = 8000;
+    gint channels = 1;
+
+    gst_structure_get_int (structure, "rate", &rate);
+    gst_structure_get_int (structure, "channels", &channels);
+
+    src_caps = gst_caps_new_simple ("audio/x-raw-int",
+        "width", G_TYPE_INT, 16,
+        "depth", G_TYPE_INT, 16,
+        "rate", G_TYPE_INT, rate,
+        "signed", G_TYPE_BOOLEAN, TRUE,
+        "endianness", G_TYPE_INT, G_BYTE_ORDER,
+        "channels", G_TYPE_INT, channels, NULL);
+    gst_pad_set_caps (omx_base->srcpad, src_caps);
+    gst_caps_unref (src_caps);
+
+    return gst_pad_set_caps (pad, caps);
+  }
 
   /* Output port configuration. */
   {
@@ -117,8 +238,13 @@ static void
 type_instance_init (GTypeInstance * instance, gpointer g_class)
 {
   GstOmxBaseFilter *omx_base;
+  GstOmxG711Dec *self;
 
   omx_base = GST_OMX_BASE_FILTER (instance);
+  self = GST_OMX_G711DEC (instance);
 
   gst_pad_set_setcaps_function (omx_base->sinkpad, sink_setcaps);
+
+  self->implementation = GSTOMX_G711_IMPLEMENTATION_AUTO;
+  omx_base->inline_fallback = TRUE;
 }
@@ -31,10 +31,13 @@ typedef struct GstOmxG711Dec GstOmxG711Dec;
 typedef struct GstOmxG711DecClass GstOmxG711DecClass;
 
 #include "gstomx_base_filter.h"
+#include "gstomx_g711.h"
 
 struct GstOmxG711Dec
 {
   GstOmxBaseFilter omx_base;
+  GstOmxG711Implementation implementation;
+  gboolean alaw;                      /* A-law rather than mu-law, inline */
 };
 
 struct GstOmxG711DecClass
@@ -25,6 +25,12 @@
 
 #include <string.h>             /* for strcmp */
 
+enum
+{
+  ARG_0,
+  ARG_IMPLEMENTATION,
+};
+
 GSTOMX_BOILERPLATE (GstOmxG711Enc, gst_omx_g711enc, GstOmxBaseFilter,
     GST_OMX_BASE_FILTER_TYPE);
 
@@ -49,9 +55,104 @@ type_base_init (gpointer g_class)
           gstomx_template_caps (G_TYPE_FROM_CLASS (g_class), "src")));
 }
 
+/* modification: encode buf in the element, one code per sample */
+static GstFlowReturn
+inline_chain (GstOmxBaseFilter * omx_base, GstBuffer * buf)
+{
+  GstOmxG711Enc *self;
+  GstBuffer *out = NULL;
+  GstFlowReturn ret;
+  guint samples;
+
+  self = GST_OMX_G711ENC (omx_base);
+  samples = GST_BUFFER_SIZE (buf) / 2;
+
+  ret = gst_pad_alloc_buffer_and_set_caps (omx_base->srcpad,
+      GST_BUFFER_OFFSET_NONE, samples, GST_PAD_CAPS (omx_base->srcpad), &out);
+
+  if (ret == GST_FLOW_OK) {
+    gstomx_g711_encode (GST_BUFFER_DATA (out),
+        (const gint16 *) GST_BUFFER_DATA (buf), samples, self->alaw);
+    gst_buffer_copy_metadata (out, buf,
+        GST_BUFFER_COPY_FLAGS | GST_BUFFER_COPY_TIMESTAMPS);
+    ret = gst_pad_push (omx_base->srcpad, out);
+  }
+
+  gst_buffer_unref (buf);
+
+  return ret;
+}
+
+static void
+set_property (GObject * obj,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstOmxBaseFilter *omx_base;
+  GstOmxG711Enc *self;
+
+  omx_base = GST_OMX_BASE_FILTER (obj);
+  self = GST_OMX_G711ENC (obj);
+
+  switch (prop_id) {
+    case ARG_IMPLEMENTATION:
+      self->implementation = g_value_get_enum (value);
+      omx_base->use_inline =
+          (self->implementation == GSTOMX_G711_IMPLEMENTATION_INLINE);
+      omx_base->inline_fallback =
+          (self->implementation == GSTOMX_G711_IMPLEMENTATION_AUTO);
+      break;
+    default:
+      /* modification: the voice properties of the base filter */
+      G_OBJECT_CLASS (parent_class)->set_property (obj, prop_id, value, pspec);
+      break;
+  }
+}
+
+static void
+get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstOmxG711Enc *self;
+
+  self = GST_OMX_G711ENC (obj);
+
+  switch (prop_id) {
+    case ARG_IMPLEMENTATION:
+      g_value_set_enum (value, self->implementation);
+      break;
+    default:
+      /* modification: the voice properties of the base filter */
+      G_OBJECT_CLASS (parent_class)->get_property (obj, prop_id, value, pspec);
+      break;
+  }
+}
+
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
+  GObjectClass *gobject_class;
+  GstOmxBaseFilterClass *basefilter_class;
+
+  gobject_class = G_OBJECT_CLASS (g_class);
+  basefilter_class = GST_OMX_BASE_FILTER_CLASS (g_class);
+
+  /* Properties stuff */
+  {
+    gobject_class->set_property = set_property;
+    gobject_class->get_property = get_property;
+
+    gst_omx_base_filter_install_voice_properties (gobject_class);
+
+    g_object_class_install_property (gobject_class, ARG_IMPLEMENTATION,
+        g_param_spec_enum ("implementation", "Implementation",
+            "Code with the OpenMAX component or inline in the element "
+            "(only in NULL state)",
+            GST_TYPE_OMX_G711_IMPLEMENTATION, GSTOMX_G711_IMPLEMENTATION_AUTO,
+            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  }
+
+  basefilter_class->inline_chain = inline_chain;
+
+  gstomx_g711_init ();
 }
 
 static gboolean
@@ -60,11 +161,13 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
   GstCaps *peer_caps;
   GstStructure *structure;
   GstOmxBaseFilter *omx_base;
+  GstOmxG711Enc *self;
   GOmxCore *gomx;
   const gchar *mode;
   gboolean ret = TRUE;
 
   omx_base = GST_OMX_BASE_FILTER (GST_PAD_PARENT (pad));
+  self = GST_OMX_G711ENC (omx_base);
   gomx = (GOmxCore *) omx_base->gomx;
 
   GST_INFO_OBJECT (omx_base, "setcaps (sink): %" GST_PTR_FORMAT, caps);
@@ -82,6 +185,25 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
   structure = gst_caps_get_structure (peer_caps, 0);
 
   mode = gst_structure_get_name (structure);
+  self->alaw = (strcmp (mode, "audio/x-alaw") == 0);
+
+  /* modification: inline encoding takes the rate and channels as they are */
+  if (omx_base->use_inline) {
+    GstCaps *src_caps;
+    gint rate = 8000;
+    gint channels = 1;
+
+    structure = gst_caps_get_structure (caps, 0);
+    gst_structure_get_int (structure, "rate", &rate);
+    gst_structure_get_int (structure, "channels", &channels);
+
+    src_caps = gst_caps_new_simple (mode,
+        "rate", G_TYPE_INT, rate, "channels", G_TYPE_INT, channels, NULL);
+    gst_pad_set_caps (omx_base->srcpad, src_caps);
+    gst_caps_unref (src_caps);
+
+    goto done;
+  }
 
   /* Output port configuration. */
   {
@@ -102,6 +224,19 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
 
 leave:
 
+  /* modification: split the output into 10 ms frames */
+  {
+    gint rate = 8000;
+    gint channels = 1;
+
+    structure = gst_caps_get_structure (caps, 0);
+    gst_structure_get_int (structure, "rate", &rate);
+    gst_structure_get_int (structure, "channels", &channels);
+
+    omx_base->codec_frame_bytes = rate / 100 * channels;
+    omx_base->codec_frame_duration = 10 * GST_MSECOND;
+  }
+
   /* set caps on the srcpad */
   {
     GstCaps *tmp_caps;
@@ -120,6 +255,7 @@ leave:
     gst_caps_unref (tmp_caps);
   }
 
+done:
   ret = gst_pad_set_caps (pad, caps);
 
   gst_caps_unref (peer_caps);
@@ -131,8 +267,13 @@ static void
 type_instance_init (GTypeInstance * instance, gpointer g_class)
 {
   GstOmxBaseFilter *omx_base;
+  GstOmxG711Enc *self;
 
   omx_base = GST_OMX_BASE_FILTER (instance);
+  self = GST_OMX_G711ENC (instance);
 
   gst_pad_set_setcaps_function (omx_base->sinkpad, sink_setcaps);
+
+  self->implementation = GSTOMX_G711_IMPLEMENTATION_AUTO;
+  omx_base->inline_fallback = TRUE;
 }
@@ -31,10 +31,13 @@ typedef struct GstOmxG711Enc GstOmxG711Enc;
 typedef struct GstOmxG711EncClass GstOmxG711EncClass;
 
 #include "gstomx_base_filter.h"
+#include "gstomx_g711.h"
 
 struct GstOmxG711Enc
 {
   GstOmxBaseFilter omx_base;
+  GstOmxG711Implementation implementation;
+  gboolean alaw;                      /* A-law rather than mu-law, inline */
 };
 
 struct GstOmxG711EncClass
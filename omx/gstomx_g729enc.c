@@ -25,6 +25,14 @@
 
 #define DEFAULT_DTX TRUE
 
+/* modification: output buffer sizing, 10 ms frames at 8 kbit/s */
+#define BITRATE 8000
+#define OUTPUT_BUFFER_FACTOR 2
+
+/* modification: a speech frame carries 10 ms in 10 bytes, SID frames are
+ * shorter and can not be told apart in the output */
+#define FRAME_SIZE 10
+
 enum
 {
   ARG_0,
@@ -68,7 +76,8 @@ set_property (GObject * obj,
       self->dtx = g_value_get_boolean (value);
       break;
     default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      /* modification: the voice properties of the base filter */
+      G_OBJECT_CLASS (parent_class)->set_property (obj, prop_id, value, pspec);
       break;
   }
 }
@@ -86,7 +95,8 @@ get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
       g_value_set_boolean (value, self->dtx);
       break;
     default:
-      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      /* modification: the voice properties of the base filter */
+      G_OBJECT_CLASS (parent_class)->get_property (obj, prop_id, value, pspec);
       break;
   }
 }
@@ -103,6 +113,8 @@ type_class_init (gpointer g_class, gpointer class_data)
     gobject_class->set_property = set_property;
     gobject_class->get_property = get_property;
 
+    gst_omx_base_filter_install_voice_properties (gobject_class);
+
     g_object_class_install_property (gobject_class, ARG_DTX,
         g_param_spec_boolean ("dtx", "DTX",
             "Enable DTX",
@@ -172,6 +184,22 @@ omx_setup (GstOmxBaseFilter * omx_base)
     OMX_SetParameter (gomx->omx_handle, OMX_IndexParamAudioG729, &param);
   }
 
+  /* modification: size output buffers for the frames of a batch, of 8 kHz
+   * mono input */
+  {
+    guint frames;
+
+    frames = gst_omx_base_filter_frames_per_output (omx_base, 10 * GST_MSECOND,
+        8000 * 2);
+    gst_omx_base_filter_set_out_buffer_size (omx_base,
+        gstomx_encoded_buffer_size (BITRATE, frames * 10 * GST_MSECOND,
+            OUTPUT_BUFFER_FACTOR), 0);
+  }
+
+  /* modification: without DTX the output splits into whole frames */
+  omx_base->codec_frame_bytes = self->dtx ? 0 : FRAME_SIZE;
+  omx_base->codec_frame_duration = 10 * GST_MSECOND;
+
   GST_INFO_OBJECT (omx_base, "end");
 }
 
@@ -25,6 +25,39 @@
 GSTOMX_BOILERPLATE (GstOmxH263Dec, gst_omx_h263dec, GstOmxBaseVideoDec,
     GST_OMX_BASE_VIDEODEC_TYPE);
 
+/*
+ *  description : find the start of the next picture in an H.263 stream
+ *  params      : @omx_base : base filter, @data, @size: stream data, @from: first position to check
+ *  return      : offset of the picture start code beginning the next picture, -1 if none
+ *  comments    : the PSC is byte aligned, 16 zero bits followed by 1000 00 (5.1.1);
+ *                a GBSC carries a non-zero group number in those last bits
+ */
+static gint
+find_frame_start (GstOmxBaseFilter * omx_base, const guint8 * data, guint size,
+    guint from)
+{
+  guint pos = from;
+  guint limit;
+
+  if (size < GSTOMX_FRAME_LOOKAHEAD)
+    return -1;
+
+  limit = size - GSTOMX_FRAME_LOOKAHEAD + 1;
+
+  while ((pos = gstomx_video_find_zero_pair (data, limit, pos)) < limit) {
+    if ((data[pos + 2] & 0xfc) == 0x80) {
+      if (omx_base->frame_has_picture)
+        return pos;
+      omx_base->frame_has_picture = TRUE;
+      pos += 3;
+    } else {
+      pos++;
+    }
+  }
+
+  return -1;
+}
+
 static void
 type_base_init (gpointer g_class)
 {
@@ -49,6 +82,11 @@ type_base_init (gpointer g_class)
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
+  GstOmxBaseFilterClass *basefilter_class;
+
+  basefilter_class = GST_OMX_BASE_FILTER_CLASS (g_class);
+
+  basefilter_class->find_frame_start = find_frame_start;
 }
 
 static void
@@ -48,6 +48,8 @@ typedef enum
     GSTOMX_H264_NUT_EOSEQ = 10,
     GSTOMX_H264_NUT_EOSTREAM = 11,
     GSTOMX_H264_NUT_FILL = 12,
+    GSTOMX_H264_NUT_PREFIX = 14,
+    GSTOMX_H264_NUT_RSV18 = 18,
     GSTOMX_H264_NUT_MIXED = 24,
 } GSTOMX_H264_NAL_UNIT_TYPE;
 
@@ -79,5 +81,28 @@ typedef enum
                                    (((const unsigned char*)(x))[2] <<  8) | \
                                    ((const unsigned char*)(x))[3])
 
+/* returns the offset of the first 00 00 01 start code prefix in data,
+ * or size if there is none */
+static inline guint
+gstomx_h264_find_start_code (const guint8 * data, guint size)
+{
+  guint i = 0;
+
+  while (i + 2 < size) {
+    /* the third byte of a prefix is 0x01, anything larger rules out all
+     * three positions that could include it */
+    if (data[i + 2] > 1)
+      i += 3;
+    else if (data[i + 1])
+      i += 2;
+    else if (data[i] || data[i + 2] != 1)
+      i++;
+    else
+      return i;
+  }
+
+  return size;
+}
+
 G_END_DECLS
 #endif /* GSTOMX_H264_H */
@@ -300,6 +300,67 @@ EXIT:
   return ret;
 }
 
+/*
+ *  description : find the start of the next access unit in a byte-stream
+ *  params      : @omx_base : base filter, @data, @size: stream data, @from: first position to check
+ *  return      : offset of the start code beginning the next access unit, -1 if none
+ *  comments    : an access unit ends when a NAL of type 6-9 or 14-18, or a slice
+ *                with first_mb_in_slice 0, follows its first slice (7.4.1.2.3)
+ */
+static gint
+find_frame_start (GstOmxBaseFilter * omx_base, const guint8 * data, guint size,
+    guint from)
+{
+  guint pos = from;
+  guint limit;
+
+  if (size < GSTOMX_FRAME_LOOKAHEAD)
+    return -1;
+
+  /* the start code, NAL header and first slice byte must be available */
+  limit = size - GSTOMX_FRAME_LOOKAHEAD + 3;
+
+  while (pos + 2 < limit) {
+    guint8 nal_type;
+
+    pos += gstomx_h264_find_start_code (data + pos, limit - pos);
+    if (pos + 2 >= limit)
+      break;
+
+    nal_type = data[pos + 3] & 0x1f;
+
+    switch (nal_type) {
+      case GSTOMX_H264_NUT_SLICE:
+      case GSTOMX_H264_NUT_DPA:
+      case GSTOMX_H264_NUT_IDR:
+        /* first_mb_in_slice is ue(v), so 0 is a single set bit */
+        if (omx_base->frame_has_picture && (data[pos + 4] & 0x80))
+          return pos;
+        omx_base->frame_has_picture = TRUE;
+        break;
+      case GSTOMX_H264_NUT_SEI:
+      case GSTOMX_H264_NUT_SPS:
+      case GSTOMX_H264_NUT_PPS:
+      case GSTOMX_H264_NUT_AUD:
+        if (omx_base->frame_has_picture) {
+          omx_base->frame_has_picture = FALSE;
+          return pos;
+        }
+        break;
+      default:
+        if (nal_type >= GSTOMX_H264_NUT_PREFIX &&
+            nal_type <= GSTOMX_H264_NUT_RSV18 && omx_base->frame_has_picture) {
+          omx_base->frame_has_picture = FALSE;
+          return pos;
+        }
+        break;
+    }
+
+    pos += 3;
+  }
+
+  return -1;
+}
 
 static void
 process_input_buf (GstOmxBaseFilter * omx_base_filter, GstBuffer **buf)
@@ -325,6 +386,10 @@ process_input_buf (GstOmxBaseFilter * omx_base_filter, GstBuffer **buf)
     convert_frame(h264_self, buf);
   }
 
+  /* modification: byte-stream input is not necessarily split at access units */
+  omx_base_filter->use_framing =
+      (h264_self->h264Format == GSTOMX_H264_FORMAT_NALU && !h264_self->h264AuAligned);
+
   GST_OMX_BASE_FILTER_CLASS (parent_class)->process_input_buf (omx_base_filter, buf);
 }
 
@@ -357,6 +422,7 @@ type_class_init (gpointer g_class, gpointer class_data)
   basefilter_class = GST_OMX_BASE_FILTER_CLASS (g_class);
 
   basefilter_class->process_input_buf = process_input_buf;
+  basefilter_class->find_frame_start = find_frame_start;
 }
 
 /* h264 dec has its own sink_setcaps for supporting nalu convert codec data */
@@ -393,9 +459,19 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     if (framerate) {
       self->framerate_num = gst_value_get_fraction_numerator (framerate);
       self->framerate_denom = gst_value_get_fraction_denominator (framerate);
+      if (self->framerate_num > 0 && self->framerate_denom > 0)
+        omx_base->frame_duration = gst_util_uint64_scale_int (GST_SECOND,
+            self->framerate_denom, self->framerate_num);
     }
   }
 
+  {
+    const gchar *alignment;
+
+    alignment = gst_structure_get_string (structure, "alignment");
+    h264_self->h264AuAligned = (alignment && !strcmp (alignment, "au"));
+  }
+
   G_OMX_INIT_PARAM (param);
 
   {
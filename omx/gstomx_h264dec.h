@@ -39,6 +39,7 @@ struct GstOmxH264Dec
   GstOmxBaseVideoDec omx_base;
   GSTOMX_H264_STREAM_FORMAT h264Format;
   OMX_U32 h264NalLengthSize;
+  gboolean h264AuAligned; /* upstream delivers whole access units */
 };
 
 struct GstOmxH264DecClass
@@ -50,6 +50,8 @@ type_base_init (gpointer g_class)
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
+  /* modification: handled by the inherited set_property and get_property */
+  gst_omx_base_filter_install_voice_properties (G_OBJECT_CLASS (g_class));
 }
 
 static gboolean
@@ -72,8 +74,16 @@ sink_setcaps (GstPad * pad, GstCaps * caps)
     gst_pad_fixate_caps (omx_base->srcpad, tmp_caps);
 
     if (gst_caps_is_fixed (tmp_caps)) {
+      gint mode = 20;
+
       GST_INFO_OBJECT (omx_base, "fixated to: %" GST_PTR_FORMAT, tmp_caps);
       gst_pad_set_caps (omx_base->srcpad, tmp_caps);
+
+      /* modification: 38 byte frames of 20 ms or 50 byte frames of 30 ms */
+      gst_structure_get_int (gst_caps_get_structure (tmp_caps, 0), "mode",
+          &mode);
+      omx_base->codec_frame_bytes = (mode == 30) ? 50 : 38;
+      omx_base->codec_frame_duration = ((mode == 30) ? 30 : 20) * GST_MSECOND;
     }
 
     gst_caps_unref (tmp_caps);
@@ -0,0 +1,582 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gstomx_instances.h"
+#include "gstomx.h"
+
+#include <string.h>             /* for memcpy */
+
+/*
+ * A work unit is unit_frames input frames in a row. It goes whole to the
+ * least loaded instance, so each instance sees a stream of independent
+ * units. Every frame gives one output buffer; the outputs of the oldest
+ * unit are pushed as they come, those of later units wait for it.
+ */
+
+typedef struct
+{
+  guint index;                /* of the instance coding it */
+  guint sent;
+  guint received;
+  gboolean closed;            /* no more frames are sent */
+  GQueue outputs;             /* waiting for the units before */
+} GstOmxUnit;
+
+static void
+unit_free (GstOmxUnit * unit)
+{
+  GstBuffer *buf;
+
+  while ((buf = g_queue_pop_head (&unit->outputs)))
+    gst_buffer_unref (buf);
+
+  g_slice_free (GstOmxUnit, unit);
+}
+
+/* the unit the next output of the instance belongs to */
+static GstOmxUnit *
+find_unit (GstOmxInstances * instances, guint index)
+{
+  GList *l;
+  GstOmxUnit *last = NULL;
+
+  for (l = instances->units.head; l; l = l->next) {
+    GstOmxUnit *unit = l->data;
+
+    if (unit->index != index)
+      continue;
+    if (unit->received < unit->sent)
+      return unit;
+    last = unit;
+  }
+
+  /* more output than input, keep it with the latest unit */
+  return last;
+}
+
+/* move what is in order to ready; called with the lock */
+static void
+collect_units (GstOmxInstances * instances, GQueue * ready)
+{
+  GstOmxUnit *unit;
+  GstBuffer *buf;
+
+  while ((unit = g_queue_peek_head (&instances->units))) {
+    while ((buf = g_queue_pop_head (&unit->outputs)))
+      g_queue_push_tail (ready, buf);
+
+    if (!unit->closed || unit->received < unit->sent)
+      break;
+
+    g_queue_pop_head (&instances->units);
+    unit_free (unit);
+  }
+}
+
+/* push what is in order; called with the lock, which is dropped around the
+ * pushes. One thread pushes at a time, so the order holds, the others leave
+ * their outputs to it */
+static GstFlowReturn
+release_units (GstOmxInstances * instances)
+{
+  GQueue ready;
+  GstFlowReturn ret;
+  GstBuffer *buf;
+
+  if (instances->pushing)
+    return instances->last_return;
+
+  g_queue_init (&ready);
+  instances->pushing = TRUE;
+  while (TRUE) {
+    collect_units (instances, &ready);
+    if (g_queue_is_empty (&ready))
+      break;
+
+    ret = instances->last_return;
+    g_mutex_unlock (instances->lock);
+
+    while ((buf = g_queue_pop_head (&ready))) {
+      if (ret == GST_FLOW_OK)
+        ret = instances->push (instances->element, buf);
+      else
+        gst_buffer_unref (buf);
+    }
+
+    g_mutex_lock (instances->lock);
+    if (!instances->flushing)
+      instances->last_return = ret;
+  }
+  instances->pushing = FALSE;
+  g_cond_broadcast (instances->cond);
+
+  return instances->last_return;
+}
+
+static gpointer
+output_thread (gpointer data)
+{
+  GstOmxInstance *instance = data;
+  GstOmxInstances *instances = instance->instances;
+  OMX_BUFFERHEADERTYPE *omx_buffer;
+
+  while (TRUE) {
+    omx_buffer = g_omx_port_request_buffer (instance->out_port);
+
+    if (!omx_buffer) {
+      gboolean stopping;
+
+      g_mutex_lock (instances->lock);
+      while (instances->flushing && !instances->stopping)
+        g_cond_wait (instances->cond, instances->lock);
+      stopping = instances->stopping;
+      g_mutex_unlock (instances->lock);
+
+      if (stopping)
+        break;
+      continue;
+    }
+
+    if (omx_buffer->nFilledLen > 0 &&
+        !(omx_buffer->nFlags & OMX_BUFFERFLAG_CODECCONFIG)) {
+      GstBuffer *buf;
+
+      buf = gst_buffer_new_and_alloc (omx_buffer->nFilledLen);
+      memcpy (GST_BUFFER_DATA (buf), omx_buffer->pBuffer + omx_buffer->nOffset,
+          omx_buffer->nFilledLen);
+      if (instances->use_timestamps)
+        GST_BUFFER_TIMESTAMP (buf) =
+            gst_util_uint64_scale_int (omx_buffer->nTimeStamp, GST_SECOND,
+            OMX_TICKS_PER_SECOND);
+
+      instances->process (instances->element, buf, omx_buffer,
+          instance->index);
+    }
+
+    if (omx_buffer->nFlags & OMX_BUFFERFLAG_EOS) {
+      g_mutex_lock (instances->lock);
+      instance->eos = TRUE;
+      g_cond_broadcast (instances->cond);
+      g_mutex_unlock (instances->lock);
+      omx_buffer->nFlags &= ~OMX_BUFFERFLAG_EOS;
+    }
+
+    omx_buffer->nFilledLen = 0;
+    g_omx_port_release_buffer (instance->out_port, omx_buffer);
+  }
+
+  return NULL;
+}
+
+/*
+ *  description : instances around the component of an element
+ *  params      : @element: owner, @gomx, @in_port, @out_port: its component,
+ *                @n_instances: wanted in all, @unit_frames: frames per unit
+ *  return      : the instances, only the element's own one is open
+ *  comments    : process, fill, push and unit_start are set by the caller
+ */
+GstOmxInstances *
+gstomx_instances_new (gpointer element, GOmxCore * gomx, GOmxPort * in_port,
+    GOmxPort * out_port, guint n_instances, guint unit_frames)
+{
+  GstOmxInstances *instances;
+
+  instances = g_new0 (GstOmxInstances, 1);
+  instances->element = element;
+  instances->n_instances = 1;
+  instances->max_instances = MAX (n_instances, 1);
+  instances->instances = g_new0 (GstOmxInstance, instances->max_instances);
+  instances->instances[0].instances = instances;
+  instances->instances[0].gomx = gomx;
+  instances->instances[0].in_port = in_port;
+  instances->instances[0].out_port = out_port;
+  instances->unit_frames = MAX (unit_frames, 1);
+  instances->use_timestamps = TRUE;
+  instances->lock = g_mutex_new ();
+  instances->cond = g_cond_new ();
+  instances->process_lock = g_mutex_new ();
+  instances->last_return = GST_FLOW_OK;
+  g_queue_init (&instances->units);
+
+  return instances;
+}
+
+static void
+copy_port_definition (GOmxCore * from, GOmxCore * to, guint port_index)
+{
+  OMX_PARAM_PORTDEFINITIONTYPE param;
+
+  G_OMX_INIT_PARAM (param);
+
+  param.nPortIndex = port_index;
+  OMX_GetParameter (from->omx_handle, OMX_IndexParamPortDefinition, &param);
+  OMX_SetParameter (to->omx_handle, OMX_IndexParamPortDefinition, &param);
+}
+
+static void
+instance_close (GstOmxInstance * instance)
+{
+  g_omx_port_finish (instance->in_port);
+  g_omx_port_finish (instance->out_port);
+
+  if (instance->thread)
+    g_thread_join (instance->thread);
+  instance->thread = NULL;
+
+  g_omx_core_stop (instance->gomx);
+  g_omx_core_unload (instance->gomx);
+  g_omx_core_free (instance->gomx);
+  instance->gomx = NULL;
+}
+
+/*
+ *  description : open the other instances like the element's own one
+ *  params      : @instances: instances, @type: of the element,
+ *                @setup: applies the codec settings to a component
+ *  return      : the number of instances now open
+ *  comments    : called once the own component is set up in Loaded state;
+ *                fewer instances than asked for are used when the platform
+ *                has no more
+ */
+guint
+gstomx_instances_prepare (GstOmxInstances * instances, GType type,
+    void (*setup) (gpointer element, GOmxCore * gomx, GOmxPort * in_port,
+        GOmxPort * out_port))
+{
+  GstOmxInstance *own = &instances->instances[0];
+  guint i;
+
+  for (i = 1; i < instances->max_instances; i++) {
+    GstOmxInstance *instance = &instances->instances[i];
+
+    instance->instances = instances;
+    instance->index = i;
+    instance->gomx = gstomx_core_new (instances->element, type);
+
+    if (instance->gomx->omx_state != OMX_StateLoaded) {
+      GST_WARNING_OBJECT (instances->element, "instance %u not available", i);
+      g_omx_core_free (instance->gomx);
+      instance->gomx = NULL;
+      break;
+    }
+
+    /* extra instances take free slots only, a waiting session goes first */
+    instance->gomx->priority = own->gomx->priority;
+    instance->gomx->preemptible = own->gomx->preemptible;
+    instance->gomx->preempt_cb = own->gomx->preempt_cb;
+    instance->gomx->admission_timeout = 0;
+
+    instance->in_port = g_omx_core_new_port (instance->gomx,
+        own->in_port->port_index);
+    instance->out_port = g_omx_core_new_port (instance->gomx,
+        own->out_port->port_index);
+
+    if (setup)
+      setup (instances->element, instance->gomx, instance->in_port,
+          instance->out_port);
+
+    copy_port_definition (own->gomx, instance->gomx, own->in_port->port_index);
+    copy_port_definition (own->gomx, instance->gomx, own->out_port->port_index);
+
+    g_omx_port_setup (instance->in_port);
+    g_omx_port_setup (instance->out_port);
+    instance->in_port->omx_allocate = own->in_port->omx_allocate;
+    instance->out_port->omx_allocate = own->out_port->omx_allocate;
+
+    g_omx_core_prepare (instance->gomx);
+    if (instance->gomx->omx_state == OMX_StateIdle)
+      g_omx_core_start (instance->gomx);
+
+    if (instance->gomx->omx_state != OMX_StateExecuting) {
+      GST_WARNING_OBJECT (instances->element, "instance %u failed to start",
+          i);
+      instance_close (instance);
+      break;
+    }
+
+    instance->thread = g_thread_create (output_thread, instance, TRUE, NULL);
+    if (!instance->thread) {
+      instance_close (instance);
+      break;
+    }
+  }
+
+  instances->n_instances = i;
+  GST_INFO_OBJECT (instances->element, "coding with %u instances", i);
+
+  return i;
+}
+
+void
+gstomx_instances_free (GstOmxInstances * instances)
+{
+  GstOmxUnit *unit;
+  guint i;
+
+  g_mutex_lock (instances->lock);
+  instances->stopping = TRUE;
+  g_cond_broadcast (instances->cond);
+  g_mutex_unlock (instances->lock);
+
+  for (i = 1; i < instances->n_instances; i++)
+    instance_close (&instances->instances[i]);
+
+  while ((unit = g_queue_pop_head (&instances->units)))
+    unit_free (unit);
+
+  g_mutex_free (instances->process_lock);
+  g_cond_free (instances->cond);
+  g_mutex_free (instances->lock);
+  g_free (instances->instances);
+  g_free (instances);
+}
+
+/*
+ *  description : pick the instance for the next input frame
+ *  params      : @instances: instances
+ *  return      : index of the instance, 0 for the element's own
+ *  comments    : a new unit goes to the instance with the fewest frames in
+ *                flight, ties are broken round robin
+ */
+guint
+gstomx_instances_assign (GstOmxInstances * instances)
+{
+  GstOmxUnit *unit;
+  gboolean start = FALSE;
+  guint index;
+
+  g_mutex_lock (instances->lock);
+  unit = g_queue_peek_tail (&instances->units);
+
+  if (!unit || unit->closed) {
+    guint i, best = instances->next;
+
+    for (i = 0; i < instances->n_instances; i++) {
+      guint candidate = (instances->next + i) % instances->n_instances;
+
+      if (instances->instances[candidate].load <
+          instances->instances[best].load)
+        best = candidate;
+    }
+    instances->next = (best + 1) % instances->n_instances;
+
+    unit = g_slice_new0 (GstOmxUnit);
+    unit->index = best;
+    g_queue_init (&unit->outputs);
+    g_queue_push_tail (&instances->units, unit);
+    start = TRUE;
+  }
+
+  index = unit->index;
+  unit->sent++;
+  instances->instances[index].load++;
+  if (unit->sent >= instances->unit_frames)
+    unit->closed = TRUE;
+  g_mutex_unlock (instances->lock);
+
+  if (start && instances->unit_start) {
+    GstOmxInstance *instance = &instances->instances[index];
+
+    instances->unit_start (instances->element, instance->gomx,
+        instance->out_port->port_index);
+  }
+
+  return index;
+}
+
+/* send one input frame to another instance, consumes buf */
+GstFlowReturn
+gstomx_instances_send (GstOmxInstances * instances, guint index,
+    GstBuffer * buf)
+{
+  GstOmxInstance *instance = &instances->instances[index];
+  guint offset = 0;
+
+  while (offset < GST_BUFFER_SIZE (buf)) {
+    OMX_BUFFERHEADERTYPE *omx_buffer;
+
+    omx_buffer = g_omx_port_request_buffer (instance->in_port);
+    if (G_UNLIKELY (!omx_buffer)) {
+      gst_buffer_unref (buf);
+      return GST_FLOW_WRONG_STATE;
+    }
+
+    if (!instances->fill (instances->element, instance->in_port, omx_buffer,
+            buf, &offset)) {
+      g_omx_port_push_buffer (instance->in_port, omx_buffer);
+      gst_buffer_unref (buf);
+      return GST_FLOW_ERROR;
+    }
+
+    if (instances->use_timestamps)
+      omx_buffer->nTimeStamp =
+          gst_util_uint64_scale_int (GST_BUFFER_TIMESTAMP (buf),
+          OMX_TICKS_PER_SECOND, GST_SECOND);
+
+    if (offset >= GST_BUFFER_SIZE (buf))
+      omx_buffer->nFlags |= OMX_BUFFERFLAG_ENDOFFRAME;
+
+    g_omx_port_release_buffer (instance->in_port, omx_buffer);
+  }
+
+  gst_buffer_unref (buf);
+
+  return instances->last_return;
+}
+
+/* queue one processed output buffer of an instance, consumes buf */
+GstFlowReturn
+gstomx_instances_push (GstOmxInstances * instances, guint index,
+    GstBuffer * buf)
+{
+  GstOmxUnit *unit;
+  GstFlowReturn ret;
+
+  g_mutex_lock (instances->lock);
+  if (instances->flushing) {
+    g_mutex_unlock (instances->lock);
+    gst_buffer_unref (buf);
+    return GST_FLOW_WRONG_STATE;
+  }
+
+  unit = find_unit (instances, index);
+  if (!unit) {
+    /* nothing in flight, so nothing to wait for */
+    g_mutex_unlock (instances->lock);
+    return instances->push (instances->element, buf);
+  }
+
+  if (unit->received < unit->sent) {
+    unit->received++;
+    instances->instances[index].load--;
+  }
+  g_queue_push_tail (&unit->outputs, buf);
+
+  ret = release_units (instances);
+  g_mutex_unlock (instances->lock);
+
+  return ret;
+}
+
+/*
+ *  description : bring the other instances to the end of the stream
+ *  params      : @instances: instances
+ *  return      : none
+ *  comments    : called before the element's own component gets EOS, so
+ *                all other output is in once that one is back
+ */
+void
+gstomx_instances_drain (GstOmxInstances * instances)
+{
+  GstOmxUnit *unit;
+  guint i;
+
+  g_mutex_lock (instances->lock);
+  unit = g_queue_peek_tail (&instances->units);
+  if (unit)
+    unit->closed = TRUE;
+  g_mutex_unlock (instances->lock);
+
+  for (i = 1; i < instances->n_instances; i++) {
+    GstOmxInstance *instance = &instances->instances[i];
+    OMX_BUFFERHEADERTYPE *omx_buffer;
+
+    omx_buffer = g_omx_port_request_buffer (instance->in_port);
+    if (!omx_buffer)
+      continue;
+
+    omx_buffer->nFilledLen = 0;
+    omx_buffer->nFlags |= OMX_BUFFERFLAG_EOS;
+    g_omx_port_release_buffer (instance->in_port, omx_buffer);
+
+    g_mutex_lock (instances->lock);
+    while (!instance->eos && !instances->flushing && !instances->stopping)
+      g_cond_wait (instances->cond, instances->lock);
+    instance->eos = FALSE;
+    g_mutex_unlock (instances->lock);
+  }
+
+  g_mutex_lock (instances->lock);
+  release_units (instances);
+  g_mutex_unlock (instances->lock);
+}
+
+/* push everything left in unit order, at the end of the stream */
+GstFlowReturn
+gstomx_instances_finish (GstOmxInstances * instances)
+{
+  GstOmxUnit *unit;
+  GstFlowReturn ret;
+  GList *l;
+
+  g_mutex_lock (instances->lock);
+  for (l = instances->units.head; l; l = l->next) {
+    unit = l->data;
+    unit->closed = TRUE;
+    unit->received = unit->sent;
+  }
+
+  /* a pushing output thread takes the rest along */
+  while (instances->pushing)
+    g_cond_wait (instances->cond, instances->lock);
+  ret = release_units (instances);
+  g_mutex_unlock (instances->lock);
+
+  return ret;
+}
+
+void
+gstomx_instances_flush_start (GstOmxInstances * instances)
+{
+  GstOmxUnit *unit;
+  guint i;
+
+  g_mutex_lock (instances->lock);
+  instances->flushing = TRUE;
+  while ((unit = g_queue_pop_head (&instances->units)))
+    unit_free (unit);
+  g_cond_broadcast (instances->cond);
+
+  /* downstream is flushing, so a push under way returns soon */
+  while (instances->pushing)
+    g_cond_wait (instances->cond, instances->lock);
+  g_mutex_unlock (instances->lock);
+
+  for (i = 1; i < instances->n_instances; i++)
+    g_omx_core_flush_start (instances->instances[i].gomx);
+}
+
+void
+gstomx_instances_flush_stop (GstOmxInstances * instances)
+{
+  guint i;
+
+  for (i = 1; i < instances->n_instances; i++)
+    g_omx_core_flush_stop (instances->instances[i].gomx);
+
+  g_mutex_lock (instances->lock);
+  for (i = 0; i < instances->n_instances; i++) {
+    instances->instances[i].load = 0;
+    instances->instances[i].eos = FALSE;
+  }
+  instances->flushing = FALSE;
+  instances->last_return = GST_FLOW_OK;
+  g_cond_broadcast (instances->cond);
+  g_mutex_unlock (instances->lock);
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_INSTANCES_H
+#define GSTOMX_INSTANCES_H
+
+#include <gst/gst.h>
+#include "gstomx_util.h"
+
+G_BEGIN_DECLS
+
+/* modification: more component instances behind one element; input is cut
+ * into work units of independent frames, each unit is coded whole by one
+ * instance and the output is put back in unit order */
+typedef struct GstOmxInstance GstOmxInstance;
+typedef struct GstOmxInstances GstOmxInstances;
+
+/* process one output buffer of an instance the way the element does */
+typedef GstFlowReturn (*GstOmxInstancesProcess) (gpointer element,
+    GstBuffer * buf, OMX_BUFFERHEADERTYPE * omx_buffer, guint index);
+/* fill an input buffer of port from buf the way the element does, from
+ * offset on; advances offset and returns FALSE if buf can not be sent */
+typedef gboolean (*GstOmxInstancesFill) (gpointer element, GOmxPort * port,
+    OMX_BUFFERHEADERTYPE * omx_buffer, GstBuffer * buf, guint * offset);
+/* push one output buffer downstream, in order */
+typedef GstFlowReturn (*GstOmxInstancesPush) (gpointer element,
+    GstBuffer * buf);
+/* make the next frame sent to gomx start an independent unit */
+typedef void (*GstOmxInstancesUnitStart) (gpointer element, GOmxCore * gomx,
+    guint port_index);
+
+struct GstOmxInstance
+{
+  GstOmxInstances *instances;
+  GOmxCore *gomx;
+  GOmxPort *in_port;
+  GOmxPort *out_port;
+  GThread *thread;            /* output thread, NULL for the element's own */
+  guint index;
+  guint load;                 /* frames sent and not yet out */
+  gboolean eos;
+};
+
+struct GstOmxInstances
+{
+  gpointer element;
+  GstOmxInstancesProcess process;
+  GstOmxInstancesFill fill;
+  GstOmxInstancesPush push;
+  GstOmxInstancesUnitStart unit_start;
+
+  guint n_instances;           /* open */
+  guint max_instances;
+  GstOmxInstance *instances;  /* the first one is the element's own */
+  guint unit_frames;
+  gboolean use_timestamps;
+
+  GMutex *lock;
+  GCond *cond;
+  GQueue units;               /* not pushed completely, oldest first */
+  guint next;                 /* where ties in load start */
+  gboolean flushing;
+  gboolean stopping;
+  gboolean pushing;           /* a thread pushes released outputs */
+  GstFlowReturn last_return;
+
+  GMutex *process_lock;       /* around the processing of any output */
+};
+
+GstOmxInstances *gstomx_instances_new (gpointer element, GOmxCore * gomx,
+    GOmxPort * in_port, GOmxPort * out_port, guint n_instances,
+    guint unit_frames);
+guint gstomx_instances_prepare (GstOmxInstances * instances, GType type,
+    void (*setup) (gpointer element, GOmxCore * gomx, GOmxPort * in_port,
+        GOmxPort * out_port));
+void gstomx_instances_free (GstOmxInstances * instances);
+
+guint gstomx_instances_assign (GstOmxInstances * instances);
+GstFlowReturn gstomx_instances_send (GstOmxInstances * instances,
+    guint index, GstBuffer * buf);
+GstFlowReturn gstomx_instances_push (GstOmxInstances * instances,
+    guint index, GstBuffer * buf);
+void gstomx_instances_drain (GstOmxInstances * instances);
+GstFlowReturn gstomx_instances_finish (GstOmxInstances * instances);
+void gstomx_instances_flush_start (GstOmxInstances * instances);
+void gstomx_instances_flush_stop (GstOmxInstances * instances);
+
+G_END_DECLS
+#endif /* GSTOMX_INSTANCES_H */
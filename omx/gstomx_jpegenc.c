@@ -94,12 +94,20 @@ get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
   }
 }
 
+/* modification: every picture is a unit of its own already */
+static void
+unit_start (GstOmxBaseFilter * omx_base, GOmxCore * gomx, guint port_index)
+{
+}
+
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
   GObjectClass *gobject_class;
+  GstOmxBaseFilterClass *basefilter_class;
 
   gobject_class = G_OBJECT_CLASS (g_class);
+  basefilter_class = GST_OMX_BASE_FILTER_CLASS (g_class);
 
   /* Properties stuff */
   {
@@ -112,6 +120,8 @@ type_class_init (gpointer g_class, gpointer class_data)
             0, 100, DEFAULT_QUALITY,
             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
   }
+
+  basefilter_class->unit_start = unit_start;
 }
 
 static void
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+/* for the F_SEAL_* flags */
+#define _GNU_SOURCE
+
+#include "gstomx_memfd.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+static gint
+memfd_open (const gchar * name)
+{
+#ifdef __NR_memfd_create
+  return syscall (__NR_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+/*
+ *  description : allocate shareable memory
+ *  params      : @name: shown in /proc/<pid>/fd, @size: bytes,
+ *                @data: where the memory is mapped in this process
+ *  return      : the fd, -1 when the kernel has no memfd
+ *  comments    : the memory stays writable, only its size is sealed
+ */
+gint
+gstomx_memfd_alloc (const gchar * name, gsize size, gpointer * data)
+{
+  gint fd;
+
+  fd = memfd_open (name);
+  if (fd < 0)
+    return -1;
+
+  if (ftruncate (fd, size) < 0)
+    goto fail;
+
+#ifdef F_ADD_SEALS
+  fcntl (fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+#endif
+
+  *data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (*data == MAP_FAILED)
+    goto fail;
+
+  return fd;
+
+fail:
+  close (fd);
+  *data = NULL;
+  return -1;
+}
+
+void
+gstomx_memfd_free (gint fd, gpointer data, gsize size)
+{
+  munmap (data, size);
+  close (fd);
+}
@@ -0,0 +1,33 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_MEMFD_H
+#define GSTOMX_MEMFD_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* modification: memory another process can map from the fd alone; the size
+ * is sealed so the mapping can never be cut short under it */
+gint gstomx_memfd_alloc (const gchar * name, gsize size, gpointer * data);
+void gstomx_memfd_free (gint fd, gpointer data, gsize size);
+
+G_END_DECLS
+#endif /* GSTOMX_MEMFD_H */
@@ -0,0 +1,399 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gstomx_mmapsrc.h"
+#include "gstomx_util.h"
+#include "gstomx.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*
+ * The file is mapped in chunks so that large files fit in the address space.
+ * Every buffer holds a reference on the chunk it points into, and the chunk
+ * is unmapped when the last of them is gone, which for a shared input port
+ * is when the component returns it.
+ */
+
+/* bytes mapped at once, a multiple of the page size */
+#define GSTOMX_MMAP_CHUNK_SIZE (4 * 1024 * 1024)
+
+enum
+{
+  ARG_0,
+  ARG_LOCATION,
+};
+
+struct GstOmxMmapChunk
+{
+  volatile gint refcount;
+  guint8 *data;
+  gsize size;
+  guint64 offset;             /* in the file */
+};
+
+typedef struct
+{
+  GstBuffer buffer;
+
+  GstOmxMmapChunk *chunk;
+} GstOmxMmapBuffer;
+
+static GstMiniObjectClass *mmap_buffer_parent_class = NULL;
+
+GSTOMX_BOILERPLATE (GstOmxMmapSrc, gst_omx_mmapsrc, GstBaseSrc,
+    GST_TYPE_BASE_SRC);
+
+static void
+chunk_unref (GstOmxMmapChunk * chunk)
+{
+  if (!g_atomic_int_dec_and_test (&chunk->refcount))
+    return;
+
+  munmap (chunk->data, chunk->size);
+  g_free (chunk);
+}
+
+static void
+mmap_buffer_finalize (GstOmxMmapBuffer * buf)
+{
+  chunk_unref (buf->chunk);
+
+  mmap_buffer_parent_class->finalize (GST_MINI_OBJECT_CAST (buf));
+}
+
+static void
+mmap_buffer_class_init (gpointer g_class, gpointer class_data)
+{
+  GstMiniObjectClass *mini_object_class = GST_MINI_OBJECT_CLASS (g_class);
+
+  mmap_buffer_parent_class = g_type_class_peek_parent (g_class);
+  mini_object_class->finalize = (GstMiniObjectFinalizeFunction)
+      mmap_buffer_finalize;
+}
+
+static GType
+mmap_buffer_get_type (void)
+{
+  static GType type = 0;
+
+  if (G_UNLIKELY (type == 0)) {
+    static const GTypeInfo info = {
+      sizeof (GstBufferClass),
+      NULL,
+      NULL,
+      mmap_buffer_class_init,
+      NULL,
+      NULL,
+      sizeof (GstOmxMmapBuffer),
+      0,
+      NULL,
+      NULL
+    };
+
+    type = g_type_register_static (GST_TYPE_BUFFER, "GstOmxMmapBuffer",
+        &info, 0);
+  }
+
+  return type;
+}
+
+/*
+ *  description : map the chunk of the file holding an offset
+ *  params      : @self: mmapsrc, @offset: byte in the file
+ *  return      : the chunk with one reference, NULL on error
+ *  comments    : the mapping is private and writable, so a buffer written to
+ *                in place gets its own copy of the page rather than a fault;
+ *                the kernel is asked to read the following chunk ahead
+ */
+static GstOmxMmapChunk *
+chunk_map (GstOmxMmapSrc * self, guint64 offset)
+{
+  GstOmxMmapChunk *chunk;
+  guint64 start, next;
+  gsize size;
+  gpointer data;
+
+  start = offset - offset % GSTOMX_MMAP_CHUNK_SIZE;
+  size = MIN (GSTOMX_MMAP_CHUNK_SIZE, self->size - start);
+
+  data = mmap (NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, self->fd,
+      start);
+  if (data == MAP_FAILED) {
+    GST_ELEMENT_ERROR (self, RESOURCE, READ, (NULL),
+        ("mmap of %" G_GSIZE_FORMAT " bytes at %" G_GUINT64_FORMAT
+            " failed: %s", size, start, g_strerror (errno)));
+    return NULL;
+  }
+
+  madvise (data, size, MADV_SEQUENTIAL);
+  madvise (data, size, MADV_WILLNEED);
+
+  next = start + size;
+  if (next < self->size)
+    posix_fadvise (self->fd, next, MIN (GSTOMX_MMAP_CHUNK_SIZE,
+            self->size - next), POSIX_FADV_WILLNEED);
+
+  GST_LOG_OBJECT (self, "mapped %" G_GSIZE_FORMAT " bytes at %"
+      G_GUINT64_FORMAT, size, start);
+
+  chunk = g_new (GstOmxMmapChunk, 1);
+  chunk->refcount = 1;
+  chunk->data = data;
+  chunk->size = size;
+  chunk->offset = start;
+
+  return chunk;
+}
+
+static GstFlowReturn
+create (GstBaseSrc * gst_src, guint64 offset, guint length, GstBuffer ** ret)
+{
+  GstOmxMmapSrc *self;
+  GstOmxMmapChunk *chunk;
+  GstOmxMmapBuffer *buf;
+  guint64 end;
+
+  self = GST_OMX_MMAPSRC (gst_src);
+
+  if (offset >= self->size)
+    return GST_FLOW_UNEXPECTED;
+
+  chunk = self->chunk;
+  if (!chunk || offset < chunk->offset ||
+      offset >= chunk->offset + chunk->size) {
+    chunk = chunk_map (self, offset);
+    if (!chunk)
+      return GST_FLOW_ERROR;
+
+    if (self->chunk)
+      chunk_unref (self->chunk);
+    self->chunk = chunk;
+  }
+
+  /* buffers end with their chunk, the next one starts a new mapping */
+  end = MIN (offset + length, chunk->offset + chunk->size);
+
+  buf = (GstOmxMmapBuffer *) gst_mini_object_new (mmap_buffer_get_type ());
+  g_atomic_int_inc (&chunk->refcount);
+  buf->chunk = chunk;
+
+  GST_BUFFER_DATA (buf) = chunk->data + (offset - chunk->offset);
+  GST_BUFFER_SIZE (buf) = end - offset;
+  GST_BUFFER_OFFSET (buf) = offset;
+  GST_BUFFER_OFFSET_END (buf) = end;
+
+  *ret = GST_BUFFER_CAST (buf);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+start (GstBaseSrc * gst_src)
+{
+  GstOmxMmapSrc *self;
+  struct stat st;
+
+  self = GST_OMX_MMAPSRC (gst_src);
+
+  if (!self->location) {
+    GST_ELEMENT_ERROR (self, RESOURCE, NOT_FOUND, (NULL),
+        ("no file name given"));
+    return FALSE;
+  }
+
+  self->fd = open (self->location, O_RDONLY);
+  if (self->fd < 0) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
+        ("could not open %s: %s", self->location, g_strerror (errno)));
+    return FALSE;
+  }
+
+  if (fstat (self->fd, &st) < 0 || !S_ISREG (st.st_mode)) {
+    GST_ELEMENT_ERROR (self, RESOURCE, OPEN_READ, (NULL),
+        ("%s is not a regular file", self->location));
+    close (self->fd);
+    self->fd = -1;
+    return FALSE;
+  }
+
+  self->size = st.st_size;
+  posix_fadvise (self->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  GST_INFO_OBJECT (self, "%s: %" G_GUINT64_FORMAT " bytes", self->location,
+      self->size);
+
+  return TRUE;
+}
+
+/* buffers still out keep their chunks mapped after the file is closed */
+static gboolean
+stop (GstBaseSrc * gst_src)
+{
+  GstOmxMmapSrc *self;
+
+  self = GST_OMX_MMAPSRC (gst_src);
+
+  if (self->chunk) {
+    chunk_unref (self->chunk);
+    self->chunk = NULL;
+  }
+
+  if (self->fd >= 0) {
+    close (self->fd);
+    self->fd = -1;
+  }
+
+  return TRUE;
+}
+
+static gboolean
+get_size (GstBaseSrc * gst_src, guint64 * size)
+{
+  GstOmxMmapSrc *self;
+
+  self = GST_OMX_MMAPSRC (gst_src);
+
+  if (self->fd < 0)
+    return FALSE;
+
+  *size = self->size;
+
+  return TRUE;
+}
+
+static gboolean
+is_seekable (GstBaseSrc * gst_src)
+{
+  return TRUE;
+}
+
+static void
+set_property (GObject * obj,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstOmxMmapSrc *self;
+
+  self = GST_OMX_MMAPSRC (obj);
+
+  switch (prop_id) {
+    case ARG_LOCATION:
+      g_free (self->location);
+      self->location = g_value_dup_string (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstOmxMmapSrc *self;
+
+  self = GST_OMX_MMAPSRC (obj);
+
+  switch (prop_id) {
+    case ARG_LOCATION:
+      g_value_set_string (value, self->location);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+finalize (GObject * obj)
+{
+  GstOmxMmapSrc *self;
+
+  self = GST_OMX_MMAPSRC (obj);
+
+  g_free (self->location);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+type_base_init (gpointer g_class)
+{
+  GstElementClass *element_class;
+
+  element_class = GST_ELEMENT_CLASS (g_class);
+
+  gst_element_class_set_details_simple (element_class,
+      "OpenMAX IL mmap file source",
+      "Source/File",
+      "Reads a local file through a memory mapping without copying",
+      "Samsung Electronics Co., Ltd.");
+
+  gst_element_class_add_pad_template (element_class,
+      gst_pad_template_new ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+          gst_caps_new_any ()));
+}
+
+static void
+type_class_init (gpointer g_class, gpointer class_data)
+{
+  GstBaseSrcClass *gst_base_src_class;
+  GObjectClass *gobject_class;
+
+  gst_base_src_class = GST_BASE_SRC_CLASS (g_class);
+  gobject_class = G_OBJECT_CLASS (g_class);
+
+  gobject_class->finalize = finalize;
+
+  gst_base_src_class->start = start;
+  gst_base_src_class->stop = stop;
+  gst_base_src_class->get_size = get_size;
+  gst_base_src_class->is_seekable = is_seekable;
+  gst_base_src_class->create = create;
+
+  /* Properties stuff */
+  {
+    gobject_class->set_property = set_property;
+    gobject_class->get_property = get_property;
+
+    g_object_class_install_property (gobject_class, ARG_LOCATION,
+        g_param_spec_string ("location", "File location",
+            "The local file to read",
+            NULL, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  }
+}
+
+/* mmap_buffer_get_type () is called here so the type is registered from the
+ * thread creating elements rather than from a streaming thread */
+static void
+type_instance_init (GTypeInstance * instance, gpointer g_class)
+{
+  GstOmxMmapSrc *self;
+
+  self = GST_OMX_MMAPSRC (instance);
+
+  mmap_buffer_get_type ();
+
+  self->fd = -1;
+  self->chunk = NULL;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_MMAPSRC_H
+#define GSTOMX_MMAPSRC_H
+
+#include <gst/gst.h>
+#include <gst/base/gstbasesrc.h>
+
+G_BEGIN_DECLS
+#define GST_OMX_MMAPSRC(obj) (GstOmxMmapSrc *) (obj)
+#define GST_OMX_MMAPSRC_TYPE (gst_omx_mmapsrc_get_type ())
+typedef struct GstOmxMmapSrc GstOmxMmapSrc;
+typedef struct GstOmxMmapSrcClass GstOmxMmapSrcClass;
+typedef struct GstOmxMmapChunk GstOmxMmapChunk;
+
+/* modification: buffers of a local file backed by its page cache, so an
+ * input port in shared mode hands the pages to the component uncopied */
+struct GstOmxMmapSrc
+{
+  GstBaseSrc element;
+
+  gchar *location;
+  gint fd;
+  guint64 size;
+
+  GstOmxMmapChunk *chunk;     /* mapping the last buffer came from */
+};
+
+struct GstOmxMmapSrcClass
+{
+  GstBaseSrcClass parent_class;
+};
+
+GType gst_omx_mmapsrc_get_type (void);
+
+G_END_DECLS
+#endif /* GSTOMX_MMAPSRC_H */
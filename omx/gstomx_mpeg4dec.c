@@ -117,6 +117,48 @@ error_exit:
   return FALSE;
 }
 
+/*
+ *  description : find the start of the next picture in an elementary stream
+ *  params      : @omx_base : base filter, @data, @size: stream data, @from: first position to check
+ *  return      : offset of the start code beginning the next picture, -1 if none
+ *  comments    : a picture ends at the next VOP, or at the next VOS/VO/VOL/GOV
+ *                header or user data preceding one; DRM input is already
+ *                decrypted by process_input_buf at this point
+ */
+static gint
+find_frame_start (GstOmxBaseFilter * omx_base, const guint8 * data, guint size,
+    guint from)
+{
+  guint pos = from;
+  guint limit;
+
+  if (size < GSTOMX_FRAME_LOOKAHEAD)
+    return -1;
+
+  limit = size - GSTOMX_FRAME_LOOKAHEAD + 1;
+
+  while ((pos = gstomx_video_find_zero_pair (data, limit, pos)) < limit) {
+    if (data[pos + 2] == 0x01) {
+      guint8 code = data[pos + 3];
+
+      if (code == GSTOMX_MPEG4_VOP_START_CODE) {
+        if (omx_base->frame_has_picture)
+          return pos;
+        omx_base->frame_has_picture = TRUE;
+      } else if (code != GSTOMX_MPEG4_VOS_END_CODE &&
+          omx_base->frame_has_picture) {
+        omx_base->frame_has_picture = FALSE;
+        return pos;
+      }
+      pos += 3;
+    } else {
+      pos++;
+    }
+  }
+
+  return -1;
+}
+
 static void
 process_input_buf (GstOmxBaseFilter * omx_base_filter, GstBuffer **buf)
 {
@@ -287,6 +329,7 @@ type_class_init (gpointer g_class, gpointer class_data)
 
   gobject_class->finalize = finalize;
   basefilter_class->process_input_buf = process_input_buf;
+  basefilter_class->find_frame_start = find_frame_start;
 }
 
 static void
@@ -38,6 +38,10 @@ typedef struct GstOmxMpeg4DecClass GstOmxMpeg4DecClass;
 
 #define DIVX_SDK_PLUGIN_NAME "libmm_divxsdk.so"
 
+/* start code values following the 00 00 01 prefix */
+#define GSTOMX_MPEG4_VOS_END_CODE 0xB1
+#define GSTOMX_MPEG4_VOP_START_CODE 0xB6
+
 typedef enum drmErrorCodes
 {
   DRM_SUCCESS = 0,
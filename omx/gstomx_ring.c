@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gstomx_ring.h"
+
+#include <string.h>             /* for memcpy */
+
+/* a block is ours alone when no sub-buffer holds a reference to it */
+#define BLOCK_IS_FREE(block) (GST_MINI_OBJECT_REFCOUNT_VALUE (block) == 1)
+
+void
+gstomx_ring_init (GstOmxRing * ring, guint capacity)
+{
+  memset (ring, 0, sizeof (GstOmxRing));
+  ring->capacity = capacity;
+  ring->timestamp = GST_CLOCK_TIME_NONE;
+}
+
+void
+gstomx_ring_free (GstOmxRing * ring)
+{
+  gst_buffer_replace (&ring->block, NULL);
+  gst_buffer_replace (&ring->spare, NULL);
+  ring->start = ring->end = 0;
+}
+
+/* the pending bytes, contiguous */
+guint8 *
+gstomx_ring_peek (GstOmxRing * ring)
+{
+  return ring->block ? GST_BUFFER_DATA (ring->block) + ring->start : NULL;
+}
+
+/* drop the pending bytes */
+void
+gstomx_ring_clear (GstOmxRing * ring)
+{
+  ring->start = ring->end;
+  ring->timestamp = GST_CLOCK_TIME_NONE;
+  ring->duration = 0;
+}
+
+/*
+ *  description : make room for size more bytes behind the pending ones
+ *  params      : @ring: ring, @size: bytes about to be pushed
+ *  return      : none
+ *  comments    : the pending bytes are moved to the front of a free block,
+ *                which is the current one, the spare one or a new one
+ */
+static void
+ring_make_room (GstOmxRing * ring, guint size)
+{
+  guint pending = gstomx_ring_available (ring);
+  guint needed = pending + size;
+  GstBuffer *block;
+
+  if (ring->block && ring->end + size <= GST_BUFFER_SIZE (ring->block))
+    return;
+
+  if (ring->block && BLOCK_IS_FREE (ring->block) &&
+      needed <= GST_BUFFER_SIZE (ring->block)) {
+    memmove (GST_BUFFER_DATA (ring->block),
+        GST_BUFFER_DATA (ring->block) + ring->start, pending);
+    ring->start = 0;
+    ring->end = pending;
+    return;
+  }
+
+  if (ring->spare && BLOCK_IS_FREE (ring->spare) &&
+      needed <= GST_BUFFER_SIZE (ring->spare)) {
+    block = ring->spare;
+    ring->spare = NULL;
+  } else {
+    block = gst_buffer_new_and_alloc (MAX (ring->capacity, needed));
+  }
+
+  if (pending)
+    memcpy (GST_BUFFER_DATA (block),
+        GST_BUFFER_DATA (ring->block) + ring->start, pending);
+
+  /* the old block stays alive while its regions are with the component */
+  gst_buffer_replace (&ring->spare, ring->block);
+  gst_buffer_replace (&ring->block, NULL);
+  ring->block = block;
+  ring->start = 0;
+  ring->end = pending;
+}
+
+/* append the data of buf, which is unreffed */
+void
+gstomx_ring_push (GstOmxRing * ring, GstBuffer * buf)
+{
+  ring_make_room (ring, GST_BUFFER_SIZE (buf));
+
+  memcpy (GST_BUFFER_DATA (ring->block) + ring->end, GST_BUFFER_DATA (buf),
+      GST_BUFFER_SIZE (buf));
+  ring->end += GST_BUFFER_SIZE (buf);
+
+  if (!GST_CLOCK_TIME_IS_VALID (ring->timestamp))
+    ring->timestamp = GST_BUFFER_TIMESTAMP (buf);
+  if (GST_BUFFER_DURATION_IS_VALID (buf))
+    ring->duration += GST_BUFFER_DURATION (buf);
+
+  gst_buffer_unref (buf);
+}
+
+/* lend all pending bytes as one buffer, valid until it is unreffed */
+GstBuffer *
+gstomx_ring_take (GstOmxRing * ring)
+{
+  GstBuffer *region;
+
+  region = gst_buffer_create_sub (ring->block, ring->start,
+      gstomx_ring_available (ring));
+  GST_BUFFER_TIMESTAMP (region) = ring->timestamp;
+  GST_BUFFER_DURATION (region) = ring->duration;
+
+  ring->start = ring->end;
+  ring->timestamp = GST_CLOCK_TIME_NONE;
+  ring->duration = 0;
+
+  return region;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_RING_H
+#define GSTOMX_RING_H
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* modification: contiguous accumulator for small input buffers. Pending
+ * bytes are always contiguous and are lent out as sub-buffers of the block
+ * holding them, so a block is rewound only once nothing lent from it is
+ * alive. */
+typedef struct GstOmxRing GstOmxRing;
+
+struct GstOmxRing
+{
+  GstBuffer *block;           /* holds the pending bytes */
+  GstBuffer *spare;           /* previous block, reused when released */
+  guint capacity;             /* bytes of a new block */
+  guint start;                /* first pending byte */
+  guint end;                  /* one past the last pending byte */
+  GstClockTime timestamp;     /* of the first pending buffer with one */
+  GstClockTime duration;      /* sum of the pending buffer durations */
+};
+
+#define gstomx_ring_available(ring) ((ring)->end - (ring)->start)
+
+void gstomx_ring_init (GstOmxRing * ring, guint capacity);
+void gstomx_ring_free (GstOmxRing * ring);
+void gstomx_ring_clear (GstOmxRing * ring);
+guint8 *gstomx_ring_peek (GstOmxRing * ring);
+void gstomx_ring_push (GstOmxRing * ring, GstBuffer * buf);
+GstBuffer *gstomx_ring_take (GstOmxRing * ring);
+
+G_END_DECLS
+#endif /* GSTOMX_RING_H */
@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gstomx_tiled.h"
+
+#include <string.h>             /* for memcpy */
+
+/* the chroma plane starts on an 8 KiB boundary (MFC buffer layout) */
+#define GSTOMX_TILED_PLANE_ALIGN 8192
+
+/*
+ *  description : position of a tile in memory
+ *  params      : @x, @y: tile column and row, @x_tiles, @y_tiles: tiles in the plane
+ *  return      : index of the tile
+ *  comments    : each 2x2 group of tiles is stored in Z order when its column pair
+ *                is even and in flipped Z order when odd; with an odd number of
+ *                rows the last one is stored linearly
+ */
+static inline guint
+tile_index (guint x, guint y, guint x_tiles, guint y_tiles)
+{
+  guint index = (y & ~1) * x_tiles + x;
+
+  if (y & 1)
+    index += (x & ~3) + 2;
+  else if (!(y_tiles & 1) || y != y_tiles - 1)
+    index += (x + 2) & ~3;
+
+  return index;
+}
+
+static inline gsize
+plane_size (guint width, guint height)
+{
+  return (GST_ROUND_UP_128 (width) / GSTOMX_TILE_WIDTH) *
+      (GST_ROUND_UP_32 (height) / GSTOMX_TILE_HEIGHT) * GSTOMX_TILE_SIZE;
+}
+
+static inline gsize
+chroma_offset (guint width, guint height)
+{
+  return (plane_size (width, height) + GSTOMX_TILED_PLANE_ALIGN - 1) &
+      ~(gsize) (GSTOMX_TILED_PLANE_ALIGN - 1);
+}
+
+static void
+detile_plane (guint8 * dst, guint stride, const guint8 * src,
+    guint width, guint height)
+{
+  guint x_tiles, y_tiles;
+  guint tx, ty, row;
+
+  x_tiles = GST_ROUND_UP_128 (width) / GSTOMX_TILE_WIDTH;
+  y_tiles = GST_ROUND_UP_32 (height) / GSTOMX_TILE_HEIGHT;
+
+  for (ty = 0; ty < y_tiles; ty++) {
+    guint rows = MIN (GSTOMX_TILE_HEIGHT, height - ty * GSTOMX_TILE_HEIGHT);
+    guint8 *line = dst + ty * GSTOMX_TILE_HEIGHT * stride;
+
+    for (tx = 0; tx * GSTOMX_TILE_WIDTH < width; tx++) {
+      const guint8 *tile;
+      guint8 *out = line + tx * GSTOMX_TILE_WIDTH;
+      guint cols = MIN (GSTOMX_TILE_WIDTH, width - tx * GSTOMX_TILE_WIDTH);
+
+      tile = src + tile_index (tx, ty, x_tiles, y_tiles) * GSTOMX_TILE_SIZE;
+
+      /* the last tile of a row may be cut by the width */
+      if (cols == GSTOMX_TILE_WIDTH) {
+        for (row = 0; row < rows; row++) {
+          memcpy (out, tile, GSTOMX_TILE_WIDTH);
+          out += stride;
+          tile += GSTOMX_TILE_WIDTH;
+        }
+      } else {
+        for (row = 0; row < rows; row++) {
+          memcpy (out, tile, cols);
+          out += stride;
+          tile += GSTOMX_TILE_WIDTH;
+        }
+      }
+    }
+  }
+}
+
+/* bytes of a tiled frame as written by the component */
+gsize
+gstomx_nv12t_size (guint width, guint height)
+{
+  return chroma_offset (width, height) +
+      plane_size (GST_ROUND_UP_2 (width), (height + 1) / 2);
+}
+
+/* bytes of a linear NV12 frame as laid out by video/x-raw-yuv caps */
+gsize
+gstomx_nv12_size (guint width, guint height)
+{
+  return GST_ROUND_UP_4 (width) * GST_ROUND_UP_2 (height) * 3 / 2;
+}
+
+/* convert a tiled frame of gstomx_nv12t_size () bytes to linear NV12 of
+ * gstomx_nv12_size () bytes; every byte is read and written once */
+void
+gstomx_nv12t_to_nv12 (guint8 * dst, const guint8 * src, guint width,
+    guint height)
+{
+  guint stride = GST_ROUND_UP_4 (width);
+
+  detile_plane (dst, stride, src, width, height);
+  detile_plane (dst + stride * GST_ROUND_UP_2 (height), stride,
+      src + chroma_offset (width, height),
+      GST_ROUND_UP_2 (width), (height + 1) / 2);
+}
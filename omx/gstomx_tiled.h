@@ -0,0 +1,39 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_TILED_H
+#define GSTOMX_TILED_H
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+/* modification: OMX_EXT_COLOR_FormatNV12Tiled is NV12 stored in 64x32 tiles,
+ * grouped by 2x2 in Z / flipped Z order */
+#define GSTOMX_TILE_WIDTH 64
+#define GSTOMX_TILE_HEIGHT 32
+#define GSTOMX_TILE_SIZE (GSTOMX_TILE_WIDTH * GSTOMX_TILE_HEIGHT)
+
+gsize gstomx_nv12t_size (guint width, guint height);
+gsize gstomx_nv12_size (guint width, guint height);
+void gstomx_nv12t_to_nv12 (guint8 * dst, const guint8 * src,
+    guint width, guint height);
+
+G_END_DECLS
+#endif /* GSTOMX_TILED_H */
@@ -0,0 +1,571 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include "gstomx_transcode.h"
+#include "gstomx_base_filter.h"
+#include "gstomx_util.h"
+#include "gstomx.h"
+
+/*
+ * The decoder writes its frames into buffers that are pushed to the encoder,
+ * and with the encoder input port in shared mode they are handed to the
+ * encoder component as they are. A frame is copied only when a bridge needs
+ * it: tiled decoder output is detiled by the decoder, a layout the encoder
+ * component does not take is converted by the encoder and a scaled size
+ * comes out of videoscale.
+ *
+ * The encoder cannot change its resolution once running, so on new caps it
+ * is drained and replaced by a new one with the same properties.
+ */
+
+/* how long a replaced encoder may take to push its last frames */
+#define GSTOMX_TRANSCODE_DRAIN_TIMEOUT (5 * G_USEC_PER_SEC)
+
+#define DEFAULT_DECODER "omx_h264dec"
+#define DEFAULT_ENCODER "omx_h264enc"
+
+enum
+{
+  ARG_0,
+  ARG_DECODER,
+  ARG_ENCODER,
+  ARG_WIDTH,
+  ARG_HEIGHT,
+  ARG_DECODER_ELEMENT,
+  ARG_ENCODER_ELEMENT,
+};
+
+GSTOMX_BOILERPLATE (GstOmxTranscode, gst_omx_transcode, GstBin, GST_TYPE_BIN);
+
+/* elements other than omx filters just copy as usual */
+static void
+set_shared (GstElement * element, gboolean input, gboolean output)
+{
+  GstOmxBaseFilter *omx_base;
+
+  if (!G_TYPE_CHECK_INSTANCE_TYPE (element, GST_OMX_BASE_FILTER_TYPE))
+    return;
+
+  omx_base = GST_OMX_BASE_FILTER (element);
+  omx_base->share_input = input;
+  omx_base->share_output = output;
+}
+
+static void
+copy_properties (GstElement * from, GstElement * to)
+{
+  GParamSpec **specs;
+  guint n_specs;
+  guint i;
+
+  specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (from), &n_specs);
+
+  for (i = 0; i < n_specs; i++) {
+    GValue value = { 0, };
+
+    /* name and parent belong to the bin */
+    if ((specs[i]->flags & G_PARAM_READWRITE) != G_PARAM_READWRITE ||
+        (specs[i]->flags & G_PARAM_CONSTRUCT_ONLY) ||
+        specs[i]->owner_type == GST_TYPE_OBJECT)
+      continue;
+
+    g_value_init (&value, specs[i]->value_type);
+    g_object_get_property (G_OBJECT (from), specs[i]->name, &value);
+    g_object_set_property (G_OBJECT (to), specs[i]->name, &value);
+    g_value_unset (&value);
+  }
+
+  g_free (specs);
+}
+
+/* the EOS draining a replaced encoder stays in the bin */
+static gboolean
+encoder_event_probe (GstPad * pad, GstEvent * event, gpointer data)
+{
+  GstOmxTranscode *self = data;
+  gboolean pass = TRUE;
+
+  if (GST_EVENT_TYPE (event) != GST_EVENT_EOS)
+    return TRUE;
+
+  g_mutex_lock (self->lock);
+  if (self->draining) {
+    self->drained = TRUE;
+    g_cond_broadcast (self->cond);
+    pass = FALSE;
+  }
+  g_mutex_unlock (self->lock);
+
+  return pass;
+}
+
+static GstElement *
+encoder_new (GstOmxTranscode * self, GstElement * settings)
+{
+  GstElement *encoder;
+  GstPad *pad;
+
+  encoder = gst_element_factory_make (self->encoder_name, NULL);
+  if (!encoder)
+    return NULL;
+
+  if (settings)
+    copy_properties (settings, encoder);
+  set_shared (encoder, TRUE, FALSE);
+
+  pad = gst_element_get_static_pad (encoder, "src");
+  gst_pad_add_event_probe (pad, G_CALLBACK (encoder_event_probe), self);
+  gst_object_unref (pad);
+
+  return encoder;
+}
+
+/*
+ *  description : put a new encoder in place of the running one
+ *  params      : @self: transcoder
+ *  return      : FALSE if no new encoder could be made, the old one stays
+ *  comments    : called from the streaming thread feeding the encoder, so
+ *                no data arrives while the old encoder pushes its last frames
+ */
+static gboolean
+encoder_replace (GstOmxTranscode * self)
+{
+  GstElement *old;
+  GstElement *encoder;
+  GstPad *pad;
+  GTimeVal deadline;
+
+  old = self->encoder;
+  encoder = encoder_new (self, old);
+  if (!encoder)
+    return FALSE;
+
+  g_mutex_lock (self->lock);
+  self->draining = TRUE;
+  self->drained = FALSE;
+  g_mutex_unlock (self->lock);
+
+  pad = gst_element_get_static_pad (old, "sink");
+  gst_pad_send_event (pad, gst_event_new_eos ());
+  gst_object_unref (pad);
+
+  g_get_current_time (&deadline);
+  g_time_val_add (&deadline, GSTOMX_TRANSCODE_DRAIN_TIMEOUT);
+
+  g_mutex_lock (self->lock);
+  while (!self->drained) {
+    if (!g_cond_timed_wait (self->cond, self->lock, &deadline)) {
+      GST_WARNING_OBJECT (self, "encoder not drained, dropping its frames");
+      break;
+    }
+  }
+  g_mutex_unlock (self->lock);
+
+  /* stopped before draining ends, so a late EOS is dropped as well */
+  gst_element_set_state (old, GST_STATE_NULL);
+
+  g_mutex_lock (self->lock);
+  self->draining = FALSE;
+  g_mutex_unlock (self->lock);
+
+  gst_ghost_pad_set_target (GST_GHOST_PAD (self->srcpad), NULL);
+  pad = gst_element_get_static_pad (old, "sink");
+  gst_pad_unlink (self->feed, pad);
+  gst_object_unref (pad);
+
+  GST_OBJECT_LOCK (self);
+  self->encoder = encoder;
+  GST_OBJECT_UNLOCK (self);
+
+  gst_bin_remove (GST_BIN (self), old);
+  gst_bin_add (GST_BIN (self), encoder);
+
+  pad = gst_element_get_static_pad (encoder, "sink");
+  gst_pad_link (self->feed, pad);
+  gst_object_unref (pad);
+
+  pad = gst_element_get_static_pad (encoder, "src");
+  gst_ghost_pad_set_target (GST_GHOST_PAD (self->srcpad), pad);
+  gst_object_unref (pad);
+
+  gst_element_sync_state_with_parent (encoder);
+
+  return TRUE;
+}
+
+static gboolean
+feed_buffer_probe (GstPad * pad, GstBuffer * buf, gpointer data)
+{
+  GstOmxTranscode *self = data;
+  GstCaps *caps;
+
+  caps = GST_BUFFER_CAPS (buf);
+  if (!caps || (self->caps && gst_caps_is_equal (caps, self->caps)))
+    return TRUE;
+
+  if (self->caps) {
+    GST_INFO_OBJECT (self, "caps changed to %" GST_PTR_FORMAT
+        ", replacing the encoder", caps);
+
+    if (!encoder_replace (self))
+      GST_WARNING_OBJECT (self, "could not make a new %s", self->encoder_name);
+  }
+
+  gst_caps_replace (&self->caps, caps);
+
+  return TRUE;
+}
+
+static void
+chain_clear (GstOmxTranscode * self)
+{
+  GstElement **elements[] = { &self->decoder, &self->scale,
+    &self->capsfilter, &self->encoder
+  };
+  guint i;
+
+  gst_ghost_pad_set_target (GST_GHOST_PAD (self->sinkpad), NULL);
+  gst_ghost_pad_set_target (GST_GHOST_PAD (self->srcpad), NULL);
+
+  if (self->feed) {
+    gst_object_unref (self->feed);
+    self->feed = NULL;
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (elements); i++) {
+    if (*elements[i]) {
+      /* elements not added yet are only floating */
+      if (GST_OBJECT_PARENT (*elements[i]))
+        gst_bin_remove (GST_BIN (self), *elements[i]);
+      else
+        gst_object_unref (*elements[i]);
+      *elements[i] = NULL;
+    }
+  }
+}
+
+/*
+ *  description : make and link the elements of the transcoder
+ *  params      : @self: transcoder
+ *  return      : FALSE if an element is missing
+ *  comments    : the elements of a previous chain and their settings go away
+ */
+static gboolean
+chain_build (GstOmxTranscode * self)
+{
+  GstElement *last;
+  GstPad *pad;
+
+  chain_clear (self);
+
+  self->decoder = gst_element_factory_make (self->decoder_name, NULL);
+  self->encoder = encoder_new (self, NULL);
+  if (self->width || self->height) {
+    self->scale = gst_element_factory_make ("videoscale", NULL);
+    self->capsfilter = gst_element_factory_make ("capsfilter", NULL);
+    if (!self->scale || !self->capsfilter)
+      goto missing;
+  }
+
+  if (!self->decoder || !self->encoder)
+    goto missing;
+
+  set_shared (self->decoder, FALSE, TRUE);
+  gst_bin_add_many (GST_BIN (self), self->decoder, self->encoder, NULL);
+  last = self->decoder;
+
+  if (self->scale) {
+    GstCaps *caps;
+
+    caps = gst_caps_new_simple ("video/x-raw-yuv", NULL);
+    if (self->width)
+      gst_caps_set_simple (caps, "width", G_TYPE_INT, self->width, NULL);
+    if (self->height)
+      gst_caps_set_simple (caps, "height", G_TYPE_INT, self->height, NULL);
+    g_object_set (self->capsfilter, "caps", caps, NULL);
+    gst_caps_unref (caps);
+
+    gst_bin_add_many (GST_BIN (self), self->scale, self->capsfilter, NULL);
+    gst_element_link_many (self->decoder, self->scale, self->capsfilter, NULL);
+    last = self->capsfilter;
+  }
+
+  gst_element_link (last, self->encoder);
+
+  self->feed = gst_element_get_static_pad (last, "src");
+  gst_pad_add_buffer_probe (self->feed, G_CALLBACK (feed_buffer_probe), self);
+
+  pad = gst_element_get_static_pad (self->decoder, "sink");
+  gst_ghost_pad_set_target (GST_GHOST_PAD (self->sinkpad), pad);
+  gst_object_unref (pad);
+
+  pad = gst_element_get_static_pad (self->encoder, "src");
+  gst_ghost_pad_set_target (GST_GHOST_PAD (self->srcpad), pad);
+  gst_object_unref (pad);
+
+  return TRUE;
+
+missing:
+  GST_WARNING_OBJECT (self, "missing elements for %s ! %s",
+      self->decoder_name, self->encoder_name);
+  chain_clear (self);
+  return FALSE;
+}
+
+static GstStateChangeReturn
+change_state (GstElement * element, GstStateChange transition)
+{
+  GstStateChangeReturn ret;
+  GstOmxTranscode *self;
+
+  self = GST_OMX_TRANSCODE (element);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_NULL_TO_READY:
+      if (!self->encoder) {
+        GST_ELEMENT_ERROR (self, CORE, MISSING_PLUGIN, (NULL),
+            ("no %s ! %s to transcode with", self->decoder_name,
+                self->encoder_name));
+        return GST_STATE_CHANGE_FAILURE;
+      }
+      break;
+
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      /* a drain waiting for the encoder is over */
+      g_mutex_lock (self->lock);
+      self->drained = TRUE;
+      g_cond_broadcast (self->cond);
+      g_mutex_unlock (self->lock);
+      break;
+
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_caps_replace (&self->caps, NULL);
+      break;
+
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+static void
+set_property (GObject * obj,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstOmxTranscode *self;
+  GstState state;
+
+  self = GST_OMX_TRANSCODE (obj);
+
+  /* modification: the elements are rebuilt only while nothing flows */
+  GST_OBJECT_LOCK (self);
+  state = GST_STATE (self);
+  GST_OBJECT_UNLOCK (self);
+
+  if (state != GST_STATE_NULL) {
+    GST_WARNING_OBJECT (self, "%s can only be set in NULL state, ignored",
+        pspec->name);
+    return;
+  }
+
+  switch (prop_id) {
+    case ARG_DECODER:
+      g_free (self->decoder_name);
+      self->decoder_name = g_value_dup_string (value);
+      break;
+    case ARG_ENCODER:
+      g_free (self->encoder_name);
+      self->encoder_name = g_value_dup_string (value);
+      break;
+    case ARG_WIDTH:
+      self->width = g_value_get_uint (value);
+      break;
+    case ARG_HEIGHT:
+      self->height = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      return;
+  }
+
+  chain_build (self);
+}
+
+static void
+get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstOmxTranscode *self;
+
+  self = GST_OMX_TRANSCODE (obj);
+
+  switch (prop_id) {
+    case ARG_DECODER:
+      g_value_set_string (value, self->decoder_name);
+      break;
+    case ARG_ENCODER:
+      g_value_set_string (value, self->encoder_name);
+      break;
+    case ARG_WIDTH:
+      g_value_set_uint (value, self->width);
+      break;
+    case ARG_HEIGHT:
+      g_value_set_uint (value, self->height);
+      break;
+    case ARG_DECODER_ELEMENT:
+      g_value_set_object (value, self->decoder);
+      break;
+    case ARG_ENCODER_ELEMENT:
+      GST_OBJECT_LOCK (self);
+      g_value_set_object (value, self->encoder);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+finalize (GObject * obj)
+{
+  GstOmxTranscode *self;
+
+  self = GST_OMX_TRANSCODE (obj);
+
+  if (self->feed)
+    gst_object_unref (self->feed);
+  gst_caps_replace (&self->caps, NULL);
+
+  g_free (self->decoder_name);
+  g_free (self->encoder_name);
+
+  g_cond_free (self->cond);
+  g_mutex_free (self->lock);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+type_base_init (gpointer g_class)
+{
+  GstElementClass *element_class;
+
+  element_class = GST_ELEMENT_CLASS (g_class);
+
+  gst_element_class_set_details_simple (element_class,
+      "OpenMAX IL transcoder",
+      "Codec/Decoder/Encoder/Video",
+      "Decodes and re-encodes video handing decoded frames over uncopied",
+      "Samsung Electronics Co., Ltd.");
+
+  gst_element_class_add_pad_template (element_class,
+      gst_pad_template_new ("sink", GST_PAD_SINK, GST_PAD_ALWAYS,
+          gst_caps_new_any ()));
+
+  gst_element_class_add_pad_template (element_class,
+      gst_pad_template_new ("src", GST_PAD_SRC, GST_PAD_ALWAYS,
+          gst_caps_new_any ()));
+}
+
+static void
+type_class_init (gpointer g_class, gpointer class_data)
+{
+  GstElementClass *gstelement_class;
+  GObjectClass *gobject_class;
+
+  gstelement_class = GST_ELEMENT_CLASS (g_class);
+  gobject_class = G_OBJECT_CLASS (g_class);
+
+  gobject_class->finalize = finalize;
+  gstelement_class->change_state = change_state;
+
+  /* Properties stuff */
+  {
+    gobject_class->set_property = set_property;
+    gobject_class->get_property = get_property;
+
+    g_object_class_install_property (gobject_class, ARG_DECODER,
+        g_param_spec_string ("decoder", "Decoder",
+            "Decoder element to use, replaces the elements (set in NULL state)",
+            DEFAULT_DECODER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, ARG_ENCODER,
+        g_param_spec_string ("encoder", "Encoder",
+            "Encoder element to use, replaces the elements (set in NULL state)",
+            DEFAULT_ENCODER, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, ARG_WIDTH,
+        g_param_spec_uint ("width", "Width",
+            "Width to encode at, 0 keeps the decoded width (set in NULL state)",
+            0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, ARG_HEIGHT,
+        g_param_spec_uint ("height", "Height",
+            "Height to encode at, 0 keeps the decoded height (set in NULL state)",
+            0, G_MAXINT, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, ARG_DECODER_ELEMENT,
+        g_param_spec_object ("decoder-element", "Decoder element",
+            "The decoder, for its own properties",
+            GST_TYPE_ELEMENT, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, ARG_ENCODER_ELEMENT,
+        g_param_spec_object ("encoder-element", "Encoder element",
+            "The encoder, for its own properties, kept by a replacement",
+            GST_TYPE_ELEMENT, G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+  }
+}
+
+static void
+type_instance_init (GTypeInstance * instance, gpointer g_class)
+{
+  GstOmxTranscode *self;
+  GstElementClass *element_class;
+
+  self = GST_OMX_TRANSCODE (instance);
+  element_class = GST_ELEMENT_CLASS (g_class);
+
+  self->decoder_name = g_strdup (DEFAULT_DECODER);
+  self->encoder_name = g_strdup (DEFAULT_ENCODER);
+  self->width = 0;
+  self->height = 0;
+
+  self->lock = g_mutex_new ();
+  self->cond = g_cond_new ();
+  self->draining = FALSE;
+  self->drained = FALSE;
+
+  self->sinkpad = gst_ghost_pad_new_no_target_from_template ("sink",
+      gst_element_class_get_pad_template (element_class, "sink"));
+  self->srcpad = gst_ghost_pad_new_no_target_from_template ("src",
+      gst_element_class_get_pad_template (element_class, "src"));
+
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  chain_build (self);
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#ifndef GSTOMX_TRANSCODE_H
+#define GSTOMX_TRANSCODE_H
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+#define GST_OMX_TRANSCODE(obj) (GstOmxTranscode *) (obj)
+#define GST_OMX_TRANSCODE_TYPE (gst_omx_transcode_get_type ())
+typedef struct GstOmxTranscode GstOmxTranscode;
+typedef struct GstOmxTranscodeClass GstOmxTranscodeClass;
+
+/* modification: a decoder and an encoder linked in shared mode, so a decoded
+ * frame is the encoder input without a copy in between */
+struct GstOmxTranscode
+{
+  GstBin bin;
+
+  gchar *decoder_name;
+  gchar *encoder_name;
+  guint width;                  /* 0 keeps the decoded size */
+  guint height;
+
+  GstElement *decoder;
+  GstElement *scale;            /* NULL unless width or height is set */
+  GstElement *capsfilter;
+  GstElement *encoder;
+  GstPad *sinkpad;              /* ghost pads */
+  GstPad *srcpad;
+
+  GstPad *feed;                 /* the pad pushing to the encoder */
+  GstCaps *caps;                /* last caps the encoder got */
+
+  /* the encoder is drained before it is replaced on a caps change */
+  GMutex *lock;
+  GCond *cond;
+  gboolean draining;
+  gboolean drained;
+};
+
+struct GstOmxTranscodeClass
+{
+  GstBinClass parent_class;
+};
+
+GType gst_omx_transcode_get_type (void);
+
+G_END_DECLS
+#endif /* GSTOMX_TRANSCODE_H */
@@ -22,6 +22,9 @@
 
 #include "gstomx_util.h"
 #include <dlfcn.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <sys/mman.h>
 
 #include "gstomx.h"
 
@@ -72,6 +75,8 @@ static inline void port_allocate_buffers (GOmxPort * port);
 
 static inline void port_start_buffers (GOmxPort * port);
 
+static void port_arena_free (GOmxPort * port);
+
 static OMX_CALLBACKTYPE callbacks =
     { EventHandler, EmptyBufferDone, FillBufferDone };
 
@@ -80,6 +85,26 @@ static GMutex *imp_mutex;
 static GHashTable *implementations;
 static gboolean initialized;
 
+/* Modification: instance slots of the components, by component name */
+typedef struct
+{
+  guint capacity;
+  GList *holders;             /* cores with a slot */
+  GList *waiters;             /* cores waiting, by priority then arrival */
+} GOmxResource;
+
+static GMutex *resource_mutex;
+static GCond *resource_cond;
+static GHashTable *resources;
+
+/* Modification: port buffer memory of every element, by component name and
+ * by element, against one budget */
+static GMutex *memory_mutex;
+static gsize memory_budget;     /* 0 is no limit */
+static gsize memory_total;
+static GHashTable *memory_components;
+static GHashTable *memory_elements;
+
 /*
  * Util
  */
@@ -212,6 +237,474 @@ release_imp (GOmxImp * imp)
   g_mutex_unlock (imp->mutex);
 }
 
+/*
+ * Admission
+ *
+ * A platform runs a few instances of a codec component at once, and the
+ * one too many fails in OMX_GetHandle or, worse, after the Loaded to Idle
+ * timeout. Components with a capacity set hand out that many slots in
+ * g_omx_core_prepare; a core waits at most its admission_timeout for one,
+ * higher priorities first, and fails with OMX_ErrorInsufficientResources.
+ */
+
+static void
+resource_free (GOmxResource * resource)
+{
+  g_list_free (resource->holders);
+  g_list_free (resource->waiters);
+  g_free (resource);
+}
+
+/* equal priorities keep their order of arrival */
+static gint
+waiter_compare (gconstpointer a, gconstpointer b)
+{
+  const GOmxCore *core = a;
+  const GOmxCore *other = b;
+
+  return other->priority >= core->priority ? 1 : -1;
+}
+
+/* posted with no lock held, a bus sync handler may stop another pipeline */
+static void
+post_usage (GOmxCore * core, guint used, guint capacity, guint waiting)
+{
+  GstStructure *s;
+
+  if (!GST_IS_ELEMENT (core->object))
+    return;
+
+  s = gst_structure_new ("omx-resource",
+      "component", G_TYPE_STRING, core->component_name,
+      "used", G_TYPE_UINT, used,
+      "capacity", G_TYPE_UINT, capacity,
+      "waiting", G_TYPE_UINT, waiting, NULL);
+
+  gst_element_post_message (GST_ELEMENT (core->object),
+      gst_message_new_element (GST_OBJECT (core->object), s));
+}
+
+/* the preemptible holder of lowest priority below core, if any */
+static GOmxCore *
+resource_victim (GOmxResource * resource, GOmxCore * core)
+{
+  GOmxCore *victim = NULL;
+  GList *l;
+
+  for (l = resource->holders; l; l = l->next) {
+    GOmxCore *holder = l->data;
+
+    if (!holder->preemptible || holder->preempted || !holder->preempt_cb ||
+        holder->priority >= core->priority)
+      continue;
+
+    if (!victim || holder->priority < victim->priority)
+      victim = holder;
+  }
+
+  return victim;
+}
+
+/*
+ *  description : set how many instances of a component may run at once
+ *  params      : @component_name: OMX component, @capacity: instances, 0 for
+ *                no limit
+ *  return      : none
+ *  comments    : read from the max-instances field of the config file
+ */
+void
+g_omx_resource_set_capacity (const gchar * component_name, guint capacity)
+{
+  GOmxResource *resource;
+
+  g_mutex_lock (resource_mutex);
+  resource = g_hash_table_lookup (resources, component_name);
+  if (!resource) {
+    resource = g_new0 (GOmxResource, 1);
+    g_hash_table_insert (resources, g_strdup (component_name), resource);
+  }
+  resource->capacity = capacity;
+  g_cond_broadcast (resource_cond);
+  g_mutex_unlock (resource_mutex);
+}
+
+/*
+ *  description : slot utilization of a component, for schedulers
+ *  params      : @component_name: OMX component, @used: slots held,
+ *                @capacity: slots, @waiting: cores queued for one
+ *  return      : FALSE if the component has no capacity set
+ *  comments    : the same figures are posted as an "omx-resource" element
+ *                message whenever a slot is taken or released
+ */
+gboolean
+g_omx_resource_get_usage (const gchar * component_name, guint * used,
+    guint * capacity, guint * waiting)
+{
+  GOmxResource *resource;
+
+  g_mutex_lock (resource_mutex);
+  resource = g_hash_table_lookup (resources, component_name);
+  if (resource && resource->capacity > 0) {
+    if (used)
+      *used = g_list_length (resource->holders);
+    if (capacity)
+      *capacity = resource->capacity;
+    if (waiting)
+      *waiting = g_list_length (resource->waiters);
+  }
+  g_mutex_unlock (resource_mutex);
+
+  return resource && resource->capacity > 0;
+}
+
+/*
+ *  description : take an instance slot of the component of core
+ *  params      : @core: core about to go to Idle
+ *  return      : FALSE if no slot was free within admission_timeout
+ *  comments    : only the first waiter is admitted; while it waits it asks
+ *                one preemptible holder of lower priority to stop
+ */
+static gboolean
+core_acquire (GOmxCore * core)
+{
+  GOmxResource *resource;
+  GOmxCore *victim = NULL;
+  gboolean preempting = FALSE;
+  gboolean admitted = TRUE;
+  guint used, capacity, waiting;
+  GTimeVal deadline;
+
+  if (core->has_slot)
+    return TRUE;
+
+  g_mutex_lock (resource_mutex);
+  resource = g_hash_table_lookup (resources, core->component_name);
+  if (!resource || resource->capacity == 0) {
+    g_mutex_unlock (resource_mutex);
+    return TRUE;
+  }
+
+  g_get_current_time (&deadline);
+  g_time_val_add (&deadline, core->admission_timeout);
+
+  resource->waiters = g_list_insert_sorted (resource->waiters, core,
+      waiter_compare);
+
+  while (resource->waiters->data != core ||
+      g_list_length (resource->holders) >= resource->capacity) {
+    if (!preempting && resource->waiters->data == core) {
+      victim = resource_victim (resource, core);
+      if (victim) {
+        victim->preempted = TRUE;
+        preempting = TRUE;
+
+        /* the callback may release the slot right away */
+        g_mutex_unlock (resource_mutex);
+        GST_INFO_OBJECT (core->object, "preempting %p of priority %d",
+            victim->object, victim->priority);
+        victim->preempt_cb (victim);
+        g_mutex_lock (resource_mutex);
+        continue;
+      }
+    }
+
+    if (!g_cond_timed_wait (resource_cond, resource_mutex, &deadline)) {
+      admitted = resource->waiters->data == core &&
+          g_list_length (resource->holders) < resource->capacity;
+      break;
+    }
+  }
+
+  resource->waiters = g_list_remove (resource->waiters, core);
+  if (admitted) {
+    resource->holders = g_list_prepend (resource->holders, core);
+    core->has_slot = TRUE;
+    core->preempted = FALSE;
+  }
+  /* the next waiter may be first now */
+  g_cond_broadcast (resource_cond);
+  used = g_list_length (resource->holders);
+  capacity = resource->capacity;
+  waiting = g_list_length (resource->waiters);
+  g_mutex_unlock (resource_mutex);
+
+  if (admitted)
+    post_usage (core, used, capacity, waiting);
+  else
+    GST_WARNING_OBJECT (core->object, "no free %s instance after %lu us, "
+        "%u in use", core->component_name, core->admission_timeout, used);
+
+  return admitted;
+}
+
+static void
+core_release (GOmxCore * core)
+{
+  GOmxResource *resource;
+  guint used, capacity, waiting;
+
+  if (!core->has_slot)
+    return;
+
+  g_mutex_lock (resource_mutex);
+  resource = g_hash_table_lookup (resources, core->component_name);
+  resource->holders = g_list_remove (resource->holders, core);
+  core->has_slot = FALSE;
+  core->preempted = FALSE;
+  g_cond_broadcast (resource_cond);
+  used = g_list_length (resource->holders);
+  capacity = resource->capacity;
+  waiting = g_list_length (resource->waiters);
+  g_mutex_unlock (resource_mutex);
+
+  post_usage (core, used, capacity, waiting);
+}
+
+/*
+ * Memory budget
+ *
+ * Port buffers are charged when a core is prepared and uncharged when they
+ * are freed. A core that does not fit has its buffer counts lowered towards
+ * nBufferCountMin, largest buffers first, and is refused if it still does
+ * not fit, rather than running out of memory in the middle of a pipeline.
+ */
+
+/* called with memory_mutex held */
+static void
+memory_account (GOmxCore * core, gssize bytes)
+{
+  gsize component;
+  gsize element;
+
+  memory_total += bytes;
+
+  component = GPOINTER_TO_SIZE (g_hash_table_lookup (memory_components,
+          core->component_name)) + bytes;
+  if (component)
+    g_hash_table_insert (memory_components, g_strdup (core->component_name),
+        GSIZE_TO_POINTER (component));
+  else
+    g_hash_table_remove (memory_components, core->component_name);
+
+  element = GPOINTER_TO_SIZE (g_hash_table_lookup (memory_elements,
+          core->object)) + bytes;
+  if (element)
+    g_hash_table_insert (memory_elements, core->object,
+        GSIZE_TO_POINTER (element));
+  else
+    g_hash_table_remove (memory_elements, core->object);
+}
+
+static void
+port_charge (GOmxPort * port)
+{
+  if (port->budget_bytes)
+    return;
+
+  g_mutex_lock (memory_mutex);
+  port->budget_bytes = (gsize) port->num_buffers * port->buffer_size;
+  memory_account (port->core, port->budget_bytes);
+  g_mutex_unlock (memory_mutex);
+}
+
+static void
+port_uncharge (GOmxPort * port)
+{
+  if (!port->budget_bytes)
+    return;
+
+  g_mutex_lock (memory_mutex);
+  memory_account (port->core, -(gssize) port->budget_bytes);
+  port->budget_bytes = 0;
+  g_mutex_unlock (memory_mutex);
+}
+
+static guint
+port_min_buffers (GOmxPort * port)
+{
+  OMX_PARAM_PORTDEFINITIONTYPE param;
+
+  G_OMX_INIT_PARAM (param);
+  param.nPortIndex = port->port_index;
+  OMX_GetParameter (port->core->omx_handle, OMX_IndexParamPortDefinition,
+      &param);
+
+  return MAX (param.nBufferCountMin, 1);
+}
+
+static void
+port_set_num_buffers (GOmxPort * port, guint num_buffers)
+{
+  OMX_PARAM_PORTDEFINITIONTYPE param;
+
+  G_OMX_INIT_PARAM (param);
+  param.nPortIndex = port->port_index;
+  OMX_GetParameter (port->core->omx_handle, OMX_IndexParamPortDefinition,
+      &param);
+
+  param.nBufferCountActual = num_buffers;
+  OMX_SetParameter (port->core->omx_handle, OMX_IndexParamPortDefinition,
+      &param);
+
+  g_omx_port_setup (port);
+}
+
+/*
+ *  description : charge the buffers a core is about to allocate
+ *  params      : @core: core in Loaded with its ports set up
+ *  return      : FALSE if it does not fit the budget even with the fewest
+ *                buffers its ports take
+ *  comments    : the check and the charge are one step, so cores prepared
+ *                at once cannot overshoot together; the component is only
+ *                queried and set outside memory_mutex
+ */
+static gboolean
+core_reserve_memory (GOmxCore * core)
+{
+  guint n_ports = core->ports->len;
+  guint *counts;
+  guint *mins;
+  gsize need = 0;
+  gboolean fits = TRUE;
+  guint i;
+
+  counts = g_new0 (guint, n_ports);
+  mins = g_new0 (guint, n_ports);
+
+  for (i = 0; i < n_ports; i++) {
+    GOmxPort *port = get_port (core, i);
+
+    if (port && !port->budget_bytes && port->num_buffers) {
+      counts[i] = port->num_buffers;
+      mins[i] = MIN (port_min_buffers (port), counts[i]);
+      need += (gsize) port->num_buffers * port->buffer_size;
+    }
+  }
+
+  g_mutex_lock (memory_mutex);
+
+  if (memory_budget && memory_total + need > memory_budget) {
+    /* one buffer less at a time, from the port of largest buffers */
+    while (memory_total + need > memory_budget) {
+      GOmxPort *largest = NULL;
+      guint index = 0;
+
+      for (i = 0; i < n_ports; i++) {
+        GOmxPort *port = get_port (core, i);
+
+        if (counts[i] > mins[i] &&
+            (!largest || port->buffer_size > largest->buffer_size)) {
+          largest = port;
+          index = i;
+        }
+      }
+
+      if (!largest) {
+        fits = FALSE;
+        break;
+      }
+
+      counts[index]--;
+      need -= largest->buffer_size;
+    }
+  }
+
+  if (fits) {
+    for (i = 0; i < n_ports; i++) {
+      GOmxPort *port = get_port (core, i);
+
+      if (counts[i]) {
+        port->budget_bytes = (gsize) counts[i] * port->buffer_size;
+        memory_account (core, port->budget_bytes);
+      }
+    }
+  } else {
+    GST_WARNING_OBJECT (core->object, "%" G_GSIZE_FORMAT " bytes of buffers "
+        "do not fit, %" G_GSIZE_FORMAT " of %" G_GSIZE_FORMAT " in use", need,
+        memory_total, memory_budget);
+  }
+
+  g_mutex_unlock (memory_mutex);
+
+  for (i = 0; fits && i < n_ports; i++) {
+    GOmxPort *port = get_port (core, i);
+
+    if (counts[i] && counts[i] != port->num_buffers) {
+      GST_INFO_OBJECT (core->object, "port %u: %u buffers for the budget",
+          port->port_index, counts[i]);
+      port_set_num_buffers (port, counts[i]);
+
+      /* the component has the last word on the count */
+      if ((gsize) port->num_buffers * port->buffer_size != port->budget_bytes) {
+        port_uncharge (port);
+        port_charge (port);
+      }
+    }
+  }
+
+  g_free (mins);
+  g_free (counts);
+
+  return fits;
+}
+
+/*
+ *  description : set the ceiling of port buffer memory of the process
+ *  params      : @budget: bytes, 0 for no limit
+ *  return      : none
+ *  comments    : the OMX_MEMORY_BUDGET environment variable sets it in MiB;
+ *                cores already prepared keep their buffers
+ */
+void
+g_omx_memory_set_budget (gsize budget)
+{
+  g_mutex_lock (memory_mutex);
+  memory_budget = budget;
+  g_mutex_unlock (memory_mutex);
+}
+
+gsize
+g_omx_memory_get_budget (void)
+{
+  gsize budget;
+
+  g_mutex_lock (memory_mutex);
+  budget = memory_budget;
+  g_mutex_unlock (memory_mutex);
+
+  return budget;
+}
+
+/* bytes of port buffers of a component, or of all with NULL */
+gsize
+g_omx_memory_get_usage (const gchar * component_name)
+{
+  gsize bytes;
+
+  g_mutex_lock (memory_mutex);
+  if (component_name)
+    bytes = GPOINTER_TO_SIZE (g_hash_table_lookup (memory_components,
+            component_name));
+  else
+    bytes = memory_total;
+  g_mutex_unlock (memory_mutex);
+
+  return bytes;
+}
+
+/* bytes of port buffers of the cores of an element */
+gsize
+g_omx_memory_get_element_usage (gpointer object)
+{
+  gsize bytes;
+
+  g_mutex_lock (memory_mutex);
+  bytes = GPOINTER_TO_SIZE (g_hash_table_lookup (memory_elements, object));
+  g_mutex_unlock (memory_mutex);
+
+  return bytes;
+}
+
 void
 g_omx_init (void)
 {
@@ -220,6 +713,18 @@ g_omx_init (void)
     imp_mutex = g_mutex_new ();
     implementations = g_hash_table_new_full (g_str_hash,
         g_str_equal, g_free, (GDestroyNotify) imp_free);
+    resource_mutex = g_mutex_new ();
+    resource_cond = g_cond_new ();
+    resources = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+        (GDestroyNotify) resource_free);
+    memory_mutex = g_mutex_new ();
+    memory_components = g_hash_table_new_full (g_str_hash, g_str_equal,
+        g_free, NULL);
+    memory_elements = g_hash_table_new (g_direct_hash, g_direct_equal);
+    /* in MiB */
+    if (g_getenv ("OMX_MEMORY_BUDGET"))
+      memory_budget = (gsize) g_ascii_strtoull (g_getenv ("OMX_MEMORY_BUDGET"),
+          NULL, 10) << 20;
     initialized = TRUE;
   }
 }
@@ -230,6 +735,12 @@ g_omx_deinit (void)
   if (initialized) {
     g_hash_table_destroy (implementations);
     g_mutex_free (imp_mutex);
+    g_hash_table_destroy (resources);
+    g_cond_free (resource_cond);
+    g_mutex_free (resource_mutex);
+    g_hash_table_destroy (memory_elements);
+    g_hash_table_destroy (memory_components);
+    g_mutex_free (memory_mutex);
     initialized = FALSE;
   }
 }
@@ -257,6 +768,10 @@ g_omx_core_new (void *object)
 
   core->omx_state = OMX_StateInvalid;
 
+  core->priority = 0;
+  core->preemptible = FALSE;
+  core->admission_timeout = G_OMX_ADMISSION_TIMEOUT;
+
   return core;
 }
 
@@ -333,6 +848,8 @@ g_omx_core_init (GOmxCore * core)
 static void
 core_deinit (GOmxCore * core)
 {
+  core_release (core);
+
   if (!core->imp)
     return;
 
@@ -361,12 +878,27 @@ core_deinit (GOmxCore * core)
 void
 g_omx_core_prepare (GOmxCore * core)
 {
+  /* Modification: fail now rather than in the component */
+  if (!core_acquire (core)) {
+    core->omx_error = OMX_ErrorInsufficientResources;
+    return;
+  }
+
+  if (!core_reserve_memory (core)) {
+    core_release (core);
+    core->omx_error = OMX_ErrorInsufficientResources;
+    return;
+  }
+
   change_state (core, OMX_StateIdle);
 
   /* Allocate buffers. */
   core_for_each_port (core, port_allocate_buffers);
 
   wait_for_state (core, OMX_StateIdle);
+
+  if (core->omx_state != OMX_StateIdle)
+    core_release (core);
 }
 
 void
@@ -413,6 +945,8 @@ g_omx_core_unload (GOmxCore * core)
 
   core_for_each_port (core, g_omx_port_free);
   g_ptr_array_clear (core->ports);
+
+  core_release (core);
 }
 
 static inline GOmxPort *
@@ -497,6 +1031,10 @@ g_omx_port_new (GOmxCore * core, guint index)
 void
 g_omx_port_free (GOmxPort * port)
 {
+  /* a port never allocated after a failed prepare */
+  port_uncharge (port);
+  port_arena_free (port);
+
   g_mutex_free (port->mutex);
   async_queue_free (port->queue);
 
@@ -542,6 +1080,159 @@ g_omx_port_setup (GOmxPort * port)
   port->buffers = g_new0 (OMX_BUFFERHEADERTYPE *, port->num_buffers);
 }
 
+/* Modification: buffers in the arena start on a cache line, page sized
+ * ones on a page; the mapping of a huge page aligned port starts on one */
+#define G_OMX_ARENA_ALIGN 64
+#define G_OMX_HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+#define G_OMX_ROUND_UP(n, align) (((n) + (align) - 1) / (align) * (align))
+
+static void
+port_arena_free (GOmxPort * port)
+{
+  if (!port->arena_data)
+    return;
+
+  if (port->arena_locked)
+    munlock (port->arena_data, port->arena_size);
+  munmap (port->arena_data, port->arena_size);
+
+  port->arena_data = NULL;
+  port->arena_size = 0;
+  port->arena_locked = FALSE;
+}
+
+/* an anonymous mapping of size bytes starting on a multiple of align */
+static gpointer
+arena_map (gsize size, gsize align)
+{
+  gsize page = sysconf (_SC_PAGESIZE);
+  guint8 *data;
+  guint8 *start;
+
+  if (align <= page) {
+    data = mmap (NULL, size, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    return data == MAP_FAILED ? NULL : data;
+  }
+
+  /* map more and trim the ends */
+  data = mmap (NULL, size + align - page, PROT_READ | PROT_WRITE,
+      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (data == MAP_FAILED)
+    return NULL;
+
+  start = (guint8 *) G_OMX_ROUND_UP ((gsize) data, align);
+  if (start > data)
+    munmap (data, start - data);
+  if (start + size < data + size + align - page)
+    munmap (start + size, data + size + align - page - (start + size));
+
+  return start;
+}
+
+/*
+ *  description : make room for the own buffers of a port in its arena
+ *  params      : @port: port, @size: bytes of each buffer
+ *  return      : FALSE if no mapping could be made, buffers are then malloced
+ *  comments    : an existing mapping is reused when the buffers fit in it,
+ *                so a port resized or enabled again does not map anew
+ */
+static gboolean
+port_arena_reserve (GOmxPort * port, gsize size)
+{
+  gsize page = sysconf (_SC_PAGESIZE);
+  gsize stride;
+  gsize total;
+  gsize align = page;
+
+  stride = G_OMX_ROUND_UP (size, size >= page ? page : G_OMX_ARENA_ALIGN);
+  total = G_OMX_ROUND_UP (stride * port->num_buffers, page);
+
+  if (port->huge_pages && total >= G_OMX_HUGE_PAGE_SIZE) {
+    total = G_OMX_ROUND_UP (total, G_OMX_HUGE_PAGE_SIZE);
+    align = G_OMX_HUGE_PAGE_SIZE;
+  }
+
+  if (port->arena_data && stride * port->num_buffers <= port->arena_size) {
+    port->arena_stride = stride;
+    port->arena_reuses++;
+    return TRUE;
+  }
+
+  port_arena_free (port);
+
+  port->arena_data = arena_map (total, align);
+  if (!port->arena_data) {
+    GST_WARNING_OBJECT (port->core->object,
+        "no arena of %" G_GSIZE_FORMAT " bytes for port %d, using heap memory",
+        total, port->port_index);
+    return FALSE;
+  }
+
+  port->arena_size = total;
+  port->arena_stride = stride;
+
+#ifdef MADV_HUGEPAGE
+  if (align == G_OMX_HUGE_PAGE_SIZE &&
+      madvise (port->arena_data, total, MADV_HUGEPAGE) != 0)
+    GST_INFO_OBJECT (port->core->object, "no transparent huge pages");
+#endif
+
+  if (port->lock_memory) {
+    if (mlock (port->arena_data, total) == 0)
+      port->arena_locked = TRUE;
+    else
+      GST_WARNING_OBJECT (port->core->object,
+          "could not lock %" G_GSIZE_FORMAT " bytes of port %d", total,
+          port->port_index);
+  }
+
+  GST_DEBUG_OBJECT (port->core->object, "port %d: arena of %" G_GSIZE_FORMAT
+      " bytes at %p, stride %" G_GSIZE_FORMAT, port->port_index, total,
+      port->arena_data, stride);
+
+  return TRUE;
+}
+
+/*
+ *  description : bytes of the arena of a port backed by huge pages
+ *  params      : @port: port
+ *  return      : AnonHugePages of the mappings of the arena, 0 without one
+ *  comments    : reads /proc/self/smaps, not meant for the streaming path;
+ *                each huge page takes one TLB entry instead of 512
+ */
+gsize
+g_omx_port_get_huge_page_bytes (GOmxPort * port)
+{
+  FILE *smaps;
+  gchar line[256];
+  gsize start = (gsize) port->arena_data;
+  gsize end = start + port->arena_size;
+  gboolean inside = FALSE;
+  gsize bytes = 0;
+
+  if (!port->arena_data)
+    return 0;
+
+  smaps = fopen ("/proc/self/smaps", "r");
+  if (!smaps)
+    return 0;
+
+  while (fgets (line, sizeof (line), smaps)) {
+    unsigned long from, to, kb;
+
+    if (sscanf (line, "%lx-%lx ", &from, &to) == 2)
+      inside = from < end && to > start;
+    else if (inside && sscanf (line, "AnonHugePages: %lu kB", &kb) == 1)
+      bytes += (gsize) kb * 1024;
+  }
+
+  fclose (smaps);
+
+  return bytes;
+}
+
 static void
 port_allocate_buffers (GOmxPort * port)
 {
@@ -550,6 +1241,12 @@ port_allocate_buffers (GOmxPort * port)
 
   size = port->buffer_size;
 
+  /* reserved on prepare, charged here when the port is enabled again */
+  port_charge (port);
+
+  if (!port->omx_allocate && !port->shared_buffer && port->num_buffers > 0)
+    port->arena_used = port_arena_reserve (port, size);
+
   for (i = 0; i < port->num_buffers; i++) {
     if (port->omx_allocate) {
       GST_DEBUG_OBJECT (port->core->object,
@@ -558,7 +1255,10 @@ port_allocate_buffers (GOmxPort * port)
           port->port_index, NULL, size);
     } else {
       gpointer buffer_data;
-      buffer_data = g_malloc (size);
+      if (port->arena_used)
+        buffer_data = (guint8 *) port->arena_data + i * port->arena_stride;
+      else
+        buffer_data = g_malloc (size);
       GST_DEBUG_OBJECT (port->core->object,
           "%d: OMX_UseBuffer(), size=%" G_GSIZE_FORMAT, i, size);
       OMX_UseBuffer (port->core->omx_handle, &port->buffers[i],
@@ -595,7 +1295,7 @@ port_free_buffers (GOmxPort * port)
         }
 
       } else { /* this is not shared buffer */
-        if (!port->omx_allocate) {
+        if (!port->omx_allocate && !port->arena_used) {
       /* Modification: free pBuffer allocated in plugin when OMX_UseBuffer.
        * the component shall free only buffer header if it allocated only buffer header.*/
           GST_INFO_OBJECT(port->core->object,
@@ -611,6 +1311,11 @@ port_free_buffers (GOmxPort * port)
       port->buffers[i] = NULL;
     }
   }
+
+  /* the arena stays for the next allocation */
+  port->arena_used = FALSE;
+
+  port_uncharge (port);
 }
 
 static void
@@ -720,6 +1425,69 @@ g_omx_port_disable (GOmxPort * port)
   g_sem_down (core->port_sem);
 }
 
+/* MODIFICATION: reallocate the buffers of an enabled port with another
+ * nBufferSize. The caller holds n_held buffers outside the queue; the rest
+ * are taken from the queue as the component returns them and handed to func,
+ * if any, before everything is freed. Returns FALSE, with the port left
+ * disabled, when the component fails or keeps its buffers. */
+gboolean
+g_omx_port_set_buffer_size (GOmxPort * port, gulong size, guint n_held,
+    GOmxPortBufferCb func, gpointer data)
+{
+  GOmxCore *core;
+  OMX_PARAM_PORTDEFINITIONTYPE param;
+  GTimeVal deadline;
+  guint i;
+
+  core = port->core;
+
+  OMX_SendCommand (core->omx_handle, OMX_CommandPortDisable, port->port_index,
+      NULL);
+
+  /* the component returns every buffer before completing the disable; an
+   * error wakes the wait up through the flush it starts */
+  g_get_current_time (&deadline);
+  g_time_val_add (&deadline, 15 * G_USEC_PER_SEC);
+
+  for (i = n_held; i < port->num_buffers; i++) {
+    OMX_BUFFERHEADERTYPE *omx_buffer;
+
+    while (!(omx_buffer = async_queue_pop_timed (port->queue, &deadline))) {
+      GTimeVal now;
+
+      g_get_current_time (&now);
+      if (core->omx_error != OMX_ErrorNone ||
+          now.tv_sec > deadline.tv_sec ||
+          (now.tv_sec == deadline.tv_sec && now.tv_usec >= deadline.tv_usec)) {
+        GST_ERROR_OBJECT (core->object, "port %u: %u buffers not returned",
+            port->port_index, port->num_buffers - i);
+        port->enabled = FALSE;
+        return FALSE;
+      }
+    }
+
+    if (func)
+      func (port, omx_buffer, data);
+  }
+
+  port_free_buffers (port);
+  g_sem_down (core->port_sem);
+
+  G_OMX_INIT_PARAM (param);
+
+  param.nPortIndex = port->port_index;
+  OMX_GetParameter (core->omx_handle, OMX_IndexParamPortDefinition, &param);
+
+  param.nBufferSize = size;
+
+  OMX_SetParameter (core->omx_handle, OMX_IndexParamPortDefinition, &param);
+
+  g_omx_port_setup (port);
+  g_omx_port_enable (port);
+
+  return TRUE;
+}
+
 void
 g_omx_port_finish (GOmxPort * port)
 {
@@ -927,6 +1695,16 @@ EmptyBufferDone (OMX_HANDLETYPE omx_handle,
   GST_CAT_LOG_OBJECT (gstomx_util_debug, core->object, "omx_buffer=%p",
       omx_buffer);
   omx_buffer->nFlags = 0x00000000;
+
+  /* Modification: a lent buffer is released as soon as the component is done
+   * with it rather than when the header is reused */
+  if (port->shared_buffer && omx_buffer->pAppPrivate) {
+    gst_buffer_unref (omx_buffer->pAppPrivate);
+    omx_buffer->pAppPrivate = NULL;
+    omx_buffer->pBuffer = NULL;
+    omx_buffer->nOffset = 0;
+  }
+
   got_buffer (core, port, omx_buffer);
 
   return OMX_ErrorNone;
@@ -42,6 +42,8 @@ typedef enum GOmxVendor GOmxVendor;
 
 typedef void (*GOmxCb) (GOmxCore * core);
 typedef void (*GOmxPortCb) (GOmxPort * port);
+typedef void (*GOmxPortBufferCb) (GOmxPort * port,
+    OMX_BUFFERHEADERTYPE * omx_buffer, gpointer data);
 
 /* Enums. */
 
@@ -105,6 +107,15 @@ struct GOmxCore
   gchar *component_role;
   /* MODIFICATION: omx vender */
   GOmxVendor component_vendor;
+
+  /* Modification: admission to the instances of the component, see
+   * g_omx_resource_set_capacity () */
+  gint priority;              /**< higher ones are admitted first */
+  gboolean preemptible;       /**< may be asked to give its slot to a higher priority */
+  gulong admission_timeout;   /**< microseconds to wait for a slot */
+  gboolean has_slot;
+  gboolean preempted;
+  GOmxCb preempt_cb;          /**< asked to stop and release its slot */
 };
 
 struct GOmxPort
@@ -123,6 +134,19 @@ struct GOmxPort
   AsyncQueue *queue;
 
   gboolean shared_buffer; /* Modification */
+
+  gsize budget_bytes;      /**< Modification: charged to the memory budget */
+
+  /* Modification: own buffers carved from one aligned mapping, kept across
+   * disable and enable while they fit */
+  gboolean huge_pages;     /**< advise transparent huge pages */
+  gboolean lock_memory;    /**< mlock the mapping */
+  gpointer arena_data;
+  gsize arena_size;
+  gsize arena_stride;
+  gboolean arena_used;     /**< the current buffers come from it */
+  gboolean arena_locked;
+  guint arena_reuses;      /**< allocations served by an existing mapping */
 };
 
 /* Functions. */
@@ -157,7 +181,23 @@ void g_omx_port_pause (GOmxPort * port);
 void g_omx_port_flush (GOmxPort * port);
 void g_omx_port_enable (GOmxPort * port);
 void g_omx_port_disable (GOmxPort * port);
+gboolean g_omx_port_set_buffer_size (GOmxPort * port, gulong size,
+    guint n_held, GOmxPortBufferCb func, gpointer data);
 void g_omx_port_finish (GOmxPort * port);
+gsize g_omx_port_get_huge_page_bytes (GOmxPort * port);
+
+void g_omx_resource_set_capacity (const gchar * component_name,
+    guint capacity);
+gboolean g_omx_resource_get_usage (const gchar * component_name,
+    guint * used, guint * capacity, guint * waiting);
+
+/* Modification: how long g_omx_core_prepare waits for a free instance */
+#define G_OMX_ADMISSION_TIMEOUT (2 * G_USEC_PER_SEC)
+
+void g_omx_memory_set_budget (gsize budget);
+gsize g_omx_memory_get_budget (void);
+gsize g_omx_memory_get_usage (const gchar * component_name);
+gsize g_omx_memory_get_element_usage (gpointer object);
 
 /* Utility Macros */
 
@@ -73,6 +73,7 @@ setcaps (GstBaseSink * gst_sink, GstCaps * caps)
     gint width;
     gint height;
     OMX_COLOR_FORMATTYPE color_format = OMX_COLOR_FormatUnused;
+    guint32 fourcc = 0;
 
     structure = gst_caps_get_structure (caps, 0);
 
@@ -80,8 +81,6 @@ setcaps (GstBaseSink * gst_sink, GstCaps * caps)
     gst_structure_get_int (structure, "height", &height);
 
     if (strcmp (gst_structure_get_name (structure), "video/x-raw-yuv") == 0) {
-      guint32 fourcc;
-
       framerate = gst_structure_get_value (structure, "framerate");
 
       if (gst_structure_get_fourcc (structure, "format", &fourcc)) {
@@ -131,6 +130,23 @@ setcaps (GstBaseSink * gst_sink, GstCaps * caps)
       }
 
       OMX_SetParameter (gomx->omx_handle, OMX_IndexParamPortDefinition, &param);
+
+      /* MODIFICATION: frames are repacked when the port wants padded rows */
+      OMX_GetParameter (gomx->omx_handle, OMX_IndexParamPortDefinition, &param);
+      omx_base->repack_input =
+          gstomx_frame_layout_caps (&omx_base->caps_layout, fourcc, width, height) &&
+          gstomx_frame_layout_port (&omx_base->port_layout, fourcc, width, height,
+              MAX (param.format.video.nStride, 0), param.format.video.nSliceHeight) &&
+          !gstomx_frame_layout_equal (&omx_base->caps_layout, &omx_base->port_layout);
+
+      if (omx_base->repack_input) {
+        GST_INFO_OBJECT (omx_base, "repacking frames, stride %u, %" G_GSIZE_FORMAT
+            " bytes", omx_base->port_layout.stride[0], omx_base->port_layout.size);
+        if (param.nBufferSize < omx_base->port_layout.size) {
+          param.nBufferSize = omx_base->port_layout.size;
+          OMX_SetParameter (gomx->omx_handle, OMX_IndexParamPortDefinition, &param);
+        }
+      }
     }
 
     {
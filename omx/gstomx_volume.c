@@ -24,6 +24,23 @@
 #include "gstomx_base_filter.h"
 #include "gstomx.h"
 
+#include <string.h>             /* for memset */
+
+enum
+{
+  ARG_0,
+  ARG_VOLUME,
+  ARG_MUTE,
+};
+
+#define DEFAULT_VOLUME 1.0
+#define DEFAULT_MUTE FALSE
+#define MAX_VOLUME 10.0
+
+/* modification: 16 bit input is scaled in the element by a Q12 gain */
+#define GAIN_SHIFT 12
+#define UNITY_GAIN (1 << GAIN_SHIFT)
+
 GSTOMX_BOILERPLATE (GstOmxVolume, gst_omx_volume, GstOmxBaseFilter,
     GST_OMX_BASE_FILTER_TYPE);
 
@@ -48,9 +65,186 @@ type_base_init (gpointer g_class)
           gstomx_template_caps (G_TYPE_FROM_CLASS (g_class), "src")));
 }
 
+/* modification: the component takes linear volume in percent, within the
+ * nMin..nMax it reports; 0..100 when it reports no linear range */
+static void
+configure_component (GstOmxVolume * self)
+{
+  GstOmxBaseFilter *omx_base;
+  GOmxCore *gomx;
+  OMX_S32 min = 0, max = 100, value;
+
+  omx_base = GST_OMX_BASE_FILTER (self);
+  gomx = omx_base->gomx;
+
+  if (omx_base->use_inline || !gomx->omx_handle)
+    return;
+
+  {
+    OMX_AUDIO_CONFIG_VOLUMETYPE param;
+
+    G_OMX_INIT_PARAM (param);
+
+    param.nPortIndex = omx_base->out_port->port_index;
+    if (OMX_GetConfig (gomx->omx_handle, OMX_IndexConfigAudioVolume,
+            &param) == OMX_ErrorNone && param.bLinear &&
+        param.sVolume.nMax > param.sVolume.nMin) {
+      min = param.sVolume.nMin;
+      max = param.sVolume.nMax;
+    }
+
+    value = (OMX_S32) (self->volume * 100 + 0.5);
+    if (value < min || value > max)
+      GST_WARNING_OBJECT (self, "volume %.2f is out of the component range "
+          "%.2f..%.2f", self->volume, min / 100.0, max / 100.0);
+
+    param.bLinear = OMX_TRUE;
+    param.sVolume.nValue = CLAMP (value, min, max);
+
+    OMX_SetConfig (gomx->omx_handle, OMX_IndexConfigAudioVolume, &param);
+  }
+
+  {
+    OMX_AUDIO_CONFIG_MUTETYPE param;
+
+    G_OMX_INIT_PARAM (param);
+
+    param.nPortIndex = omx_base->out_port->port_index;
+    param.bMute = self->mute ? OMX_TRUE : OMX_FALSE;
+
+    OMX_SetConfig (gomx->omx_handle, OMX_IndexConfigAudioMute, &param);
+  }
+}
+
+static void
+set_property (GObject * obj,
+    guint prop_id, const GValue * value, GParamSpec * pspec)
+{
+  GstOmxVolume *self;
+
+  self = GST_OMX_VOLUME (obj);
+
+  switch (prop_id) {
+    case ARG_VOLUME:
+      GST_OBJECT_LOCK (self);
+      self->volume = g_value_get_double (value);
+      self->gain = (gint) (self->volume * UNITY_GAIN + 0.5);
+      GST_OBJECT_UNLOCK (self);
+      configure_component (self);
+      break;
+    case ARG_MUTE:
+      GST_OBJECT_LOCK (self);
+      self->mute = g_value_get_boolean (value);
+      GST_OBJECT_UNLOCK (self);
+      configure_component (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+get_property (GObject * obj, guint prop_id, GValue * value, GParamSpec * pspec)
+{
+  GstOmxVolume *self;
+
+  self = GST_OMX_VOLUME (obj);
+
+  switch (prop_id) {
+    case ARG_VOLUME:
+      g_value_set_double (value, self->volume);
+      break;
+    case ARG_MUTE:
+      g_value_set_boolean (value, self->mute);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (obj, prop_id, pspec);
+      break;
+  }
+}
+
+/* gain is in units of 1 << GAIN_SHIFT, results saturate */
+static void
+apply_gain (gint16 * samples, guint n, gint gain)
+{
+  guint i;
+
+  for (i = 0; i < n; i++) {
+    gint value = (samples[i] * gain) >> GAIN_SHIFT;
+
+    samples[i] = CLAMP (value, G_MININT16, G_MAXINT16);
+  }
+}
+
+/*
+ *  description : in-place volume of 16 bit input without the component
+ *  params      : @omx_base: base filter, @buf: input buffer, consumed
+ *  return      : flow return of the push
+ *  comments    : unity gain forwards buf untouched, mute pushes gap flagged
+ *                silence and any other gain scales the samples in place
+ */
+static GstFlowReturn
+inline_chain (GstOmxBaseFilter * omx_base, GstBuffer * buf)
+{
+  GstOmxVolume *self;
+  gboolean mute;
+  gint gain;
+
+  self = GST_OMX_VOLUME (omx_base);
+
+  GST_OBJECT_LOCK (self);
+  mute = self->mute;
+  gain = self->gain;
+  GST_OBJECT_UNLOCK (self);
+
+  if (mute) {
+    if (!gst_buffer_is_writable (buf)) {
+      GstBuffer *silence;
+
+      silence = gst_buffer_new_and_alloc (GST_BUFFER_SIZE (buf));
+      gst_buffer_copy_metadata (silence, buf, GST_BUFFER_COPY_ALL);
+      gst_buffer_unref (buf);
+      buf = silence;
+    }
+    memset (GST_BUFFER_DATA (buf), 0, GST_BUFFER_SIZE (buf));
+    GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_GAP);
+  } else if (gain != UNITY_GAIN) {
+    buf = gst_buffer_make_writable (buf);
+    apply_gain ((gint16 *) GST_BUFFER_DATA (buf), GST_BUFFER_SIZE (buf) / 2,
+        gain);
+  }
+
+  return gst_pad_push (omx_base->srcpad, buf);
+}
+
 static void
 type_class_init (gpointer g_class, gpointer class_data)
 {
+  GObjectClass *gobject_class;
+  GstOmxBaseFilterClass *basefilter_class;
+
+  gobject_class = G_OBJECT_CLASS (g_class);
+  basefilter_class = GST_OMX_BASE_FILTER_CLASS (g_class);
+
+  /* Properties stuff */
+  {
+    gobject_class->set_property = set_property;
+    gobject_class->get_property = get_property;
+
+    g_object_class_install_property (gobject_class, ARG_VOLUME,
+        g_param_spec_double ("volume", "Volume",
+            "Volume factor, 1.0 = 100% (a component may clamp it to its range)",
+            0.0, MAX_VOLUME, DEFAULT_VOLUME,
+            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+    g_object_class_install_property (gobject_class, ARG_MUTE,
+        g_param_spec_boolean ("mute", "Mute",
+            "Mute the audio",
+            DEFAULT_MUTE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+  }
+
+  basefilter_class->inline_chain = inline_chain;
 }
 
 static void
@@ -98,14 +292,64 @@ settings_changed_cb (GOmxCore * core)
   }
 }
 
+/* modification: native endian 16 bit input never reaches the component */
+static gboolean
+sink_setcaps (GstPad * pad, GstCaps * caps)
+{
+  GstStructure *structure;
+  GstOmxBaseFilter *omx_base;
+  GstOmxVolume *self;
+  gint width = 0, endianness = 0;
+  gboolean is_signed = FALSE;
+
+  omx_base = GST_OMX_BASE_FILTER (GST_PAD_PARENT (pad));
+  self = GST_OMX_VOLUME (omx_base);
+
+  GST_INFO_OBJECT (omx_base, "setcaps (sink): %" GST_PTR_FORMAT, caps);
+
+  structure = gst_caps_get_structure (caps, 0);
+
+  gst_structure_get_int (structure, "width", &width);
+  gst_structure_get_int (structure, "endianness", &endianness);
+  gst_structure_get_boolean (structure, "signed", &is_signed);
+
+  omx_base->use_inline = gst_structure_has_name (structure, "audio/x-raw-int")
+      && width == 16 && is_signed && endianness == G_BYTE_ORDER;
+  /* inline_chain scales only these samples, nothing else may fall back */
+  omx_base->inline_fallback = omx_base->use_inline;
+
+  if (omx_base->use_inline) {
+    /* the output has the format of the input */
+    gst_pad_set_caps (omx_base->srcpad, caps);
+  } else if (omx_base->gomx->omx_state != OMX_StateLoaded) {
+    GST_WARNING_OBJECT (omx_base, "no component for %" GST_PTR_FORMAT, caps);
+    return FALSE;
+  } else {
+    configure_component (self);
+  }
+
+  return gst_pad_set_caps (pad, caps);
+}
+
 static void
 type_instance_init (GTypeInstance * instance, gpointer g_class)
 {
   GstOmxBaseFilter *omx_base;
+  GstOmxVolume *self;
 
   omx_base = GST_OMX_BASE_FILTER (instance);
+  self = GST_OMX_VOLUME (instance);
 
   GST_DEBUG_OBJECT (omx_base, "start");
 
   omx_base->gomx->settings_changed_cb = settings_changed_cb;
+
+  gst_pad_set_setcaps_function (omx_base->sinkpad, sink_setcaps);
+
+  self->volume = DEFAULT_VOLUME;
+  self->mute = DEFAULT_MUTE;
+  self->gain = UNITY_GAIN;
+
+  /* without a component 16 bit input still works, narrowed by sink_setcaps */
+  omx_base->inline_fallback = TRUE;
 }
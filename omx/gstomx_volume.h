@@ -38,6 +38,9 @@ typedef struct GstOmxVolumeClass GstOmxVolumeClass;
 struct GstOmxVolume
 {
   GstOmxBaseFilter omx_base;
+  gdouble volume;
+  gboolean mute;
+  gint gain;                          /* volume in Q12, for 16 bit input */
 };
 
 struct GstOmxVolumeClass
@@ -0,0 +1,199 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* modification: sessions of omx_dummy_slot, whose stand-in component runs
+ * one instance at a time; a session takes the instance on its first buffer
+ * and gives it back in NULL state */
+
+#define BUFFER_SIZE 0x1000
+#define WAIT_TIMEOUT (5 * GST_SECOND)
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+typedef struct
+{
+  GstElement *filter;
+  GstPad *srcpad;
+  GstPad *sinkpad;
+  GstBus *bus;
+} Session;
+
+static void
+session_start (Session * session, gint priority, gboolean preemptible,
+    guint admission_timeout)
+{
+  session->filter = gst_check_setup_element ("omx_dummy_slot");
+  g_object_set (session->filter, "priority", priority,
+      "preemptible", preemptible, "admission-timeout", admission_timeout,
+      NULL);
+
+  session->srcpad = gst_check_setup_src_pad (session->filter, &srctemplate,
+      NULL);
+  session->sinkpad = gst_check_setup_sink_pad (session->filter,
+      &sinktemplate, NULL);
+  gst_pad_set_active (session->srcpad, TRUE);
+  gst_pad_set_active (session->sinkpad, TRUE);
+
+  session->bus = gst_bus_new ();
+  gst_element_set_bus (session->filter, session->bus);
+
+  fail_unless_equals_int (gst_element_set_state (session->filter,
+          GST_STATE_PLAYING), GST_STATE_CHANGE_SUCCESS);
+}
+
+static GstFlowReturn
+session_push (Session * session)
+{
+  return gst_pad_push (session->srcpad, gst_buffer_new_and_alloc (BUFFER_SIZE));
+}
+
+static gpointer
+push_thread (gpointer data)
+{
+  return GINT_TO_POINTER (session_push (data));
+}
+
+/* the next error of the session is the busy component */
+static void
+session_check_busy (Session * session)
+{
+  GstMessage *message;
+  GError *error = NULL;
+
+  message = gst_bus_timed_pop_filtered (session->bus, WAIT_TIMEOUT,
+      GST_MESSAGE_ERROR);
+  fail_unless (message != NULL);
+
+  gst_message_parse_error (message, &error, NULL);
+  fail_unless (g_error_matches (error, GST_RESOURCE_ERROR,
+          GST_RESOURCE_ERROR_BUSY));
+
+  g_error_free (error);
+  gst_message_unref (message);
+}
+
+static void
+session_stop (Session * session)
+{
+  gst_element_set_state (session->filter, GST_STATE_NULL);
+
+  gst_bus_set_flushing (session->bus, TRUE);
+  gst_element_set_bus (session->filter, NULL);
+  gst_object_unref (GST_OBJECT (session->bus));
+
+  gst_pad_set_active (session->srcpad, FALSE);
+  gst_pad_set_active (session->sinkpad, FALSE);
+  gst_check_teardown_src_pad (session->filter);
+  gst_check_teardown_sink_pad (session->filter);
+  gst_check_teardown_element (session->filter);
+}
+
+GST_START_TEST (test_admission_timeout)
+{
+  Session first, second;
+  GstMessage *message;
+
+  session_start (&first, 0, FALSE, 0);
+  fail_unless (session_push (&first) == GST_FLOW_OK);
+
+  /* the instance taken is announced */
+  message = gst_bus_timed_pop_filtered (first.bus, WAIT_TIMEOUT,
+      GST_MESSAGE_ELEMENT);
+  fail_unless (message != NULL);
+  fail_unless (gst_structure_has_name (gst_message_get_structure (message),
+          "omx-resource"));
+  gst_message_unref (message);
+
+  session_start (&second, 0, FALSE, 100);
+  fail_if (session_push (&second) == GST_FLOW_OK);
+  session_check_busy (&second);
+
+  session_stop (&second);
+  session_stop (&first);
+  gst_check_drop_buffers ();
+}
+
+GST_END_TEST
+GST_START_TEST (test_admission_queue)
+{
+  Session first, second;
+  GThread *thread;
+
+  session_start (&first, 0, FALSE, 0);
+  fail_unless (session_push (&first) == GST_FLOW_OK);
+
+  /* the second session waits until the first one stops */
+  session_start (&second, 1, FALSE, 5000);
+  thread = g_thread_create (push_thread, &second, TRUE, NULL);
+  g_usleep (G_USEC_PER_SEC / 10);
+  session_stop (&first);
+
+  fail_unless (GPOINTER_TO_INT (g_thread_join (thread)) == GST_FLOW_OK);
+
+  session_stop (&second);
+  gst_check_drop_buffers ();
+}
+
+GST_END_TEST
+GST_START_TEST (test_admission_preemption)
+{
+  Session first, second;
+  GThread *thread;
+
+  session_start (&first, 0, TRUE, 0);
+  fail_unless (session_push (&first) == GST_FLOW_OK);
+
+  /* a session of higher priority asks the first one to stop */
+  session_start (&second, 1, FALSE, 5000);
+  thread = g_thread_create (push_thread, &second, TRUE, NULL);
+  session_check_busy (&first);
+  session_stop (&first);
+
+  fail_unless (GPOINTER_TO_INT (g_thread_join (thread)) == GST_FLOW_OK);
+
+  session_stop (&second);
+  gst_check_drop_buffers ();
+}
+
+GST_END_TEST static Suite *
+admission_suite (void)
+{
+  Suite *s = suite_create ("admission");
+  TCase *tc_chain = tcase_create ("general");
+
+  tcase_set_timeout (tc_chain, 10);
+  tcase_add_test (tc_chain, test_admission_timeout);
+  tcase_add_test (tc_chain, test_admission_queue);
+  tcase_add_test (tc_chain, test_admission_preemption);
+  suite_add_tcase (s, tc_chain);
+
+  return s;
+}
+
+GST_CHECK_MAIN (admission);
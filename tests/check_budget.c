@@ -0,0 +1,178 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+
+/* modification: omx_dummy elements under a process-wide budget of 1 MiB of
+ * port buffers; the stand-in component takes as many buffers as it is
+ * given, at least one per port */
+
+#define BUFFER_SIZE 0x1000
+#define INPUT_SIZE (256 * 1024)
+#define INPUT_BUFFERS 10
+#define OUTPUT_BUFFERS 4
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+typedef struct
+{
+  GstElement *filter;
+  GstPad *srcpad;
+  GstPad *sinkpad;
+  GstBus *bus;
+} Session;
+
+/* 2.5 MiB of input buffers and 16 KiB of output buffers asked for */
+static void
+session_start (Session * session)
+{
+  session->filter = gst_check_setup_element ("omx_dummy");
+  g_object_set (session->filter, "max-input-frame-size", INPUT_SIZE,
+      "input-buffers", INPUT_BUFFERS, "output-buffers", OUTPUT_BUFFERS, NULL);
+
+  session->srcpad = gst_check_setup_src_pad (session->filter, &srctemplate,
+      NULL);
+  session->sinkpad = gst_check_setup_sink_pad (session->filter,
+      &sinktemplate, NULL);
+  gst_pad_set_active (session->srcpad, TRUE);
+  gst_pad_set_active (session->sinkpad, TRUE);
+
+  session->bus = gst_bus_new ();
+  gst_element_set_bus (session->filter, session->bus);
+
+  fail_unless_equals_int (gst_element_set_state (session->filter,
+          GST_STATE_PLAYING), GST_STATE_CHANGE_SUCCESS);
+}
+
+static GstFlowReturn
+session_push (Session * session)
+{
+  return gst_pad_push (session->srcpad, gst_buffer_new_and_alloc (BUFFER_SIZE));
+}
+
+static void
+session_stop (Session * session)
+{
+  gst_element_set_state (session->filter, GST_STATE_NULL);
+
+  gst_bus_set_flushing (session->bus, TRUE);
+  gst_element_set_bus (session->filter, NULL);
+  gst_object_unref (GST_OBJECT (session->bus));
+
+  gst_pad_set_active (session->srcpad, FALSE);
+  gst_pad_set_active (session->sinkpad, FALSE);
+  gst_check_teardown_src_pad (session->filter);
+  gst_check_teardown_sink_pad (session->filter);
+  gst_check_teardown_element (session->filter);
+}
+
+GST_START_TEST (test_budget_counts)
+{
+  Session session;
+  guint memory, input_buffers, output_buffers;
+
+  session_start (&session);
+  fail_unless (session_push (&session) == GST_FLOW_OK);
+
+  /* input buffers, the largest, are dropped until the rest fits */
+  g_object_get (session.filter, "buffer-memory", &memory,
+      "input-buffers", &input_buffers, "output-buffers", &output_buffers,
+      NULL);
+  fail_unless_equals_int (input_buffers, 3);
+  fail_unless_equals_int (output_buffers, OUTPUT_BUFFERS);
+  fail_unless_equals_int (memory,
+      3 * INPUT_SIZE + OUTPUT_BUFFERS * BUFFER_SIZE);
+
+  session_stop (&session);
+  gst_check_drop_buffers ();
+}
+
+GST_END_TEST
+GST_START_TEST (test_budget_refused)
+{
+  Session first, second;
+  GstMessage *message;
+  GError *error = NULL;
+  guint memory;
+
+  session_start (&first);
+  fail_unless (session_push (&first) == GST_FLOW_OK);
+
+  /* one buffer per port does not fit next to the first element */
+  session_start (&second);
+  fail_if (session_push (&second) == GST_FLOW_OK);
+
+  message = gst_bus_poll (second.bus, GST_MESSAGE_ERROR, 0);
+  fail_unless (message != NULL);
+  gst_message_parse_error (message, &error, NULL);
+  fail_unless (g_error_matches (error, GST_RESOURCE_ERROR,
+          GST_RESOURCE_ERROR_BUSY));
+  g_error_free (error);
+  gst_message_unref (message);
+
+  g_object_get (second.filter, "buffer-memory", &memory, NULL);
+  fail_unless_equals_int (memory, 0);
+
+  session_stop (&second);
+  session_stop (&first);
+  gst_check_drop_buffers ();
+}
+
+GST_END_TEST static Suite *
+budget_suite (void)
+{
+  Suite *s = suite_create ("budget");
+  TCase *tc_chain = tcase_create ("general");
+
+  tcase_set_timeout (tc_chain, 10);
+  tcase_add_test (tc_chain, test_budget_counts);
+  tcase_add_test (tc_chain, test_budget_refused);
+  suite_add_tcase (s, tc_chain);
+
+  return s;
+}
+
+int
+main (int argc, char **argv)
+{
+  int nf;
+  Suite *s;
+  SRunner *sr;
+
+  /* read by the plugin when it is loaded */
+  g_setenv ("OMX_MEMORY_BUDGET", "1", TRUE);
+
+  gst_check_init (&argc, &argv);
+
+  s = budget_suite ();
+  sr = srunner_create (s);
+  srunner_run_all (sr, CK_NORMAL);
+  nf = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return (nf == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include "gstomx_buffer_pool.h"
+
+#include <string.h>             /* for memset */
+
+/* modification: output buffers handed back to the pool on their last unref,
+ * and the free ones dropped when the output size changes */
+
+#define LIMIT 4
+#define SIZE 100
+
+GST_START_TEST (test_buffer_pool_recycle)
+{
+  GstOmxBufferPool *pool;
+  GstBuffer *buf, *again;
+  guint8 *data;
+
+  pool = gstomx_buffer_pool_new ();
+  gstomx_buffer_pool_set_limit (pool, LIMIT);
+
+  buf = gstomx_buffer_pool_get (pool, SIZE);
+  fail_unless_equals_int (GST_BUFFER_SIZE (buf), SIZE);
+  data = GST_BUFFER_DATA (buf);
+
+  /* what users change is reset on the way back */
+  GST_BUFFER_TIMESTAMP (buf) = 10;
+  GST_BUFFER_DURATION (buf) = 20;
+  GST_BUFFER_OFFSET (buf) = 30;
+  GST_BUFFER_DATA (buf) = data + 1;
+  GST_BUFFER_SIZE (buf) = SIZE / 2;
+  GST_BUFFER_FLAG_SET (buf, GST_BUFFER_FLAG_DISCONT);
+  gst_buffer_unref (buf);
+  fail_unless_equals_int (pool->n_free, 1);
+  fail_unless_equals_int (pool->n_buffers, 1);
+
+  again = gstomx_buffer_pool_get (pool, SIZE);
+  fail_unless (again == buf);
+  fail_unless_equals_int (pool->allocations, 1);
+  fail_unless_equals_int (pool->n_free, 0);
+  fail_unless (GST_BUFFER_DATA (again) == data);
+  fail_unless_equals_int (GST_BUFFER_SIZE (again), SIZE);
+  fail_unless (GST_BUFFER_TIMESTAMP (again) == GST_CLOCK_TIME_NONE);
+  fail_unless (GST_BUFFER_DURATION (again) == GST_CLOCK_TIME_NONE);
+  fail_unless (GST_BUFFER_OFFSET (again) == GST_BUFFER_OFFSET_NONE);
+  fail_if (GST_BUFFER_FLAG_IS_SET (again, GST_BUFFER_FLAG_DISCONT));
+
+  gst_buffer_unref (again);
+  gstomx_buffer_pool_close (pool);
+}
+
+GST_END_TEST
+GST_START_TEST (test_buffer_pool_limit)
+{
+  GstOmxBufferPool *pool;
+  GstBuffer *bufs[LIMIT + 2];
+  guint i;
+
+  pool = gstomx_buffer_pool_new ();
+  gstomx_buffer_pool_set_limit (pool, LIMIT);
+
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++)
+    bufs[i] = gstomx_buffer_pool_get (pool, SIZE);
+  fail_unless_equals_int (pool->allocations, LIMIT + 2);
+  fail_unless_equals_int (pool->peak, LIMIT + 2);
+
+  /* past the limit returned buffers are freed */
+  for (i = 0; i < G_N_ELEMENTS (bufs); i++)
+    gst_buffer_unref (bufs[i]);
+  fail_unless_equals_int (pool->n_free, LIMIT);
+  fail_unless_equals_int (pool->n_buffers, LIMIT);
+
+  gstomx_buffer_pool_close (pool);
+}
+
+GST_END_TEST
+GST_START_TEST (test_buffer_pool_size_change)
+{
+  GstOmxBufferPool *pool;
+  GstBuffer *a, *b, *out;
+
+  pool = gstomx_buffer_pool_new ();
+  gstomx_buffer_pool_set_limit (pool, LIMIT);
+
+  a = gstomx_buffer_pool_get (pool, SIZE);
+  b = gstomx_buffer_pool_get (pool, SIZE);
+  out = gstomx_buffer_pool_get (pool, SIZE);
+  gst_buffer_unref (a);
+  gst_buffer_unref (b);
+  fail_unless_equals_int (pool->n_free, 2);
+  fail_unless_equals_int (pool->n_buffers, 3);
+
+  /* the free buffers of the old size are dropped */
+  a = gstomx_buffer_pool_get (pool, 2 * SIZE);
+  fail_unless_equals_int (GST_BUFFER_SIZE (a), 2 * SIZE);
+  fail_unless_equals_int (pool->size, 2 * SIZE);
+  fail_unless_equals_int (pool->n_free, 0);
+  fail_unless_equals_int (pool->allocations, 4);
+  fail_unless_equals_int (pool->n_buffers, 2);
+
+  /* and so is one of the old size still out when it comes back */
+  gst_buffer_unref (out);
+  fail_unless_equals_int (pool->n_free, 0);
+  fail_unless_equals_int (pool->n_buffers, 1);
+
+  gst_buffer_unref (a);
+  fail_unless_equals_int (pool->n_free, 1);
+
+  gstomx_buffer_pool_close (pool);
+}
+
+GST_END_TEST
+GST_START_TEST (test_buffer_pool_close)
+{
+  GstOmxBufferPool *pool;
+  GstBuffer *buf;
+
+  pool = gstomx_buffer_pool_new ();
+  gstomx_buffer_pool_set_limit (pool, LIMIT);
+
+  buf = gstomx_buffer_pool_get (pool, SIZE);
+  gst_buffer_unref (gstomx_buffer_pool_get (pool, SIZE));
+
+  /* the pool stays until its last buffer is back */
+  gstomx_buffer_pool_close (pool);
+  memset (GST_BUFFER_DATA (buf), 0, GST_BUFFER_SIZE (buf));
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST static Suite *
+buffer_pool_suite (void)
+{
+  Suite *s = suite_create ("buffer_pool");
+  TCase *tc_chain = tcase_create ("general");
+
+  tcase_add_test (tc_chain, test_buffer_pool_recycle);
+  tcase_add_test (tc_chain, test_buffer_pool_limit);
+  tcase_add_test (tc_chain, test_buffer_pool_size_change);
+  tcase_add_test (tc_chain, test_buffer_pool_close);
+  suite_add_tcase (s, tc_chain);
+
+  return s;
+}
+
+GST_CHECK_MAIN (buffer_pool);
@@ -0,0 +1,225 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <check.h>
+#include "gstomx_colorspace.h"
+
+#include <string.h>             /* for memset */
+
+#define FOURCC_I420 GST_MAKE_FOURCC ('I', '4', '2', '0')
+#define FOURCC_NV12 GST_MAKE_FOURCC ('N', 'V', '1', '2')
+#define FOURCC_YUY2 GST_MAKE_FOURCC ('Y', 'U', 'Y', '2')
+#define FOURCC_UYVY GST_MAKE_FOURCC ('U', 'Y', 'V', 'Y')
+
+/* modification: sample values telling the plane and the place in it */
+#define LUMA(x, y) ((guint8) ((y) * 16 + (x)))
+#define CB(x, y) ((guint8) (128 + (y) * 16 + (x)))
+#define CR(x, y) ((guint8) (192 + (y) * 16 + (x)))
+
+static void
+check_nv12 (const guint8 * dst, const GstOmxFrameLayout * d)
+{
+  guint x, y;
+
+  for (y = 0; y < d->height; y++) {
+    for (x = 0; x < d->width; x++)
+      fail_if (dst[d->offset[0] + y * d->stride[0] + x] != LUMA (x, y),
+          "%ux%u: luma %u,%u wrong", d->width, d->height, x, y);
+  }
+
+  for (y = 0; y < (d->height + 1) / 2; y++) {
+    for (x = 0; x < (d->width + 1) / 2; x++) {
+      const guint8 *uv = dst + d->offset[1] + y * d->stride[1] + 2 * x;
+
+      fail_if (uv[0] != CB (x, y) || uv[1] != CR (x, y),
+          "%ux%u: chroma %u,%u wrong", d->width, d->height, x, y);
+    }
+  }
+}
+
+static void
+i420_to_nv12 (guint width, guint height)
+{
+  GstOmxFrameLayout s, d;
+  guint8 *src, *dst;
+  guint x, y;
+
+  fail_unless (gstomx_frame_layout_caps (&s, FOURCC_I420, width, height));
+  fail_unless (gstomx_frame_layout_caps (&d, FOURCC_NV12, width, height));
+
+  src = g_malloc0 (s.size);
+  dst = g_malloc0 (d.size);
+
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++)
+      src[s.offset[0] + y * s.stride[0] + x] = LUMA (x, y);
+  }
+  for (y = 0; y < (height + 1) / 2; y++) {
+    for (x = 0; x < (width + 1) / 2; x++) {
+      src[s.offset[1] + y * s.stride[1] + x] = CB (x, y);
+      src[s.offset[2] + y * s.stride[2] + x] = CR (x, y);
+    }
+  }
+
+  fail_unless (gstomx_frame_copy (dst, &d, src, &s));
+  check_nv12 (dst, &d);
+
+  g_free (dst);
+  g_free (src);
+}
+
+START_TEST (test_colorspace_i420_to_nv12)
+{
+  i420_to_nv12 (8, 4);
+  i420_to_nv12 (5, 3);
+}
+
+END_TEST
+START_TEST (test_colorspace_packed_to_nv12)
+{
+  GstOmxFrameLayout s, d;
+  guint8 src[3 * 8], dst[64];
+  guint32 fourcc[] = { FOURCC_YUY2, FOURCC_UYVY };
+  guint i, x, y;
+
+  /* 4x3: the first row pair is averaged, the last row is taken alone */
+  for (i = 0; i < G_N_ELEMENTS (fourcc); i++) {
+    guint y0 = fourcc[i] == FOURCC_UYVY;
+
+    fail_unless (gstomx_frame_layout_caps (&s, fourcc[i], 4, 3));
+    fail_unless (gstomx_frame_layout_caps (&d, FOURCC_NV12, 4, 3));
+    fail_unless (s.size <= sizeof (src) && d.size <= sizeof (dst));
+
+    for (y = 0; y < 3; y++) {
+      for (x = 0; x < 4; x++)
+        src[y * s.stride[0] + 2 * x + y0] = LUMA (x, y);
+      for (x = 0; x < 2; x++) {
+        src[y * s.stride[0] + 4 * x + (y0 ^ 1)] = 10 * y + x;
+        src[y * s.stride[0] + 4 * x + 2 + (y0 ^ 1)] = 100 + 10 * y + x;
+      }
+    }
+
+    memset (dst, 0, sizeof (dst));
+    fail_unless (gstomx_frame_copy (dst, &d, src, &s));
+
+    for (y = 0; y < 3; y++) {
+      for (x = 0; x < 4; x++)
+        fail_if (dst[y * d.stride[0] + x] != LUMA (x, y), "luma %u,%u wrong",
+            x, y);
+    }
+
+    for (x = 0; x < 2; x++) {
+      const guint8 *uv = dst + d.offset[1];
+
+      /* (0 + 10 + 1) / 2 and (100 + 110 + 1) / 2 */
+      fail_if (uv[2 * x] != 5 + x || uv[2 * x + 1] != 105 + x,
+          "first chroma row %u wrong", x);
+      fail_if (uv[d.stride[1] + 2 * x] != 20 + x ||
+          uv[d.stride[1] + 2 * x + 1] != 120 + x,
+          "last chroma row %u wrong", x);
+    }
+  }
+}
+
+END_TEST
+START_TEST (test_colorspace_repack)
+{
+  GstOmxFrameLayout caps, port, crop;
+  guint8 *src, *padded, *back;
+  guint x, y;
+
+  fail_unless (gstomx_frame_layout_caps (&caps, FOURCC_NV12, 6, 4));
+  fail_unless (gstomx_frame_layout_port (&port, FOURCC_NV12, 6, 4, 16, 8));
+  fail_if (gstomx_frame_layout_equal (&caps, &port));
+  fail_if (port.stride[0] != 16 || port.offset[1] != 16 * 8 ||
+      port.size != 16 * 8 + 16 * 4, "wrong port layout");
+
+  src = g_malloc0 (caps.size);
+  padded = g_malloc (port.size);
+  back = g_malloc0 (caps.size);
+  memset (padded, 0xee, port.size);
+
+  for (y = 0; y < 4; y++) {
+    for (x = 0; x < 6; x++)
+      src[y * caps.stride[0] + x] = LUMA (x, y);
+  }
+  for (y = 0; y < 2; y++) {
+    for (x = 0; x < 3; x++) {
+      src[caps.offset[1] + y * caps.stride[1] + 2 * x] = CB (x, y);
+      src[caps.offset[1] + y * caps.stride[1] + 2 * x + 1] = CR (x, y);
+    }
+  }
+
+  /* into the padded port layout, leaving the padding alone */
+  fail_unless (gstomx_frame_copy (padded, &port, src, &caps));
+  check_nv12 (padded, &port);
+  fail_if (padded[6] != 0xee || padded[4 * 16] != 0xee,
+      "padding written");
+
+  /* and back */
+  fail_unless (gstomx_frame_copy (back, &caps, padded, &port));
+  check_nv12 (back, &caps);
+
+  /* a crop keeps chroma sited on even offsets */
+  crop = port;
+  gstomx_frame_layout_crop (&crop, 3, 1, 2, 2);
+  fail_if (crop.offset[0] != 0 * 16 + 2 || crop.offset[1] != 16 * 8 + 2,
+      "wrong crop offsets");
+  fail_if (crop.width != 2 || crop.height != 2, "wrong crop size");
+
+  /* the picture ends in the chroma plane, before the port padding */
+  fail_if (gstomx_frame_layout_end (&port) != 16 * 8 + 16 + 6,
+      "wrong port end");
+  fail_if (gstomx_frame_layout_end (&crop) != 16 * 8 + 2 + 2,
+      "wrong crop end");
+
+  g_free (back);
+  g_free (padded);
+  g_free (src);
+}
+
+END_TEST static Suite *
+colorspace_suite (void)
+{
+  Suite *s = suite_create ("colorspace");
+
+  TCase *tc_core = tcase_create ("Core");
+  tcase_add_test (tc_core, test_colorspace_i420_to_nv12);
+  tcase_add_test (tc_core, test_colorspace_packed_to_nv12);
+  tcase_add_test (tc_core, test_colorspace_repack);
+  suite_add_tcase (s, tc_core);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = colorspace_suite ();
+  sr = srunner_create (s);
+  srunner_run_all (sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return (number_failed == 0) ? 0 : 1;
+}
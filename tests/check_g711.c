@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <check.h>
+#include "gstomx_g711.h"
+
+/* modification: the inline G.711 tables against the ITU-T G.711 reference
+ * coder, as distributed with the recommendation's software tools */
+
+static const gint16 seg_aend[8] = { 0x1f, 0x3f, 0x7f, 0xff,
+  0x1ff, 0x3ff, 0x7ff, 0xfff
+};
+
+static const gint16 seg_uend[8] = { 0x3f, 0x7f, 0xff, 0x1ff,
+  0x3ff, 0x7ff, 0xfff, 0x1fff
+};
+
+static gint
+search (gint val, const gint16 * table, gint size)
+{
+  gint i;
+
+  for (i = 0; i < size; i++) {
+    if (val <= table[i])
+      return i;
+  }
+  return size;
+}
+
+static guint8
+reference_linear2alaw (gint16 pcm_val)
+{
+  gint mask, seg;
+  guint8 aval;
+
+  pcm_val = pcm_val >> 3;
+
+  if (pcm_val >= 0) {
+    mask = 0xd5;
+  } else {
+    mask = 0x55;
+    pcm_val = -pcm_val - 1;
+  }
+
+  seg = search (pcm_val, seg_aend, 8);
+  if (seg >= 8)
+    return 0x7f ^ mask;
+
+  aval = seg << 4;
+  if (seg < 2)
+    aval |= (pcm_val >> 1) & 0xf;
+  else
+    aval |= (pcm_val >> seg) & 0xf;
+  return aval ^ mask;
+}
+
+static guint8
+reference_linear2ulaw (gint16 pcm_val)
+{
+  gint mask, seg;
+  guint8 uval;
+
+  pcm_val = pcm_val >> 2;
+  if (pcm_val < 0) {
+    pcm_val = -pcm_val;
+    mask = 0x7f;
+  } else {
+    mask = 0xff;
+  }
+  if (pcm_val > 8159)
+    pcm_val = 8159;
+  pcm_val += 0x84 >> 2;
+
+  seg = search (pcm_val, seg_uend, 8);
+  if (seg >= 8)
+    return 0x7f ^ mask;
+
+  uval = (seg << 4) | ((pcm_val >> (seg + 1)) & 0xf);
+  return uval ^ mask;
+}
+
+START_TEST (test_g711_reference_values)
+{
+  const guint8 codes[] = { 0xff, 0x80, 0x00, 0xd5, 0x55, 0xaa, 0x2a };
+  gint16 samples[G_N_ELEMENTS (codes)];
+  guint8 out[3];
+  const gint16 extremes[] = { 0, G_MAXINT16, G_MININT16 };
+
+  gstomx_g711_init ();
+
+  gstomx_g711_decode (samples, codes, 3, FALSE);
+  fail_if (samples[0] != 0, "mu-law 0xff decoded to %d", samples[0]);
+  fail_if (samples[1] != 32124, "mu-law 0x80 decoded to %d", samples[1]);
+  fail_if (samples[2] != -32124, "mu-law 0x00 decoded to %d", samples[2]);
+
+  gstomx_g711_decode (samples, codes + 3, 4, TRUE);
+  fail_if (samples[0] != 8, "A-law 0xd5 decoded to %d", samples[0]);
+  fail_if (samples[1] != -8, "A-law 0x55 decoded to %d", samples[1]);
+  fail_if (samples[2] != 32256, "A-law 0xaa decoded to %d", samples[2]);
+  fail_if (samples[3] != -32256, "A-law 0x2a decoded to %d", samples[3]);
+
+  gstomx_g711_encode (out, extremes, 3, FALSE);
+  fail_if (out[0] != 0xff || out[1] != 0x80 || out[2] != 0x00,
+      "mu-law extremes encoded wrong");
+
+  gstomx_g711_encode (out, extremes, 3, TRUE);
+  fail_if (out[0] != 0xd5 || out[1] != 0xaa || out[2] != 0x2a,
+      "A-law extremes encoded wrong");
+}
+
+END_TEST
+START_TEST (test_g711_encode_reference)
+{
+  gint16 *samples;
+  guint8 *ulaw, *alaw;
+  guint i;
+
+  gstomx_g711_init ();
+
+  samples = g_new (gint16, 0x10000);
+  ulaw = g_new (guint8, 0x10000);
+  alaw = g_new (guint8, 0x10000);
+
+  for (i = 0; i < 0x10000; i++)
+    samples[i] = (gint16) (i - 0x8000);
+
+  gstomx_g711_encode (ulaw, samples, 0x10000, FALSE);
+  gstomx_g711_encode (alaw, samples, 0x10000, TRUE);
+
+  for (i = 0; i < 0x10000; i++) {
+    fail_if (ulaw[i] != reference_linear2ulaw (samples[i]),
+        "mu-law code of %d differs from the reference", samples[i]);
+    fail_if (alaw[i] != reference_linear2alaw (samples[i]),
+        "A-law code of %d differs from the reference", samples[i]);
+  }
+
+  g_free (alaw);
+  g_free (ulaw);
+  g_free (samples);
+}
+
+END_TEST
+START_TEST (test_g711_round_trip)
+{
+  guint8 codes[256], out[256];
+  gint16 samples[256];
+  guint i;
+
+  gstomx_g711_init ();
+
+  for (i = 0; i < 256; i++)
+    codes[i] = i;
+
+  gstomx_g711_decode (samples, codes, 256, FALSE);
+  gstomx_g711_encode (out, samples, 256, FALSE);
+  for (i = 0; i < 256; i++) {
+    /* 0x7f is the negative zero, which comes back positive */
+    fail_if (out[i] != (i == 0x7f ? 0xff : i),
+        "mu-law code %02x came back as %02x", i, out[i]);
+  }
+
+  gstomx_g711_decode (samples, codes, 256, TRUE);
+  gstomx_g711_encode (out, samples, 256, TRUE);
+  for (i = 0; i < 256; i++)
+    fail_if (out[i] != i, "A-law code %02x came back as %02x", i, out[i]);
+}
+
+END_TEST static Suite *
+g711_suite (void)
+{
+  Suite *s = suite_create ("g711");
+
+  TCase *tc_core = tcase_create ("Core");
+  tcase_add_test (tc_core, test_g711_reference_values);
+  tcase_add_test (tc_core, test_g711_encode_reference);
+  tcase_add_test (tc_core, test_g711_round_trip);
+  suite_add_tcase (s, tc_core);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = g711_suite ();
+  sr = srunner_create (s);
+  srunner_run_all (sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return (number_failed == 0) ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+#include "gstomx_ring.h"
+
+#include <string.h>             /* for memset */
+
+/* modification: the input accumulator, lending regions of its blocks and
+ * moving the pending bytes when a block is held */
+
+#define CAPACITY 8
+
+/* size bytes of value, with the given timing */
+static GstBuffer *
+make_buffer (guint size, guint8 value, GstClockTime timestamp,
+    GstClockTime duration)
+{
+  GstBuffer *buf = gst_buffer_new_and_alloc (size);
+
+  memset (GST_BUFFER_DATA (buf), value, size);
+  GST_BUFFER_TIMESTAMP (buf) = timestamp;
+  GST_BUFFER_DURATION (buf) = duration;
+
+  return buf;
+}
+
+static gboolean
+all_bytes (const guint8 * data, guint size, guint8 value)
+{
+  guint i;
+
+  for (i = 0; i < size; i++) {
+    if (data[i] != value)
+      return FALSE;
+  }
+  return TRUE;
+}
+
+GST_START_TEST (test_ring_peek_take)
+{
+  GstOmxRing ring;
+  GstBuffer *region;
+
+  gstomx_ring_init (&ring, CAPACITY);
+  fail_unless (gstomx_ring_peek (&ring) == NULL);
+
+  gstomx_ring_push (&ring, make_buffer (3, 0x11, 10, 5));
+  gstomx_ring_push (&ring, make_buffer (2, 0x22, 20, 5));
+
+  fail_unless_equals_int (gstomx_ring_available (&ring), 5);
+  fail_unless (all_bytes (gstomx_ring_peek (&ring), 3, 0x11));
+  fail_unless (all_bytes (gstomx_ring_peek (&ring) + 3, 2, 0x22));
+  fail_unless (ring.timestamp == 10);
+  fail_unless (ring.duration == 10);
+
+  region = gstomx_ring_take (&ring);
+  fail_unless_equals_int (GST_BUFFER_SIZE (region), 5);
+  fail_unless (GST_BUFFER_TIMESTAMP (region) == 10);
+  fail_unless (GST_BUFFER_DURATION (region) == 10);
+  fail_unless (all_bytes (GST_BUFFER_DATA (region), 3, 0x11));
+  fail_unless_equals_int (gstomx_ring_available (&ring), 0);
+  fail_unless (ring.timestamp == GST_CLOCK_TIME_NONE);
+  fail_unless (ring.duration == 0);
+
+  gst_buffer_unref (region);
+  gstomx_ring_free (&ring);
+}
+
+GST_END_TEST
+GST_START_TEST (test_ring_wraparound)
+{
+  GstOmxRing ring;
+  GstBuffer *first, *second, *region, *held;
+
+  gstomx_ring_init (&ring, CAPACITY);
+
+  /* a region lent from the first block keeps it from being rewound */
+  gstomx_ring_push (&ring, make_buffer (5, 0x11, 0, 1));
+  first = ring.block;
+  held = gstomx_ring_take (&ring);
+
+  gstomx_ring_push (&ring, make_buffer (6, 0x22, 1, 1));
+  second = ring.block;
+  fail_if (second == first, "pushed over a held region");
+  fail_unless (ring.spare == first);
+  fail_unless (all_bytes (GST_BUFFER_DATA (held), 5, 0x11));
+  fail_unless (all_bytes (gstomx_ring_peek (&ring), 6, 0x22));
+
+  /* with everything released the block is rewound in place */
+  region = gstomx_ring_take (&ring);
+  gst_buffer_unref (region);
+  gst_buffer_unref (held);
+
+  gstomx_ring_push (&ring, make_buffer (4, 0x33, 2, 1));
+  fail_unless (ring.block == second);
+  fail_unless_equals_int (ring.start, 0);
+  fail_unless (all_bytes (gstomx_ring_peek (&ring), 4, 0x33));
+
+  /* pending bytes move to the released spare when the block is held */
+  gstomx_ring_push (&ring, make_buffer (1, 0x44, 3, 1));
+  held = gstomx_ring_take (&ring);
+  gstomx_ring_push (&ring, make_buffer (2, 0x55, 4, 1));
+  gstomx_ring_push (&ring, make_buffer (6, 0x66, 5, 1));
+  fail_unless (ring.block == first);
+  fail_unless (ring.spare == second);
+  fail_unless_equals_int (gstomx_ring_available (&ring), 8);
+  fail_unless (all_bytes (gstomx_ring_peek (&ring), 2, 0x55));
+  fail_unless (all_bytes (gstomx_ring_peek (&ring) + 2, 6, 0x66));
+  fail_unless (all_bytes (GST_BUFFER_DATA (held), 4, 0x33));
+  fail_unless (ring.timestamp == 4);
+  fail_unless (ring.duration == 2);
+
+  gst_buffer_unref (held);
+  gstomx_ring_free (&ring);
+}
+
+GST_END_TEST
+GST_START_TEST (test_ring_clear)
+{
+  GstOmxRing ring;
+
+  gstomx_ring_init (&ring, CAPACITY);
+
+  gstomx_ring_push (&ring, make_buffer (3, 0x11, 10, 5));
+  gstomx_ring_clear (&ring);
+  fail_unless_equals_int (gstomx_ring_available (&ring), 0);
+  fail_unless (ring.timestamp == GST_CLOCK_TIME_NONE);
+  fail_unless (ring.duration == 0);
+
+  /* the next push starts over */
+  gstomx_ring_push (&ring, make_buffer (2, 0x22, 20, 5));
+  fail_unless_equals_int (gstomx_ring_available (&ring), 2);
+  fail_unless (all_bytes (gstomx_ring_peek (&ring), 2, 0x22));
+  fail_unless (ring.timestamp == 20);
+
+  gstomx_ring_free (&ring);
+}
+
+GST_END_TEST static Suite *
+ring_suite (void)
+{
+  Suite *s = suite_create ("ring");
+  TCase *tc_chain = tcase_create ("general");
+
+  tcase_add_test (tc_chain, test_ring_peek_take);
+  tcase_add_test (tc_chain, test_ring_wraparound);
+  tcase_add_test (tc_chain, test_ring_clear);
+  suite_add_tcase (s, tc_chain);
+
+  return s;
+}
+
+GST_CHECK_MAIN (ring);
@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <check.h>
+#include "gstomx_base_videodec.h"
+#include "gstomx_h264.h"
+
+/* modification: the scanners behind find_frame_start against a byte by byte
+ * search, on data with start codes and zero runs in random places */
+
+#define DATA_SIZE 256
+#define ROUNDS 2000
+
+static guint
+naive_start_code (const guint8 * data, guint size)
+{
+  guint i;
+
+  for (i = 0; i + 2 < size; i++) {
+    if (data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 1)
+      return i;
+  }
+  return size;
+}
+
+static guint
+naive_zero_pair (const guint8 * data, guint limit, guint pos)
+{
+  for (; pos < limit; pos++) {
+    if (data[pos] == 0 && data[pos + 1] == 0)
+      return pos;
+  }
+  return limit;
+}
+
+/* mostly non-zero bytes, with zeros, ones and whole start codes mixed in */
+static void
+fill_stream (GRand * rand, guint8 * data, guint size)
+{
+  guint i;
+
+  for (i = 0; i < size; i++) {
+    switch (g_rand_int_range (rand, 0, 8)) {
+      case 0:
+      case 1:
+        data[i] = 0;
+        break;
+      case 2:
+        data[i] = 1;
+        break;
+      default:
+        data[i] = g_rand_int_range (rand, 2, 256);
+        break;
+    }
+  }
+
+  if (size >= 3 && g_rand_boolean (rand)) {
+    i = g_rand_int_range (rand, 0, size - 2);
+    data[i] = data[i + 1] = 0;
+    data[i + 2] = 1;
+  }
+}
+
+START_TEST (test_h264_start_code)
+{
+  static const guint8 stream[] = { 0x00, 0x00, 0x00, 0x01, 0x67, 0x00,
+    0x00, 0x01, 0x68
+  };
+  guint8 data[DATA_SIZE];
+  GRand *rand;
+  guint i;
+
+  fail_if (gstomx_h264_find_start_code (stream, sizeof (stream)) != 1,
+      "four byte start code not found");
+  fail_if (gstomx_h264_find_start_code (stream + 2, sizeof (stream) - 2) != 3,
+      "second start code not found");
+  fail_if (gstomx_h264_find_start_code (stream, 2) != 2,
+      "found a start code in two bytes");
+
+  rand = g_rand_new_with_seed (27);
+
+  for (i = 0; i < ROUNDS; i++) {
+    guint size = g_rand_int_range (rand, 3, DATA_SIZE + 1);
+    guint from = g_rand_int_range (rand, 0, size);
+
+    fill_stream (rand, data, size);
+    fail_if (gstomx_h264_find_start_code (data + from, size - from) !=
+        naive_start_code (data + from, size - from),
+        "round %u: start codes differ", i);
+  }
+
+  g_rand_free (rand);
+}
+
+END_TEST
+START_TEST (test_zero_pair)
+{
+  static const guint8 stream[] = { 0x12, 0x00, 0x34, 0x56, 0x78, 0x00,
+    0x00, 0x80, 0x02, 0x00
+  };
+  guint8 data[DATA_SIZE + 1];
+  GRand *rand;
+  guint i;
+
+  fail_if (gstomx_video_find_zero_pair (stream, 9, 0) != 5,
+      "zero pair not found");
+  fail_if (gstomx_video_find_zero_pair (stream, 9, 6) != 9,
+      "found a zero pair past the last one");
+  /* a pair may end at data[limit], but not start there */
+  fail_if (gstomx_video_find_zero_pair (stream, 6, 0) != 5,
+      "zero pair ending at the limit not found");
+  fail_if (gstomx_video_find_zero_pair (stream, 5, 0) != 5,
+      "zero pair starting at the limit found");
+
+  rand = g_rand_new_with_seed (28);
+
+  for (i = 0; i < ROUNDS; i++) {
+    guint limit = g_rand_int_range (rand, 1, DATA_SIZE);
+    guint pos = g_rand_int_range (rand, 0, limit);
+
+    fill_stream (rand, data, limit + 1);
+    fail_if (gstomx_video_find_zero_pair (data, limit, pos) !=
+        naive_zero_pair (data, limit, pos), "round %u: zero pairs differ", i);
+  }
+
+  g_rand_free (rand);
+}
+
+END_TEST static Suite *
+start_code_suite (void)
+{
+  Suite *s = suite_create ("start_code");
+
+  TCase *tc_core = tcase_create ("Core");
+  tcase_add_test (tc_core, test_h264_start_code);
+  tcase_add_test (tc_core, test_zero_pair);
+  suite_add_tcase (s, tc_core);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = start_code_suite ();
+  sr = srunner_create (s);
+  srunner_run_all (sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return (number_failed == 0) ? 0 : 1;
+}
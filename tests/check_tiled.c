@@ -0,0 +1,145 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <check.h>
+#include "gstomx_tiled.h"
+
+#include <string.h>             /* for memset */
+
+/* modification: frames of four tile columns and two tile rows of luma, one
+ * row of chroma; luma tiles are stored in Z order for the first column pair
+ * and in flipped Z order for the second, the single chroma row linearly */
+static const guint luma_tiles[2][4] = {
+  {0, 1, 6, 7},
+  {2, 3, 4, 5},
+};
+
+#define CHROMA_OFFSET (8 * GSTOMX_TILE_SIZE)
+
+static guint8
+tile_byte (guint tile, guint x, guint y)
+{
+  return tile * 37 + y * 3 + x;
+}
+
+/* fill every tile with bytes telling the tile and the place in it */
+static void
+fill_tiles (guint8 * src, guint n_tiles)
+{
+  guint t, x, y;
+
+  for (t = 0; t < n_tiles; t++) {
+    for (y = 0; y < GSTOMX_TILE_HEIGHT; y++) {
+      for (x = 0; x < GSTOMX_TILE_WIDTH; x++)
+        src[t * GSTOMX_TILE_SIZE + y * GSTOMX_TILE_WIDTH + x] =
+            tile_byte (t, x, y);
+    }
+  }
+}
+
+static void
+check_frame (guint width, guint height)
+{
+  guint stride = GST_ROUND_UP_4 (width);
+  guint8 *src, *dst;
+  gsize dst_size;
+  guint x, y;
+
+  fail_if (gstomx_nv12t_size (width, height) != CHROMA_OFFSET +
+      4 * GSTOMX_TILE_SIZE, "%ux%u: wrong tiled size", width, height);
+
+  src = g_malloc (gstomx_nv12t_size (width, height));
+  fill_tiles (src, 8);
+  fill_tiles (src + CHROMA_OFFSET, 4);
+
+  /* a guard byte past the frame catches writes beyond it */
+  dst_size = gstomx_nv12_size (width, height);
+  dst = g_malloc (dst_size + 1);
+  memset (dst, 0xee, dst_size + 1);
+
+  gstomx_nv12t_to_nv12 (dst, src, width, height);
+
+  for (y = 0; y < height; y++) {
+    for (x = 0; x < width; x++) {
+      guint tile = luma_tiles[y / GSTOMX_TILE_HEIGHT][x / GSTOMX_TILE_WIDTH];
+
+      fail_if (dst[y * stride + x] != tile_byte (tile, x % GSTOMX_TILE_WIDTH,
+              y % GSTOMX_TILE_HEIGHT), "%ux%u: luma %u,%u misplaced",
+          width, height, x, y);
+    }
+  }
+
+  for (y = 0; y < (height + 1) / 2; y++) {
+    for (x = 0; x < GST_ROUND_UP_2 (width); x++) {
+      guint8 *uv = dst + stride * GST_ROUND_UP_2 (height);
+
+      fail_if (uv[y * stride + x] != tile_byte (x / GSTOMX_TILE_WIDTH,
+              x % GSTOMX_TILE_WIDTH, y), "%ux%u: chroma %u,%u misplaced",
+          width, height, x, y);
+    }
+  }
+
+  fail_if (dst[dst_size] != 0xee, "%ux%u: written past the frame", width,
+      height);
+
+  g_free (dst);
+  g_free (src);
+}
+
+START_TEST (test_tiled_whole_tiles)
+{
+  check_frame (256, 64);
+}
+
+END_TEST
+START_TEST (test_tiled_partial_tiles)
+{
+  /* the last tile column and tile row are cut by the picture */
+  check_frame (200, 40);
+  check_frame (194, 34);
+}
+
+END_TEST static Suite *
+tiled_suite (void)
+{
+  Suite *s = suite_create ("tiled");
+
+  TCase *tc_core = tcase_create ("Core");
+  tcase_add_test (tc_core, test_tiled_whole_tiles);
+  tcase_add_test (tc_core, test_tiled_partial_tiles);
+  suite_add_tcase (s, tc_core);
+
+  return s;
+}
+
+int
+main (void)
+{
+  int number_failed;
+  Suite *s;
+  SRunner *sr;
+
+  s = tiled_suite ();
+  sr = srunner_create (s);
+  srunner_run_all (sr, CK_NORMAL);
+  number_failed = srunner_ntests_failed (sr);
+  srunner_free (sr);
+
+  return (number_failed == 0) ? 0 : 1;
+}
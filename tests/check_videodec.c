@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+#include <gst/check/gstcheck.h>
+
+#include <string.h>             /* for memcpy, memset */
+
+/* modification: the decoder base class against the libomxil-foo.so
+ * stand-in, which hands every input buffer back as an output buffer */
+
+#define PARSED_CAPS "video/mpeg, mpegversion=(int)4, " \
+    "systemstream=(boolean)false, parsed=(boolean)true, " \
+    "width=(int)16, height=(int)16, framerate=(fraction)2/1"
+#define MPEG4_CAPS "video/mpeg, mpegversion=(int)4, " \
+    "systemstream=(boolean)false, width=(int)16, height=(int)16, " \
+    "framerate=(fraction)2/1"
+#define H264_CAPS "video/x-h264, width=(int)16, height=(int)16, " \
+    "framerate=(fraction)2/1"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS_ANY);
+
+/* some global vars, makes it easy as for the ones above */
+static GMutex *eos_mutex;
+static GCond *eos_cond;
+static gboolean eos_arrived;
+
+static GstPad *mysrcpad, *mysinkpad;
+static GstCaps *input_caps;
+static GstBus *bus;
+
+static gboolean
+test_sink_event (GstPad * pad, GstEvent * event)
+{
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_EOS:
+      g_mutex_lock (eos_mutex);
+      eos_arrived = TRUE;
+      g_cond_signal (eos_cond);
+      g_mutex_unlock (eos_mutex);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, event);
+}
+
+static GstElement *
+setup_decoder (const gchar * name, const gchar * caps)
+{
+  GstElement *filter;
+
+  filter = gst_check_setup_element (name);
+  mysrcpad = gst_check_setup_src_pad (filter, &srctemplate, NULL);
+  mysinkpad = gst_check_setup_sink_pad (filter, &sinktemplate, NULL);
+
+  gst_pad_set_active (mysrcpad, TRUE);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  /* need to know when we are eos */
+  gst_pad_set_event_function (mysinkpad, test_sink_event);
+
+  eos_mutex = g_mutex_new ();
+  eos_cond = g_cond_new ();
+  eos_arrived = FALSE;
+
+  input_caps = gst_caps_from_string (caps);
+
+  fail_unless_equals_int (gst_element_set_state (filter, GST_STATE_PLAYING),
+      GST_STATE_CHANGE_SUCCESS);
+
+  bus = gst_bus_new ();
+  gst_element_set_bus (filter, bus);
+
+  return filter;
+}
+
+static void
+push_data (const guint8 * data, guint size, GstClockTime timestamp)
+{
+  GstBuffer *inbuffer;
+
+  inbuffer = gst_buffer_new_and_alloc (size);
+  memcpy (GST_BUFFER_DATA (inbuffer), data, size);
+  GST_BUFFER_TIMESTAMP (inbuffer) = timestamp;
+  gst_buffer_set_caps (inbuffer, input_caps);
+
+  fail_unless (gst_pad_push (mysrcpad, inbuffer) == GST_FLOW_OK);
+}
+
+/* push the stream in pieces of chunk bytes, so start codes straddle them */
+static void
+push_stream (const guint8 * stream, guint size, guint chunk)
+{
+  guint offset;
+
+  for (offset = 0; offset < size; offset += chunk)
+    push_data (stream + offset, MIN (chunk, size - offset),
+        GST_CLOCK_TIME_NONE);
+}
+
+/* one output buffer per picture, in order */
+static void
+check_pictures (const guint8 * const *pictures, const guint * sizes, guint n)
+{
+  GList *cur;
+  guint i;
+
+  fail_unless_equals_int (g_list_length (buffers), n);
+  for (cur = buffers, i = 0; cur; cur = g_list_next (cur), i++) {
+    GstBuffer *buffer = cur->data;
+
+    fail_unless_equals_int (GST_BUFFER_SIZE (buffer), sizes[i]);
+    fail_unless (memcmp (GST_BUFFER_DATA (buffer), pictures[i],
+            sizes[i]) == 0);
+  }
+}
+
+/* push EOS and wait until the decoder forwarded it */
+static void
+drain_decoder (void)
+{
+  GstMessage *message;
+
+  /* make sure there's no error on the bus */
+  message = gst_bus_poll (bus, GST_MESSAGE_ERROR, 0);
+  fail_if (message);
+
+  gst_pad_push_event (mysrcpad, gst_event_new_eos ());
+  g_mutex_lock (eos_mutex);
+  while (!eos_arrived)
+    g_cond_wait (eos_cond, eos_mutex);
+  g_mutex_unlock (eos_mutex);
+}
+
+static void
+cleanup_decoder (GstElement * filter)
+{
+  gst_bus_set_flushing (bus, TRUE);
+  gst_element_set_bus (filter, NULL);
+  gst_object_unref (GST_OBJECT (bus));
+  gst_check_drop_buffers ();
+  gst_caps_unref (input_caps);
+
+  gst_element_set_state (filter, GST_STATE_NULL);
+
+  gst_pad_set_active (mysrcpad, FALSE);
+  gst_pad_set_active (mysinkpad, FALSE);
+  gst_check_teardown_src_pad (filter);
+  gst_check_teardown_sink_pad (filter);
+  gst_check_teardown_element (filter);
+
+  g_mutex_free (eos_mutex);
+  g_cond_free (eos_cond);
+}
+
+GST_START_TEST (test_segment_clipping)
+{
+  GstElement *filter;
+  GList *cur;
+  guint8 data[0x100];
+  guint i;
+
+  filter = setup_decoder ("omx_mpeg4dec", PARSED_CAPS);
+
+  fail_unless (gst_pad_push_event (mysrcpad,
+          gst_event_new_new_segment (FALSE, 1.0, GST_FORMAT_TIME, GST_SECOND,
+              -1, GST_SECOND)));
+
+  /* half a second per frame, the first two end at the segment start */
+  memset (data, 0, sizeof (data));
+  for (i = 0; i < 4; i++) {
+    data[0] = i;
+    push_data (data, sizeof (data), i * GST_SECOND / 2);
+  }
+
+  drain_decoder ();
+
+  fail_unless_equals_int (g_list_length (buffers), 2);
+  for (cur = buffers, i = 2; cur; cur = g_list_next (cur), i++) {
+    GstBuffer *buffer = cur->data;
+
+    fail_unless (GST_BUFFER_DATA (buffer)[0] == i);
+    fail_unless (GST_BUFFER_TIMESTAMP (buffer) == i * GST_SECOND / 2);
+  }
+
+  cleanup_decoder (filter);
+}
+
+GST_END_TEST
+GST_START_TEST (test_h264_access_units)
+{
+  /* the second access unit has two slices, the later with first_mb 1 */
+  static const guint8 au1[] = { 0x00, 0x00, 0x00, 0x01, 0x65, 0x88, 0x11,
+    0x11, 0x11, 0x11
+  };
+  static const guint8 au2[] = { 0x00, 0x00, 0x01, 0x41, 0x9a, 0x22, 0x22,
+    0x22, 0x00, 0x00, 0x01, 0x41, 0x40, 0x22, 0x22, 0x22
+  };
+  static const guint8 au3[] = { 0x00, 0x00, 0x01, 0x41, 0x9a, 0x33, 0x33,
+    0x33, 0x33, 0x33
+  };
+  static const guint8 *const pictures[] = { au1, au2, au3 };
+  static const guint sizes[] = { sizeof (au1), sizeof (au2), sizeof (au3) };
+  GstElement *filter;
+  guint8 stream[sizeof (au1) + sizeof (au2) + sizeof (au3)];
+
+  memcpy (stream, au1, sizeof (au1));
+  memcpy (stream + sizeof (au1), au2, sizeof (au2));
+  memcpy (stream + sizeof (au1) + sizeof (au2), au3, sizeof (au3));
+
+  filter = setup_decoder ("omx_h264dec", H264_CAPS);
+
+  push_stream (stream, sizeof (stream), 7);
+  drain_decoder ();
+  check_pictures (pictures, sizes, G_N_ELEMENTS (pictures));
+
+  cleanup_decoder (filter);
+}
+
+GST_END_TEST
+GST_START_TEST (test_mpeg4_pictures)
+{
+  /* the group of VOPs header goes with the picture it precedes */
+  static const guint8 vop1[] = { 0x00, 0x00, 0x01, 0xb6, 0x11, 0x11, 0x11,
+    0x11
+  };
+  static const guint8 vop2[] = { 0x00, 0x00, 0x01, 0xb3, 0x44, 0x44, 0x00,
+    0x00, 0x01, 0xb6, 0x22, 0x22, 0x22
+  };
+  static const guint8 vop3[] = { 0x00, 0x00, 0x01, 0xb6, 0x33, 0x33, 0x33,
+    0x33, 0x33
+  };
+  static const guint8 *const pictures[] = { vop1, vop2, vop3 };
+  static const guint sizes[] = { sizeof (vop1), sizeof (vop2), sizeof (vop3) };
+  GstElement *filter;
+  guint8 stream[sizeof (vop1) + sizeof (vop2) + sizeof (vop3)];
+
+  memcpy (stream, vop1, sizeof (vop1));
+  memcpy (stream + sizeof (vop1), vop2, sizeof (vop2));
+  memcpy (stream + sizeof (vop1) + sizeof (vop2), vop3, sizeof (vop3));
+
+  filter = setup_decoder ("omx_mpeg4dec", MPEG4_CAPS);
+
+  push_stream (stream, sizeof (stream), 5);
+  drain_decoder ();
+  check_pictures (pictures, sizes, G_N_ELEMENTS (pictures));
+
+  cleanup_decoder (filter);
+}
+
+GST_END_TEST static Suite *
+videodec_suite (void)
+{
+  Suite *s = suite_create ("videodec");
+  TCase *tc_chain = tcase_create ("general");
+
+  tcase_set_timeout (tc_chain, 10);
+  tcase_add_test (tc_chain, test_segment_clipping);
+  tcase_add_test (tc_chain, test_h264_access_units);
+  tcase_add_test (tc_chain, test_mpeg4_pictures);
+  suite_add_tcase (s, tc_chain);
+
+  return s;
+}
+
+GST_CHECK_MAIN (videodec);
@@ -0,0 +1,192 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+/* modification: time of the inline G.711 table coding per buffer, and the
+ * cpu one 8 kHz channel costs through omx_g711enc/omx_g711dec with either
+ * implementation; the omx path goes through the libomxil-foo.so stand-in
+ * of bench_g711.conf, so on an --enable-experimental build run with
+ * GST_PLUGIN_PATH=../../omx/.libs LD_LIBRARY_PATH=. and
+ * OMX_CONFIG=bench_g711.conf */
+
+#include "gstomx_g711.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#define DEFAULT_SAMPLES 160     /* 20 ms at 8 kHz */
+#define DEFAULT_BUFFERS 100000
+#define RATE 8000
+
+#define RAW_CAPS "audio/x-raw-int, rate=8000, channels=1, width=16, " \
+    "depth=16, signed=true, endianness=1234"
+
+static void
+bench (const gchar * name, gboolean alaw, guint n, guint buffers)
+{
+  gint16 *samples;
+  guint8 *codes;
+  GTimer *timer;
+  gdouble encode, decode;
+  guint i;
+
+  samples = g_new (gint16, n);
+  codes = g_new (guint8, n);
+
+  for (i = 0; i < n; i++)
+    samples[i] = (gint16) (i * 409);
+
+  timer = g_timer_new ();
+
+  /* warm the tables into the caches */
+  gstomx_g711_encode (codes, samples, n, alaw);
+  gstomx_g711_decode (samples, codes, n, alaw);
+
+  g_timer_start (timer);
+  for (i = 0; i < buffers; i++)
+    gstomx_g711_encode (codes, samples, n, alaw);
+  encode = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  for (i = 0; i < buffers; i++)
+    gstomx_g711_decode (samples, codes, n, alaw);
+  decode = g_timer_elapsed (timer, NULL);
+
+  printf ("%s encode: %.3f us/buffer\n", name, encode * 1e6 / buffers);
+  printf ("%s decode: %.3f us/buffer\n", name, decode * 1e6 / buffers);
+
+  g_timer_destroy (timer);
+  g_free (codes);
+  g_free (samples);
+}
+
+/* user and system time of all threads of the process */
+static gdouble
+cpu_time (void)
+{
+  struct rusage usage;
+
+  getrusage (RUSAGE_SELF, &usage);
+
+  return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+      usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+}
+
+/* cpu seconds to run the pipeline to EOS, or a negative value on error */
+static gdouble
+run (const gchar * description)
+{
+  GstElement *pipeline;
+  GstMessage *msg;
+  GError *error = NULL;
+  gdouble start, cpu = -1.0;
+
+  pipeline = gst_parse_launch (description, &error);
+  if (!pipeline) {
+    fprintf (stderr, "%s: %s\n", description, error->message);
+    g_error_free (error);
+    return cpu;
+  }
+
+  start = cpu_time ();
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  msg = gst_bus_timed_pop_filtered (GST_ELEMENT_BUS (pipeline),
+      GST_CLOCK_TIME_NONE, GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+  if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_EOS)
+    cpu = cpu_time () - start;
+  else
+    fprintf (stderr, "%s: failed\n", description);
+  gst_message_unref (msg);
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+  gst_object_unref (pipeline);
+
+  return cpu;
+}
+
+/* the cost of element alone, with what feeds it run once without it */
+static void
+bench_element (const gchar * name, const gchar * law, const gchar * element,
+    guint n, guint buffers)
+{
+  static const gchar *props[] =
+      { "implementation=inline", "implementation=omx" };
+  static const gchar *paths[] = { "inline", "omx" };
+  gchar *src, *description;
+  gdouble base, cpu, seconds;
+  guint i;
+
+  seconds = (gdouble) n * buffers / RATE;
+
+  if (g_str_has_suffix (element, "enc"))
+    src = g_strdup_printf ("audiotestsrc num-buffers=%u samplesperbuffer=%u "
+        "! " RAW_CAPS, buffers, n);
+  else
+    src = g_strdup_printf ("audiotestsrc num-buffers=%u samplesperbuffer=%u "
+        "! " RAW_CAPS " ! omx_g711enc implementation=inline ! %s",
+        buffers, n, law);
+
+  description = g_strdup_printf ("%s ! fakesink", src);
+  base = run (description);
+  g_free (description);
+
+  for (i = 0; i < G_N_ELEMENTS (props); i++) {
+    if (g_str_has_suffix (element, "enc"))
+      description = g_strdup_printf ("%s ! %s %s ! %s ! fakesink", src,
+          element, props[i], law);
+    else
+      description = g_strdup_printf ("%s ! %s %s ! fakesink", src,
+          element, props[i]);
+    cpu = run (description);
+    g_free (description);
+
+    if (base < 0 || cpu < 0)
+      continue;
+
+    printf ("%s %s %s: %.3f us/buffer, %.3f%% of a cpu per channel\n", name,
+        element, paths[i], (cpu - base) * 1e6 / buffers,
+        (cpu - base) * 100 / seconds);
+  }
+
+  g_free (src);
+}
+
+int
+main (int argc, char **argv)
+{
+  guint n, buffers;
+
+  gst_init (&argc, &argv);
+
+  n = argc > 1 ? atoi (argv[1]) : DEFAULT_SAMPLES;
+  buffers = argc > 2 ? atoi (argv[2]) : DEFAULT_BUFFERS;
+
+  gstomx_g711_init ();
+
+  printf ("%u samples, %u buffers\n", n, buffers);
+  bench ("mu-law", FALSE, n, buffers);
+  bench ("A-law", TRUE, n, buffers);
+
+  bench_element ("mu-law", "audio/x-mulaw", "omx_g711enc", n, buffers);
+  bench_element ("mu-law", "audio/x-mulaw", "omx_g711dec", n, buffers);
+  bench_element ("A-law", "audio/x-alaw", "omx_g711enc", n, buffers);
+  bench_element ("A-law", "audio/x-alaw", "omx_g711dec", n, buffers);
+
+  return 0;
+}
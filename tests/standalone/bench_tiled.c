@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2012 Samsung Electronics Co., Ltd. All rights reserved.
+ *
+ * This library is free software; you can redistribute it and/or modify it under
+ * the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation; either version 2.1 of the License, or (at your option)
+ * any later version.
+ *
+ * This library is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE. See the GNU Lesser General Public
+ * License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this library; if not, write to the Free Software Foundation, Inc., 51
+ * Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ *
+ */
+
+/* modification: time of gstomx_nv12t_to_nv12 per frame, against the plain
+ * copy of the same frame the output loop did before detiling */
+
+#include "gstomx_tiled.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>             /* for memcpy */
+
+#define DEFAULT_WIDTH 1920
+#define DEFAULT_HEIGHT 1080
+#define DEFAULT_FRAMES 200
+
+int
+main (int argc, char **argv)
+{
+  guint width = argc > 1 ? atoi (argv[1]) : DEFAULT_WIDTH;
+  guint height = argc > 2 ? atoi (argv[2]) : DEFAULT_HEIGHT;
+  guint frames = argc > 3 ? atoi (argv[3]) : DEFAULT_FRAMES;
+  gsize src_size, dst_size;
+  guint8 *src, *dst;
+  GTimer *timer;
+  gdouble detile, copy;
+  guint i;
+
+  src_size = gstomx_nv12t_size (width, height);
+  dst_size = gstomx_nv12_size (width, height);
+  src = g_malloc (src_size);
+  dst = g_malloc (MAX (src_size, dst_size));
+
+  for (i = 0; i < src_size; i++)
+    src[i] = i * 7;
+
+  timer = g_timer_new ();
+
+  /* warm the caches and the page tables */
+  gstomx_nv12t_to_nv12 (dst, src, width, height);
+
+  g_timer_start (timer);
+  for (i = 0; i < frames; i++)
+    gstomx_nv12t_to_nv12 (dst, src, width, height);
+  detile = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  for (i = 0; i < frames; i++)
+    memcpy (dst, src, src_size);
+  copy = g_timer_elapsed (timer, NULL);
+
+  printf ("%ux%u, %u frames\n", width, height, frames);
+  printf ("detile: %.3f ms/frame\n", detile * 1000 / frames);
+  printf ("memcpy: %.3f ms/frame\n", copy * 1000 / frames);
+
+  g_timer_destroy (timer);
+  g_free (dst);
+  g_free (src);
+
+  return 0;
+}
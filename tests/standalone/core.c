@@ -136,6 +136,19 @@ comp_SetParameter (OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR param)
   return OMX_ErrorNone;
 }
 
+/* modification: no configs; elements calling these must not crash the tests */
+static OMX_ERRORTYPE
+comp_GetConfig (OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config)
+{
+  return OMX_ErrorUnsupportedIndex;
+}
+
+static OMX_ERRORTYPE
+comp_SetConfig (OMX_HANDLETYPE handle, OMX_INDEXTYPE index, OMX_PTR config)
+{
+  return OMX_ErrorUnsupportedIndex;
+}
+
 static OMX_ERRORTYPE
 comp_SendCommand (OMX_HANDLETYPE handle,
     OMX_COMMANDTYPE command, OMX_U32 param_1, OMX_PTR data)
@@ -319,6 +332,8 @@ OMX_GetHandle (OMX_HANDLETYPE * handle,
   comp->GetState = comp_GetState;
   comp->GetParameter = comp_GetParameter;
   comp->SetParameter = comp_SetParameter;
+  comp->GetConfig = comp_GetConfig;
+  comp->SetConfig = comp_SetConfig;
   comp->SendCommand = comp_SendCommand;
   comp->UseBuffer = comp_UseBuffer;
   comp->FreeBuffer = comp_FreeBuffer;
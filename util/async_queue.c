@@ -122,6 +122,37 @@ async_queue_pop_forced (AsyncQueue * queue)
   return data;
 }
 
+/* waits even when disabled; NULL once end_time passed or when woken up by
+ * async_queue_disable */
+gpointer
+async_queue_pop_timed (AsyncQueue * queue, GTimeVal * end_time)
+{
+  gpointer data = NULL;
+
+  g_mutex_lock (queue->mutex);
+
+  if (!queue->tail) {
+    g_cond_timed_wait (queue->condition, queue->mutex, end_time);
+  }
+
+  if (queue->tail) {
+    GList *node = queue->tail;
+    data = node->data;
+
+    queue->tail = node->prev;
+    if (queue->tail)
+      queue->tail->next = NULL;
+    else
+      queue->head = NULL;
+    queue->length--;
+    g_list_free_1 (node);
+  }
+
+  g_mutex_unlock (queue->mutex);
+
+  return data;
+}
+
 void
 async_queue_disable (AsyncQueue * queue)
 {
@@ -41,6 +41,7 @@ void async_queue_free (AsyncQueue * queue);
 void async_queue_push (AsyncQueue * queue, gpointer data);
 gpointer async_queue_pop (AsyncQueue * queue);
 gpointer async_queue_pop_forced (AsyncQueue * queue);
+gpointer async_queue_pop_timed (AsyncQueue * queue, GTimeVal * end_time);
 void async_queue_disable (AsyncQueue * queue);
 void async_queue_enable (AsyncQueue * queue);
 void async_queue_flush (AsyncQueue * queue);